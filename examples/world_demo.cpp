@@ -5,13 +5,22 @@
 #include <vector>
 #include <cmath>
 #include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include "FastNoiseLite.h"
+#include "rworld_solar.h"
 
 #ifdef USE_SDL2
 #include <SDL2/SDL.h>
+#include <mutex>
+#include "rworld_progressive.h"
+#include "rworld_viewport.h"
 #ifdef USE_SDL2_TTF
 #include <SDL2/SDL_ttf.h>
 #endif
-#include "FastNoiseLite.h"
 #endif
 
 using namespace rworld;
@@ -84,17 +93,26 @@ void sample_transect(const World& world) {
               << std::setw(25) << "Biome\n";
     std::cout << std::string(51, '-') << "\n";
     
-    for (int lon = -180; lon <= 180; lon += 20) {
-        float height = world.get_terrain_height(lon, 0);
-        float altitude = std::max(height, 0.0f);
-        float temp = world.get_temperature(lon, 0, altitude);
-        BiomeType biome = world.get_biome(lon, 0, altitude);
-        
-        std::cout << std::setw(8) << lon
-                  << std::setw(10) << std::fixed << std::setprecision(1) << height
-                  << std::setw(8) << std::fixed << std::setprecision(1) << temp
-                  << "  " << biome_to_string(biome) << "\n";
+    // One call samples the whole equator every 20° (about 2226 km)
+    std::vector<Location> waypoints = {{-180, 0}, {-60, 0}, {60, 0}, {180, 0}};
+    PathResult path = world.sample_path(waypoints, 2226000.0f, {DataType::TEMPERATURE});
+    
+    for (size_t i = 0; i < path.points.size(); ++i) {
+        std::cout << std::setw(8) << std::fixed << std::setprecision(0) << path.points[i].longitude
+                  << std::setw(10) << std::fixed << std::setprecision(1) << path.elevation[i]
+                  << std::setw(8) << std::fixed << std::setprecision(1) << path.data.temperature[i]
+                  << "  " << biome_to_string(path.data.biome[i]) << "\n";
     }
+    
+    // Adaptive refinement resolves the same route's coastlines and ridges
+    PathRefinement refinement;
+    refinement.max_gradient = 0.002f; // 2 m per km
+    refinement.min_spacing = 5000.0f;
+    PathResult detailed = world.sample_path(waypoints, 100000.0f, {}, refinement);
+    std::cout << "\nRefined transect: " << detailed.points.size() << " samples over "
+              << std::setprecision(0) << detailed.distance.back() / 1000.0f << " km, "
+              << detailed.biome_crossings.size() << " biome changes, "
+              << detailed.river_crossings.size() << " river crossings\n";
 }
 
 void demonstrate_altitude_effects(const World& world) {
@@ -165,7 +183,7 @@ void run_text_demo(const World& world) {
     std::cout << "  Then rebuild with: cd build && cmake .. && cmake --build .\n";
 }
 
-#ifdef USE_SDL2
+// Map rendering (shared by the SDL window and headless mode)
 
 struct RGB {
     uint8_t r, g, b;
@@ -245,6 +263,32 @@ enum class DisplayMode {
     PRESSURE
 };
 
+const DisplayMode ALL_DISPLAY_MODES[] = {
+    DisplayMode::BIOMES, DisplayMode::ELEVATION, DisplayMode::TEMPERATURE, DisplayMode::PRECIPITATION,
+    DisplayMode::CLOUDS, DisplayMode::RIVERS, DisplayMode::COAL, DisplayMode::IRON, DisplayMode::OIL,
+    DisplayMode::INSOLATION, DisplayMode::VEGETATION, DisplayMode::SOIL_FERTILITY, DisplayMode::PRESSURE
+};
+
+// Command-line name of a display mode
+const char* display_mode_name(DisplayMode mode) {
+    switch (mode) {
+        case DisplayMode::BIOMES: return "biomes";
+        case DisplayMode::ELEVATION: return "elevation";
+        case DisplayMode::TEMPERATURE: return "temperature";
+        case DisplayMode::PRECIPITATION: return "precipitation";
+        case DisplayMode::CLOUDS: return "clouds";
+        case DisplayMode::RIVERS: return "rivers";
+        case DisplayMode::COAL: return "coal";
+        case DisplayMode::IRON: return "iron";
+        case DisplayMode::OIL: return "oil";
+        case DisplayMode::INSOLATION: return "insolation";
+        case DisplayMode::VEGETATION: return "vegetation";
+        case DisplayMode::SOIL_FERTILITY: return "soil";
+        case DisplayMode::PRESSURE: return "pressure";
+    }
+    return "unknown";
+}
+
 #ifdef USE_SDL2_TTF
 struct TextRenderer {
     TTF_Font* font;
@@ -311,9 +355,8 @@ struct CloudLayer {
     FastNoiseLite cloud_noise;
     FastNoiseLite cloud_cells; // For creating distinct cloud masses
     uint64_t seed;
-    const World* world_ptr; // Pointer to world for weather data
     
-    CloudLayer(uint64_t world_seed, const World* world) : seed(world_seed), world_ptr(world) {
+    explicit CloudLayer(uint64_t world_seed) : seed(world_seed) {
         // Base cloud noise for texture
         cloud_noise.SetNoiseType(FastNoiseLite::NoiseType_OpenSimplex2);
         cloud_noise.SetFractalType(FastNoiseLite::FractalType_FBm);
@@ -329,74 +372,79 @@ struct CloudLayer {
         cloud_cells.SetSeed(static_cast<int>(world_seed + 5001));
     }
     
-    // Get cloud density at a location (0 = clear, 1 = dense clouds)
-    float get_cloud_density(float longitude, float latitude, float current_time) const {
+    // Time-independent inputs of the cloud density at one location
+    struct Sample {
+        float x, y, z;           // Position on the noise sphere
+        float drift_x, drift_y;  // Wind vector scaled by speed
+        float base;              // Cloud tendency from humidity and precipitation
+        float temp_factor;       // Temperature effect on cloud formation
+    };
+    
+    // Wind is sampled 1000 m above the surface; temperature, humidity and
+    // precipitation at the surface.
+    Sample prepare(float longitude, float latitude, float wind_speed, float wind_direction,
+                   float temperature, float humidity, float precipitation) const {
+        Sample sample;
+        
         // Convert to 3D coordinates on sphere
         float lon_rad = longitude * 3.14159265359f / 180.0f;
         float lat_rad = latitude * 3.14159265359f / 180.0f;
         float r = 1000.0f;
-        float x = r * std::cos(lat_rad) * std::cos(lon_rad);
-        float y = r * std::cos(lat_rad) * std::sin(lon_rad);
-        float z = r * std::sin(lat_rad);
-        
-        // Get wind direction and speed at this location
-        float terrain_height = world_ptr->get_terrain_height(longitude, latitude, 1.0f);
-        float altitude = std::max(terrain_height, 0.0f) + 1000.0f; // Cloud altitude
-        float wind_speed = world_ptr->get_wind_speed(longitude, latitude, altitude);
-        float wind_direction = world_ptr->get_wind_direction(longitude, latitude, altitude);
+        sample.x = r * std::cos(lat_rad) * std::cos(lon_rad);
+        sample.y = r * std::cos(lat_rad) * std::sin(lon_rad);
+        sample.z = r * std::sin(lat_rad);
         
         // Convert wind direction to movement vector
         float wind_rad = wind_direction * 3.14159265359f / 180.0f;
-        float wind_x = std::sin(wind_rad);
-        float wind_y = std::cos(wind_rad);
+        sample.drift_x = std::sin(wind_rad) * wind_speed;
+        sample.drift_y = std::cos(wind_rad) * wind_speed;
+        
+        // Base cloud formation from humidity and precipitation
+        sample.base = (humidity * 0.6f + precipitation / 2500.0f * 0.4f);
         
+        // Temperature affects cloud formation
+        sample.temp_factor = 1.0f;
+        if (temperature < -10.0f) {
+            sample.temp_factor = 0.6f; // Very cold = less clouds
+        } else if (temperature > 35.0f) {
+            sample.temp_factor = 0.7f; // Very hot/dry = fewer clouds
+        } else if (temperature >= 10.0f && temperature <= 25.0f) {
+            sample.temp_factor = 1.3f; // Optimal for cloud formation
+        }
+        return sample;
+    }
+    
+    // Get cloud density at a prepared location (0 = clear, 1 = dense clouds).
+    // Only the two wind-advected noise lookups depend on time.
+    float get_cloud_density(const Sample& sample, float current_time) const {
         // Move clouds based on wind (speed affects how fast clouds move)
         // Scale time by wind speed and direction
         float time_scale = current_time * 0.5f; // Base time progression
-        float wind_offset_x = wind_x * wind_speed * time_scale * 5.0f;
-        float wind_offset_y = wind_y * wind_speed * time_scale * 5.0f;
+        float wind_offset_x = sample.drift_x * time_scale * 5.0f;
+        float wind_offset_y = sample.drift_y * time_scale * 5.0f;
         
         // Sample noise at wind-advected position
-        float noise = cloud_noise.GetNoise(x + wind_offset_x, y + wind_offset_y, z);
+        float noise = cloud_noise.GetNoise(sample.x + wind_offset_x, sample.y + wind_offset_y, sample.z);
         noise = (noise + 1.0f) * 0.5f; // 0-1
         
         // Large-scale weather systems (highs and lows)
-        float cells = cloud_cells.GetNoise(x + wind_offset_x * 0.5f, y + wind_offset_y * 0.5f, z);
+        float cells = cloud_cells.GetNoise(sample.x + wind_offset_x * 0.5f, sample.y + wind_offset_y * 0.5f, sample.z);
         cells = (cells + 1.0f) * 0.5f; // 0-1
         
-        // Get world weather data (use surface altitude, not cloud altitude)
-        float surface_altitude = std::max(terrain_height, 0.0f);
-        float temperature = world_ptr->get_temperature(longitude, latitude, surface_altitude);
-        float humidity = world_ptr->get_humidity(longitude, latitude, surface_altitude);
-        float precipitation = world_ptr->get_precipitation(longitude, latitude, surface_altitude);
-        
         // Weather systems - some areas have high/low pressure creating cloud regions
         float weather_system = cells * cells; // Emphasize systems
         
-        // Base cloud formation from humidity and precipitation
-        float cloud_base = (humidity * 0.6f + precipitation / 2500.0f * 0.4f);
-        
         // Weather systems modulate cloud cover
         // High cells value = high pressure (clear), low = low pressure (cloudy)
         float pressure_effect = 1.0f - (weather_system * 0.5f); // Inverted - low pressure = more clouds
-        cloud_base *= (0.5f + pressure_effect);
+        float cloud_base = sample.base * (0.5f + pressure_effect);
         
         // Detailed cloud texture from noise
         float cloud_texture = noise * noise; // Squared for patchiness
         
         // Combine base tendency with texture
         float cloud_density = cloud_base * (0.6f + cloud_texture * 0.4f);
-        
-        // Temperature affects cloud formation
-        float temp_factor = 1.0f;
-        if (temperature < -10.0f) {
-            temp_factor = 0.6f; // Very cold = less clouds
-        } else if (temperature > 35.0f) {
-            temp_factor = 0.7f; // Very hot/dry = fewer clouds
-        } else if (temperature >= 10.0f && temperature <= 25.0f) {
-            temp_factor = 1.3f; // Optimal for cloud formation
-        }
-        cloud_density *= temp_factor;
+        cloud_density *= sample.temp_factor;
         
         // Sharpen cloud edges - make distinct cloud masses
         if (cloud_density > 0.4f) {
@@ -421,9 +469,9 @@ struct ViewState {
     // Convert screen coordinates to world coordinates
     void screen_to_world(int screen_x, int screen_y, int width, int height, 
                         float& lon, float& lat) const {
-        // Normalized screen coordinates (-0.5 to 0.5)
-        float norm_x = (screen_x - width * 0.5f) / width;
-        float norm_y = (screen_y - height * 0.5f) / height;
+        // Normalized screen coordinates of the pixel center (-0.5 to 0.5)
+        float norm_x = (screen_x + 0.5f - width * 0.5f) / width;
+        float norm_y = (screen_y + 0.5f - height * 0.5f) / height;
         
         // World span at current zoom
         float lon_span = 360.0f / zoom;
@@ -440,246 +488,401 @@ struct ViewState {
         while (lon > 180.0f) lon -= 360.0f;
         while (lon < -180.0f) lon += 360.0f;
     }
+    
+    // Move the view by whole pixels (positive = east / south) so panned grids
+    // line up with the previous one
+    void pan_pixels(int dx, int dy, int width, int height) {
+        center_lon += dx * (360.0f / zoom) / width;
+        center_lat -= dy * (180.0f / zoom) / height;
+        center_lat = std::clamp(center_lat, -90.0f, 90.0f);
+        while (center_lon > 180.0f) center_lon -= 360.0f;
+        while (center_lon < -180.0f) center_lon += 360.0f;
+    }
+    
+    // Grid covering the screen, one cell per pixel (matches screen_to_world)
+    GridRegion grid_region(int width, int height) const {
+        GridRegion region;
+        region.west = center_lon - 180.0f / zoom;
+        region.east = center_lon + 180.0f / zoom;
+        region.north = center_lat + 90.0f / zoom;
+        region.south = center_lat - 90.0f / zoom;
+        region.width = width;
+        region.height = height;
+        region.current_time = current_time;
+        return region;
+    }
 };
 
-void render_cloud_overlay(SDL_Renderer* renderer, const CloudLayer& clouds,
-                          int width, int height, const ViewState& view) {
-    for (int y = 0; y < height; ++y) {
+inline uint32_t pack_argb(RGB color) {
+    return 0xFF000000u | (static_cast<uint32_t>(color.r) << 16) |
+           (static_cast<uint32_t>(color.g) << 8) | color.b;
+}
+
+// Static cloud inputs for one viewport, baked once and reused while the
+// clock runs. Only the view bounds matter; time is applied per frame.
+struct CloudField {
+    GridRegion region;
+    std::vector<CloudLayer::Sample> samples;
+    
+    bool matches(const GridRegion& other) const {
+        return !samples.empty() && region.west == other.west && region.east == other.east &&
+               region.north == other.north && region.south == other.south &&
+               region.width == other.width && region.height == other.height;
+    }
+};
+
+// Query the weather under the viewport (one grid row per task) and prepare
+// every pixel's cloud sample
+void bake_cloud_field(CloudField& field, const World& world, const CloudLayer& clouds,
+                      int width, int height, const ViewState& view) {
+    // Weather at the surface of the base terrain; wind is sampled again at cloud height
+    GridRegion region = view.grid_region(width, height);
+    const std::vector<DataType> surface_types = {
+        DataType::TERRAIN_HEIGHT, DataType::TEMPERATURE, DataType::HUMIDITY, DataType::PRECIPITATION
+    };
+    const std::vector<DataType> wind_types = {DataType::WIND_SPEED, DataType::WIND_DIRECTION};
+    
+    field.region = region;
+    field.samples.resize(static_cast<size_t>(width) * height);
+    rworld::detail::parallel_for(height, [&](int y) {
+        GridResult row = world.grid_query(region, surface_types, y, y + 1);
+        const std::vector<float>& terrain = row.layers[0];
+        
+        float lat = rworld::detail::grid_latitude(region, y);
+        std::vector<Location> cloud_level;
+        cloud_level.reserve(width);
         for (int x = 0; x < width; ++x) {
-            float lon, lat;
-            view.screen_to_world(x, y, width, height, lon, lat);
-            
-            float density = clouds.get_cloud_density(lon, lat, view.current_time);
+            float lon = rworld::detail::grid_longitude(region, x);
+            cloud_level.emplace_back(lon, lat, std::max(terrain[x], 0.0f) + 1000.0f, view.current_time, 1.0f);
+        }
+        BatchResult wind = world.batch_query(cloud_level, wind_types);
+        
+        CloudLayer::Sample* out = field.samples.data() + static_cast<size_t>(y) * width;
+        for (int x = 0; x < width; ++x) {
+            out[x] = clouds.prepare(cloud_level[x].longitude, lat, wind.wind_speed[x], wind.wind_direction[x],
+                                    row.layers[1][x], row.layers[2][x], row.layers[3][x]);
+        }
+    });
+}
+
+// Blend clouds at current_time over an ARGB8888 framebuffer of the field's size
+void render_cloud_overlay(std::vector<uint32_t>& pixels, const CloudField& field, const CloudLayer& clouds,
+                          float current_time) {
+    int width = field.region.width;
+    rworld::detail::parallel_for(field.region.height, [&](int y) {
+        size_t offset = static_cast<size_t>(y) * width;
+        uint32_t* out = pixels.data() + offset;
+        for (int x = 0; x < width; ++x) {
+            float density = clouds.get_cloud_density(field.samples[offset + x], current_time);
             
             // Only draw clouds where density is significant
             if (density > 0.3f) {
-                uint8_t alpha = static_cast<uint8_t>((density - 0.3f) / 0.7f * 180.0f);
-                SDL_SetRenderDrawColor(renderer, 255, 255, 255, alpha);
-                SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
-                SDL_RenderDrawPoint(renderer, x, y);
+                uint32_t alpha = static_cast<uint32_t>((density - 0.3f) / 0.7f * 180.0f);
+                uint32_t pixel = out[x];
+                uint32_t blended = 0xFF000000u;
+                for (int shift = 0; shift <= 16; shift += 8) {
+                    uint32_t channel = (pixel >> shift) & 0xFF;
+                    channel = (channel * (255 - alpha) + 255 * alpha) / 255;
+                    blended |= channel << shift;
+                }
+                out[x] = blended;
             }
         }
+    });
+}
+
+// Grid region and data types a display mode samples, one cell per pixel
+GridRegion display_mode_query(DisplayMode mode, const ViewState& view, int width, int height,
+                              std::vector<DataType>& types) {
+    GridRegion region = view.grid_region(width, height);
+    
+    switch (mode) {
+        case DisplayMode::BIOMES:
+        case DisplayMode::CLOUDS:
+            // Biomes use base terrain (detail_level = 1.0) so they don't change with zoom
+            types = {DataType::BIOME};
+            break;
+        case DisplayMode::TEMPERATURE:
+            types = {DataType::TEMPERATURE};
+            break;
+        case DisplayMode::PRECIPITATION:
+            types = {DataType::PRECIPITATION};
+            break;
+        case DisplayMode::ELEVATION:
+            // Elevation uses detailed terrain that responds to zoom
+            region.detail_level = view.zoom;
+            types = {DataType::TERRAIN_HEIGHT};
+            break;
+        case DisplayMode::RIVERS:
+            region.detail_level = view.zoom;
+            types = {DataType::TERRAIN_HEIGHT, DataType::IS_RIVER};
+            break;
+        case DisplayMode::COAL:
+            region.detail_level = view.zoom;
+            types = {DataType::TERRAIN_HEIGHT, DataType::COAL_DEPOSIT};
+            break;
+        case DisplayMode::IRON:
+            region.detail_level = view.zoom;
+            types = {DataType::TERRAIN_HEIGHT, DataType::IRON_DEPOSIT};
+            break;
+        case DisplayMode::OIL:
+            region.detail_level = view.zoom;
+            types = {DataType::TERRAIN_HEIGHT, DataType::OIL_DEPOSIT};
+            break;
+        case DisplayMode::INSOLATION:
+            types = {DataType::INSOLATION};
+            break;
+        case DisplayMode::VEGETATION:
+            region.detail_level = view.zoom;
+            types = {DataType::TERRAIN_HEIGHT, DataType::VEGETATION_DENSITY};
+            break;
+        case DisplayMode::SOIL_FERTILITY:
+            region.detail_level = view.zoom;
+            types = {DataType::TERRAIN_HEIGHT, DataType::SOIL_FERTILITY};
+            break;
+        case DisplayMode::PRESSURE:
+            // Grid queries report pressure at the terrain surface; AIR_PRESSURE
+            // gives the altitude part so it can be swapped for sea level
+            region.detail_level = view.zoom;
+            types = {DataType::TERRAIN_HEIGHT, DataType::PRESSURE_AT_LOCATION,
+                     DataType::AIR_PRESSURE, DataType::IS_STORM_FRONT};
+            break;
     }
+    return region;
 }
 
-void render_world_map(SDL_Renderer* renderer, const World& world, 
-                      int width, int height, DisplayMode mode, const ViewState& view) {
-    for (int y = 0; y < height; ++y) {
-        for (int x = 0; x < width; ++x) {
-            float lon, lat;
-            view.screen_to_world(x, y, width, height, lon, lat);
-            
-            RGB color;
-            
-            switch (mode) {
-                case DisplayMode::BIOMES: {
-                    // Biomes use base terrain (detail_level = 1.0) so they don't change with zoom
-                    float terrain_height = world.get_terrain_height(lon, lat, 1.0f);
-                    float altitude = std::max(terrain_height, 0.0f);
-                    BiomeType biome = world.get_biome(lon, lat, altitude);
-                    color = get_biome_color(biome);
-                    break;
-                }
-                case DisplayMode::ELEVATION: {
-                    // Elevation uses detailed terrain that responds to zoom
-                    float height = world.get_terrain_height(lon, lat, view.zoom);
-                    color = get_height_color(height);
-                    break;
-                }
-                case DisplayMode::TEMPERATURE: {
-                    // Temperature uses base terrain so it stays consistent
-                    float terrain_height = world.get_terrain_height(lon, lat, 1.0f);
-                    float altitude = std::max(terrain_height, 0.0f);
-                    float temp = world.get_temperature(lon, lat, altitude);
-                    color = get_temperature_color(temp);
-                    break;
-                }
-                case DisplayMode::PRECIPITATION: {
-                    // Precipitation uses base terrain so it stays consistent
-                    float terrain_height = world.get_terrain_height(lon, lat, 1.0f);
-                    float altitude = std::max(terrain_height, 0.0f);
-                    float precip = world.get_precipitation(lon, lat, altitude);
-                    color = get_precipitation_color(precip);
-                    break;
+// Color one grid row for a display mode into ARGB8888 pixels
+void shade_map_row(const World& world, const GridRegion& region, const GridResult& grid, int row,
+                   DisplayMode mode, uint32_t* out) {
+    size_t offset = static_cast<size_t>(row - grid.row_begin) * grid.width;
+    auto layer = [&](size_t i) { return grid.layers[i].data() + offset; };
+    const float* first = layer(0);
+    float sea_level_pressure = world.get_air_pressure(0.0f, 0.0f, 0.0f);
+    
+    for (int x = 0; x < grid.width; ++x) {
+        RGB color{};
+        
+        switch (mode) {
+            case DisplayMode::BIOMES:
+            case DisplayMode::CLOUDS:
+                // Cloud mode shows the biome map under the overlay
+                color = get_biome_color(static_cast<BiomeType>(first[x]));
+                break;
+            case DisplayMode::ELEVATION:
+                color = get_height_color(first[x]);
+                break;
+            case DisplayMode::TEMPERATURE:
+                color = get_temperature_color(first[x]);
+                break;
+            case DisplayMode::PRECIPITATION:
+                color = get_precipitation_color(first[x]);
+                break;
+            case DisplayMode::RIVERS: {
+                // Show elevation with rivers highlighted
+                color = get_height_color(first[x]);
+                
+                // Overlay rivers in blue
+                if (layer(1)[x] != 0.0f) {
+                    float flow = world.get_flow_accumulation(rworld::detail::grid_longitude(region, x),
+                                                         rworld::detail::grid_latitude(region, row));
+                    uint8_t blue_intensity = static_cast<uint8_t>(100 + flow * 155);
+                    color = {0, 100, blue_intensity};
                 }
-                case DisplayMode::CLOUDS: {
-                    // Show base biome map
-                    float terrain_height = world.get_terrain_height(lon, lat, 1.0f);
-                    float altitude = std::max(terrain_height, 0.0f);
-                    BiomeType biome = world.get_biome(lon, lat, altitude);
-                    color = get_biome_color(biome);
-                    break;
+                break;
+            }
+            case DisplayMode::COAL: {
+                // Show coal deposits on elevation map
+                color = get_height_color(first[x]);
+                
+                // Overlay coal in black/gray
+                float coal = layer(1)[x];
+                if (coal > 0.3f) {
+                    uint8_t intensity = static_cast<uint8_t>(255 * (1.0f - coal * 0.8f));
+                    uint8_t dark = static_cast<uint8_t>(intensity / 3);
+                    color = {dark, dark, dark};
                 }
-                case DisplayMode::RIVERS: {
-                    // Show elevation with rivers highlighted
-                    float height = world.get_terrain_height(lon, lat, view.zoom);
-                    color = get_height_color(height);
-                    
-                    // Overlay rivers in blue
-                    if (world.is_river(lon, lat)) {
-                        float flow = world.get_flow_accumulation(lon, lat);
-                        uint8_t blue_intensity = static_cast<uint8_t>(100 + flow * 155);
-                        color = {0, 100, blue_intensity};
-                    }
-                    break;
+                break;
+            }
+            case DisplayMode::IRON: {
+                // Show iron deposits on elevation map
+                color = get_height_color(first[x]);
+                
+                // Overlay iron in rust red/brown
+                float iron = layer(1)[x];
+                if (iron > 0.3f) {
+                    uint8_t red = static_cast<uint8_t>(139 + iron * 70);
+                    uint8_t brown = static_cast<uint8_t>(69 + iron * 40);
+                    color = {red, brown, static_cast<uint8_t>(brown / 2)};
                 }
-                case DisplayMode::COAL: {
-                    // Show coal deposits on elevation map
-                    float height = world.get_terrain_height(lon, lat, view.zoom);
-                    color = get_height_color(height);
-                    
-                    // Overlay coal in black/gray
-                    float coal = world.get_coal_deposit(lon, lat);
-                    if (coal > 0.3f) {
-                        uint8_t intensity = static_cast<uint8_t>(255 * (1.0f - coal * 0.8f));
-                        uint8_t dark = static_cast<uint8_t>(intensity / 3);
-                        color = {dark, dark, dark};
-                    }
-                    break;
+                break;
+            }
+            case DisplayMode::OIL: {
+                // Show oil deposits on elevation map
+                color = get_height_color(first[x]);
+                
+                // Overlay oil in dark green/black
+                float oil = layer(1)[x];
+                if (oil > 0.3f) {
+                    uint8_t darkness = static_cast<uint8_t>(50 * (1.0f - oil));
+                    uint8_t green = static_cast<uint8_t>(darkness + oil * 80);
+                    color = {darkness, green, darkness};
                 }
-                case DisplayMode::IRON: {
-                    // Show iron deposits on elevation map
-                    float height = world.get_terrain_height(lon, lat, view.zoom);
-                    color = get_height_color(height);
-                    
-                    // Overlay iron in rust red/brown
-                    float iron = world.get_iron_deposit(lon, lat);
-                    if (iron > 0.3f) {
-                        uint8_t red = static_cast<uint8_t>(139 + iron * 70);
-                        uint8_t brown = static_cast<uint8_t>(69 + iron * 40);
-                        color = {red, brown, static_cast<uint8_t>(brown / 2)};
-                    }
-                    break;
+                break;
+            }
+            case DisplayMode::INSOLATION: {
+                // Color based on insolation level (0-1400 W/m²)
+                float normalized = std::clamp(first[x] / 1000.0f, 0.0f, 1.4f);
+                
+                if (normalized == 0.0f) {
+                    // Night - dark blue/black
+                    color = {10, 10, 30};
+                } else {
+                    // Day - yellow to white based on intensity
+                    uint8_t r = static_cast<uint8_t>(50 + normalized * 205);
+                    uint8_t g = static_cast<uint8_t>(50 + normalized * 205);
+                    uint8_t b = static_cast<uint8_t>(normalized * 100);
+                    color = {r, g, b};
                 }
-                case DisplayMode::OIL: {
-                    // Show oil deposits on elevation map
-                    float height = world.get_terrain_height(lon, lat, view.zoom);
+                break;
+            }
+            case DisplayMode::VEGETATION: {
+                // Show vegetation density
+                float height = first[x];
+                float veg_density = layer(1)[x];
+                
+                // Color scale from brown (no veg) through green to dark green (dense)
+                if (height <= 0.0f) {
+                    // Ocean
                     color = get_height_color(height);
-                    
-                    // Overlay oil in dark green/black
-                    float oil = world.get_oil_deposit(lon, lat);
-                    if (oil > 0.3f) {
-                        uint8_t darkness = static_cast<uint8_t>(50 * (1.0f - oil));
-                        uint8_t green = static_cast<uint8_t>(darkness + oil * 80);
-                        color = {darkness, green, darkness};
-                    }
-                    break;
-                }
-                case DisplayMode::INSOLATION: {
-                    // Show solar radiation based on time of day
-                    float insolation = world.get_insolation(lon, lat, view.current_time);
-                    
-                    // Color based on insolation level (0-1400 W/m²)
-                    float normalized = std::clamp(insolation / 1000.0f, 0.0f, 1.4f);
-                    
-                    if (normalized == 0.0f) {
-                        // Night - dark blue/black
-                        color = {10, 10, 30};
-                    } else {
-                        // Day - yellow to white based on intensity
-                        uint8_t r = static_cast<uint8_t>(50 + normalized * 205);
-                        uint8_t g = static_cast<uint8_t>(50 + normalized * 205);
-                        uint8_t b = static_cast<uint8_t>(normalized * 100);
-                        color = {r, g, b};
-                    }
-                    break;
-                }
-                case DisplayMode::VEGETATION: {
-                    // Show vegetation density
-                    float height = world.get_terrain_height(lon, lat, view.zoom);
-                    float altitude = std::max(height, 0.0f);
-                    float veg_density = world.get_vegetation_density(lon, lat, altitude);
-                    
-                    // Color scale from brown (no veg) through green to dark green (dense)
-                    if (height <= 0.0f) {
-                        // Ocean
-                        color = get_height_color(height);
-                    } else if (veg_density < 0.1f) {
-                        // Barren - brown/tan
-                        color = {160, 140, 100};
-                    } else {
-                        // Interpolate from light green to dark green
-                        uint8_t r = static_cast<uint8_t>(150 - veg_density * 130);
-                        uint8_t g = static_cast<uint8_t>(100 + veg_density * 100);
-                        uint8_t b = static_cast<uint8_t>(50 - veg_density * 30);
-                        color = {r, g, b};
-                    }
-                    break;
+                } else if (veg_density < 0.1f) {
+                    // Barren - brown/tan
+                    color = {160, 140, 100};
+                } else {
+                    // Interpolate from light green to dark green
+                    uint8_t r = static_cast<uint8_t>(150 - veg_density * 130);
+                    uint8_t g = static_cast<uint8_t>(100 + veg_density * 100);
+                    uint8_t b = static_cast<uint8_t>(50 - veg_density * 30);
+                    color = {r, g, b};
                 }
+                break;
+            }
+            
+            case DisplayMode::SOIL_FERTILITY: {
+                // Show soil fertility
+                float height = first[x];
                 
-                case DisplayMode::SOIL_FERTILITY: {
-                    // Show soil fertility
-                    float height = world.get_terrain_height(lon, lat, view.zoom);
-                    float altitude = std::max(height, 0.0f);
+                if (height <= 0.0f) {
+                    // Ocean - blue
+                    color = get_height_color(height);
+                } else {
+                    float fertility = layer(1)[x];
                     
-                    if (height <= 0.0f) {
-                        // Ocean - blue
-                        color = get_height_color(height);
+                    // Color scale from red (infertile) through yellow to green (fertile)
+                    if (fertility < 0.3f) {
+                        // Red to orange (poor)
+                        uint8_t g = static_cast<uint8_t>(fertility * 255 / 0.3f);
+                        color = {200, g, 0};
+                    } else if (fertility < 0.6f) {
+                        // Orange to yellow (moderate)
+                        float t = (fertility - 0.3f) / 0.3f;
+                        uint8_t r = static_cast<uint8_t>(200 - t * 50);
+                        color = {r, 200, 0};
                     } else {
-                        float fertility = world.get_soil_fertility(lon, lat, altitude);
-                        
-                        // Color scale from red (infertile) through yellow to green (fertile)
-                        if (fertility < 0.3f) {
-                            // Red to orange (poor)
-                            uint8_t g = static_cast<uint8_t>(fertility * 255 / 0.3f);
-                            color = {200, g, 0};
-                        } else if (fertility < 0.6f) {
-                            // Orange to yellow (moderate)
-                            float t = (fertility - 0.3f) / 0.3f;
-                            uint8_t r = static_cast<uint8_t>(200 - t * 50);
-                            color = {r, 200, 0};
-                        } else {
-                            // Yellow to green (good to excellent)
-                            float t = (fertility - 0.6f) / 0.4f;
-                            uint8_t r = static_cast<uint8_t>(150 * (1.0f - t));
-                            uint8_t g = static_cast<uint8_t>(200 - t * 50);
-                            color = {r, g, 50};
-                        }
+                        // Yellow to green (good to excellent)
+                        float t = (fertility - 0.6f) / 0.4f;
+                        uint8_t r = static_cast<uint8_t>(150 * (1.0f - t));
+                        uint8_t g = static_cast<uint8_t>(200 - t * 50);
+                        color = {r, g, 50};
                     }
-                    break;
                 }
+                break;
+            }
+            
+            case DisplayMode::PRESSURE: {
+                // Show pressure systems and storm fronts
+                float height = first[x];
+                float pressure = layer(1)[x] - layer(2)[x] + sea_level_pressure;
+                bool is_front = layer(3)[x] != 0.0f;
                 
-                case DisplayMode::PRESSURE: {
-                    // Show pressure systems and storm fronts
-                    float height = world.get_terrain_height(lon, lat, view.zoom);
-                    float pressure = world.get_pressure_at_location(lon, lat, 0.0f, view.current_time);
-                    bool is_front = world.is_storm_front(lon, lat, view.current_time);
-                    
-                    if (height <= 0.0f) {
-                        // Ocean - base blue, modulated by pressure
-                        int blue_mod = static_cast<int>((pressure - 1000.0f) * 2.0f);
-                        uint8_t g = static_cast<uint8_t>(std::clamp(50 + blue_mod, 0, 255));
-                        uint8_t b = static_cast<uint8_t>(std::clamp(150 + blue_mod, 0, 255));
-                        color = {30, g, b};
+                if (height <= 0.0f) {
+                    // Ocean - base blue, modulated by pressure
+                    int blue_mod = static_cast<int>((pressure - 1000.0f) * 2.0f);
+                    uint8_t g = static_cast<uint8_t>(std::clamp(50 + blue_mod, 0, 255));
+                    uint8_t b = static_cast<uint8_t>(std::clamp(150 + blue_mod, 0, 255));
+                    color = {30, g, b};
+                } else {
+                    // Land - color coded by pressure
+                    if (is_front) {
+                        // Storm fronts - bright red/orange
+                        color = {255, 100, 0};
+                    } else if (pressure > 1020.0f) {
+                        // High pressure - blue (clear skies)
+                        uint8_t intensity = static_cast<uint8_t>(std::min(255.0f, 150 + (pressure - 1020.0f) * 3.0f));
+                        color = {100, 150, intensity};
+                    } else if (pressure < 1000.0f) {
+                        // Low pressure - red (storms)
+                        uint8_t intensity = static_cast<uint8_t>(std::min(255.0f, 150 + (1000.0f - pressure) * 3.0f));
+                        color = {intensity, 100, 100};
                     } else {
-                        // Land - color coded by pressure
-                        if (is_front) {
-                            // Storm fronts - bright red/orange
-                            color = {255, 100, 0};
-                        } else if (pressure > 1020.0f) {
-                            // High pressure - blue (clear skies)
-                            uint8_t intensity = static_cast<uint8_t>(std::min(255.0f, 150 + (pressure - 1020.0f) * 3.0f));
-                            color = {100, 150, intensity};
-                        } else if (pressure < 1000.0f) {
-                            // Low pressure - red (storms)
-                            uint8_t intensity = static_cast<uint8_t>(std::min(255.0f, 150 + (1000.0f - pressure) * 3.0f));
-                            color = {intensity, 100, 100};
-                        } else {
-                            // Normal pressure - white/gray
-                            uint8_t gray = static_cast<uint8_t>(150 + (pressure - 1010.0f) * 5.0f);
-                            color = {gray, gray, gray};
-                        }
+                        // Normal pressure - white/gray
+                        uint8_t gray = static_cast<uint8_t>(150 + (pressure - 1010.0f) * 5.0f);
+                        color = {gray, gray, gray};
                     }
-                    break;
                 }
+                break;
             }
-            
-            SDL_SetRenderDrawColor(renderer, color.r, color.g, color.b, 255);
-            SDL_RenderDrawPoint(renderer, x, y);
         }
+        
+        out[x] = pack_argb(color);
+    }
+}
+
+// Render the map for a display mode into an ARGB8888 framebuffer. Each row is
+// one grid query, and rows are spread across worker threads.
+void render_world_map(std::vector<uint32_t>& pixels, const World& world,
+                      int width, int height, DisplayMode mode, const ViewState& view) {
+    std::vector<DataType> types;
+    GridRegion region = display_mode_query(mode, view, width, height, types);
+    
+    rworld::detail::parallel_for(height, [&](int y) {
+        GridResult row = world.grid_query(region, types, y, y + 1);
+        shade_map_row(world, region, row, y, mode, pixels.data() + static_cast<size_t>(y) * width);
+    });
+}
+
+// Insolation for the viewport. Cloud cover is sampled once per view, so
+// animated frames only move the sun
+struct SolarField {
+    std::unique_ptr<SolarGrid> grid;
+    GridResult frame;
+    
+    bool matches(const GridRegion& other) const {
+        if (!grid) {
+            return false;
+        }
+        const GridRegion& region = grid->region();
+        return region.west == other.west && region.east == other.east &&
+               region.north == other.north && region.south == other.south &&
+               region.width == other.width && region.height == other.height;
+    }
+};
+
+void render_solar_map(std::vector<uint32_t>& pixels, SolarField& field, const World& world,
+                      int width, int height, const ViewState& view) {
+    std::vector<DataType> types;
+    GridRegion region = display_mode_query(DisplayMode::INSOLATION, view, width, height, types);
+    if (!field.matches(region)) {
+        field.grid = std::make_unique<SolarGrid>(world, region);
     }
+    field.grid->evaluate(world.get_config().day_of_year, view.current_time, types, field.frame);
+    rworld::detail::parallel_for(height, [&](int y) {
+        shade_map_row(world, region, field.frame, y, DisplayMode::INSOLATION,
+                      pixels.data() + static_cast<size_t>(y) * width);
+    });
 }
 
+#ifdef USE_SDL2
+
 void render_info_panel(SDL_Renderer* renderer, const World& world, 
                        int mouse_x, int mouse_y, int map_width, int map_height,
                        DisplayMode mode, const ViewState& view
@@ -1017,6 +1220,22 @@ void run_sdl_demo(World& world) {
         return;
     }
     
+    // The map is drawn into a CPU framebuffer and uploaded once per redraw
+    SDL_Texture* map_texture = SDL_CreateTexture(
+        renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING,
+        WINDOW_WIDTH, WINDOW_HEIGHT
+    );
+    
+    if (!map_texture) {
+        std::cerr << "Texture creation failed: " << SDL_GetError() << std::endl;
+        SDL_DestroyRenderer(renderer);
+        SDL_DestroyWindow(window);
+        SDL_Quit();
+        return;
+    }
+    
+    std::vector<uint32_t> pixels(static_cast<size_t>(WINDOW_WIDTH) * WINDOW_HEIGHT);
+    
     std::cout << "\n=== SDL2 Interactive World Visualization ===\n";
     std::cout << "Controls:\n";
     std::cout << "  1 - Show Biomes\n";
@@ -1039,6 +1258,7 @@ void run_sdl_demo(World& world) {
     std::cout << "  [ / ] - Decrease/Increase time\n";
     std::cout << "  R - Regenerate world (new seed)\n";
     std::cout << "  Mouse Wheel - Zoom in/out at cursor position\n";
+    std::cout << "  Mouse Drag / Arrow Keys - Pan the view\n";
     std::cout << "  ESC/Q - Quit\n";
     std::cout << "\nGenerating world map...\n";
     
@@ -1046,11 +1266,37 @@ void run_sdl_demo(World& world) {
     
     DisplayMode current_mode = DisplayMode::BIOMES;
     ViewState view_state;
-    CloudLayer clouds(config.seed, &world);
+    CloudLayer clouds(config.seed);
+    CloudField cloud_field;  // Baked for the current view
+    SolarField solar_field;  // Cloud cover for the current view
+    std::vector<uint32_t> cloud_base_pixels(pixels.size());  // Biome map under the clouds
     bool need_redraw = true;
     bool running = true;
     int mouse_x = 0, mouse_y = 0;
     
+    // Map modes refine from 1/8 resolution on a background thread. Each pass
+    // is colored off the main thread and handed over in staged_pixels.
+    std::mutex staged_mutex;
+    std::vector<uint32_t> staged_pixels(pixels.size());
+    std::vector<uint32_t> pass_pixels(pixels.size());
+    bool staged_ready = false;
+    GridResult staged_grid;          // Final pass, handed to view_cache
+    GridRegion staged_region;
+    std::vector<DataType> staged_types;
+    ProgressiveGridRenderer progressive(world);
+    
+    // Pans reuse the last full grid and only sample the exposed strips
+    ViewportSampleCache view_cache(world);
+    bool dragging = false;
+    const int PAN_STEP = 40; // Pixels per arrow key press
+    
+    // Drop anything a cancelled progressive render left behind
+    auto discard_staged = [&]() {
+        std::lock_guard<std::mutex> lock(staged_mutex);
+        staged_ready = false;
+        staged_grid = GridResult();
+    };
+    
     while (running) {
         SDL_Event event;
         while (SDL_PollEvent(&event)) {
@@ -1177,16 +1423,46 @@ void run_sdl_demo(World& world) {
                         break;
                     case SDLK_r:
                         config.seed = static_cast<uint64_t>(SDL_GetTicks64());
+                        progressive.cancel(); // Stop sampling before reconfiguring
+                        discard_staged();
+                        view_cache.clear();
                         world.set_config(config);
-                        clouds = CloudLayer(config.seed, &world); // Regenerate clouds too
+                        clouds = CloudLayer(config.seed); // Regenerate clouds too
+                        cloud_field = CloudField();
+                        solar_field = SolarField();
                         view_state = ViewState(); // Reset view
                         need_redraw = true;
                         std::cout << "Regenerating world with seed " << config.seed << "\n";
                         break;
+                    case SDLK_LEFT:
+                        view_state.pan_pixels(-PAN_STEP, 0, WINDOW_WIDTH, WINDOW_HEIGHT);
+                        need_redraw = true;
+                        break;
+                    case SDLK_RIGHT:
+                        view_state.pan_pixels(PAN_STEP, 0, WINDOW_WIDTH, WINDOW_HEIGHT);
+                        need_redraw = true;
+                        break;
+                    case SDLK_UP:
+                        view_state.pan_pixels(0, -PAN_STEP, WINDOW_WIDTH, WINDOW_HEIGHT);
+                        need_redraw = true;
+                        break;
+                    case SDLK_DOWN:
+                        view_state.pan_pixels(0, PAN_STEP, WINDOW_WIDTH, WINDOW_HEIGHT);
+                        need_redraw = true;
+                        break;
                 }
+            } else if (event.type == SDL_MOUSEBUTTONDOWN && event.button.button == SDL_BUTTON_LEFT) {
+                dragging = true;
+            } else if (event.type == SDL_MOUSEBUTTONUP && event.button.button == SDL_BUTTON_LEFT) {
+                dragging = false;
             } else if (event.type == SDL_MOUSEMOTION) {
                 mouse_x = event.motion.x;
                 mouse_y = event.motion.y;
+                if (dragging && (event.motion.xrel != 0 || event.motion.yrel != 0)) {
+                    // The map follows the cursor
+                    view_state.pan_pixels(-event.motion.xrel, -event.motion.yrel, WINDOW_WIDTH, WINDOW_HEIGHT);
+                    need_redraw = true;
+                }
             } else if (event.type == SDL_MOUSEWHEEL) {
                 // Get mouse position for zoom center
                 SDL_GetMouseState(&mouse_x, &mouse_y);
@@ -1232,21 +1508,78 @@ void run_sdl_demo(World& world) {
         }
         
         if (need_redraw) {
-            SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
-            SDL_RenderClear(renderer);
-            
-            render_world_map(renderer, world, WINDOW_WIDTH, WINDOW_HEIGHT, current_mode, view_state);
-            
-            // Add cloud overlay if in clouds mode
             if (current_mode == DisplayMode::CLOUDS) {
-                render_cloud_overlay(renderer, clouds, WINDOW_WIDTH, WINDOW_HEIGHT, view_state);
+                // The cloud overlay runs its own queries, so this mode renders in one go.
+                // The base map and weather are baked per view; animated frames
+                // only advect the cloud noise.
+                progressive.cancel();
+                discard_staged();
+                if (!cloud_field.matches(view_state.grid_region(WINDOW_WIDTH, WINDOW_HEIGHT))) {
+                    render_world_map(cloud_base_pixels, world, WINDOW_WIDTH, WINDOW_HEIGHT, current_mode, view_state);
+                    bake_cloud_field(cloud_field, world, clouds, WINDOW_WIDTH, WINDOW_HEIGHT, view_state);
+                    std::cout << "World map rendered.\n";
+                }
+                pixels = cloud_base_pixels;
+                render_cloud_overlay(pixels, cloud_field, clouds, view_state.current_time);
+                SDL_UpdateTexture(map_texture, nullptr, pixels.data(), WINDOW_WIDTH * sizeof(uint32_t));
+            } else if (current_mode == DisplayMode::INSOLATION) {
+                // Cloud cover is sampled once per view; later frames only move the sun
+                progressive.cancel();
+                discard_staged();
+                render_solar_map(pixels, solar_field, world, WINDOW_WIDTH, WINDOW_HEIGHT, view_state);
+                SDL_UpdateTexture(map_texture, nullptr, pixels.data(), WINDOW_WIDTH * sizeof(uint32_t));
+            } else {
+                std::vector<DataType> types;
+                DisplayMode mode = current_mode;
+                GridRegion region = display_mode_query(mode, view_state, WINDOW_WIDTH, WINDOW_HEIGHT, types);
+                if (view_cache.can_reuse(region, types)) {
+                    // A pan: shift the cached grid and sample the new strips only
+                    progressive.cancel();
+                    discard_staged();
+                    const GridResult& grid = view_cache.update(region, types);
+                    rworld::detail::parallel_for(grid.rows, [&](int y) {
+                        shade_map_row(world, region, grid, y, mode, pixels.data() + static_cast<size_t>(y) * WINDOW_WIDTH);
+                    });
+                    SDL_UpdateTexture(map_texture, nullptr, pixels.data(), WINDOW_WIDTH * sizeof(uint32_t));
+                } else {
+                    view_cache.clear();
+                    progressive.start(region, types, [&, region, types, mode](const GridResult& grid, const ProgressivePass& pass) {
+                        for (int y = 0; y < grid.rows; ++y) {
+                            shade_map_row(world, region, grid, y, mode, pass_pixels.data() + static_cast<size_t>(y) * WINDOW_WIDTH);
+                        }
+                        {
+                            std::lock_guard<std::mutex> lock(staged_mutex);
+                            staged_pixels.swap(pass_pixels);
+                            staged_ready = true;
+                            if (pass.final) {
+                                staged_grid = grid;
+                                staged_region = region;
+                                staged_types = types;
+                            }
+                        }
+                        if (pass.final) {
+                            std::cout << "World map rendered in " << static_cast<int>(pass.elapsed * 1000.0) << " ms.\n";
+                        }
+                    });
+                }
             }
-            
             need_redraw = false;
-            
-            std::cout << "World map rendered.\n";
         }
         
+        {
+            std::lock_guard<std::mutex> lock(staged_mutex);
+            if (staged_ready) {
+                SDL_UpdateTexture(map_texture, nullptr, staged_pixels.data(), WINDOW_WIDTH * sizeof(uint32_t));
+                staged_ready = false;
+            }
+            if (!staged_grid.layers.empty()) {
+                view_cache.assign(staged_region, staged_types, std::move(staged_grid));
+                staged_grid = GridResult();
+            }
+        }
+        
+        SDL_RenderCopy(renderer, map_texture, nullptr, nullptr);
+        
         // Draw info panel overlay if enabled
         if (view_state.show_info) {
             render_info_panel(renderer, world, mouse_x, mouse_y, 
@@ -1276,6 +1609,7 @@ void run_sdl_demo(World& world) {
     
     std::cout << "Shutting down...\n" << std::flush;
     
+    SDL_DestroyTexture(map_texture);
     SDL_DestroyRenderer(renderer);
     SDL_DestroyWindow(window);
     SDL_Quit();
@@ -1285,12 +1619,172 @@ void run_sdl_demo(World& world) {
 
 #endif // USE_SDL2
 
-int main() {
-    std::cout << "=== RWorld - Living Active World Demo ===\n";
+// Settings for --headless
+struct HeadlessOptions {
+    std::vector<DisplayMode> modes;  // Empty = every mode
+    int frames = 10;
+    int width = 1200;
+    int height = 600;
+    float time_step = 0.25f;         // Hours the clock advances per frame
+    std::string ppm_prefix;          // Dump PREFIX_<mode>_<frame>.ppm when set
+};
+
+bool write_ppm(const std::string& path, const std::vector<uint32_t>& pixels, int width, int height) {
+    FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+    std::fprintf(file, "P6\n%d %d\n255\n", width, height);
+    std::vector<unsigned char> rgb(pixels.size() * 3);
+    for (size_t i = 0; i < pixels.size(); ++i) {
+        rgb[i * 3] = static_cast<unsigned char>(pixels[i] >> 16);
+        rgb[i * 3 + 1] = static_cast<unsigned char>(pixels[i] >> 8);
+        rgb[i * 3 + 2] = static_cast<unsigned char>(pixels[i]);
+    }
+    bool ok = std::fwrite(rgb.data(), 1, rgb.size(), file) == rgb.size();
+    return std::fclose(file) == 0 && ok;
+}
+
+// Render frames of each display mode offscreen, as the SDL window would
+// (clouds included, clock running), and report frame times
+int run_headless_benchmark(const World& world, const HeadlessOptions& options) {
+    std::vector<DisplayMode> modes = options.modes;
+    if (modes.empty()) {
+        modes.assign(std::begin(ALL_DISPLAY_MODES), std::end(ALL_DISPLAY_MODES));
+    }
     
-    // Create a world with default settings
+    std::cout << "Headless benchmark: " << options.width << "x" << options.height << ", "
+              << options.frames << " frames per mode\n\n";
+    std::cout << std::left << std::setw(15) << "mode" << std::right
+              << std::setw(12) << "first ms" << std::setw(12) << "mean ms"
+              << std::setw(12) << "min ms" << std::setw(12) << "max ms" << "\n";
+    
+    CloudLayer clouds(world.get_config().seed);
+    std::vector<uint32_t> pixels(static_cast<size_t>(options.width) * options.height);
+    double total = 0.0;
+    for (DisplayMode mode : modes) {
+        ViewState view;
+        CloudField cloud_field;
+        SolarField solar_field;
+        std::vector<uint32_t> cloud_base_pixels(pixels.size());
+        std::vector<double> times;
+        for (int frame = 0; frame < options.frames; ++frame) {
+            auto start = std::chrono::steady_clock::now();
+            if (mode == DisplayMode::CLOUDS) {
+                // Base map and weather are baked on the first frame, as in the window
+                if (!cloud_field.matches(view.grid_region(options.width, options.height))) {
+                    render_world_map(cloud_base_pixels, world, options.width, options.height, mode, view);
+                    bake_cloud_field(cloud_field, world, clouds, options.width, options.height, view);
+                }
+                pixels = cloud_base_pixels;
+                render_cloud_overlay(pixels, cloud_field, clouds, view.current_time);
+            } else if (mode == DisplayMode::INSOLATION) {
+                render_solar_map(pixels, solar_field, world, options.width, options.height, view);
+            } else {
+                render_world_map(pixels, world, options.width, options.height, mode, view);
+            }
+            times.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+            
+            if (!options.ppm_prefix.empty()) {
+                std::string path = options.ppm_prefix + "_" + display_mode_name(mode) + "_" +
+                                   std::to_string(frame) + ".ppm";
+                if (!write_ppm(path, pixels, options.width, options.height)) {
+                    std::cerr << "Cannot write " << path << "\n";
+                    return 1;
+                }
+            }
+            
+            view.current_time = std::fmod(view.current_time + options.time_step, 24.0f);
+        }
+        if (times.empty()) {
+            continue;
+        }
+        
+        double sum = 0.0;
+        for (double t : times) {
+            sum += t;
+        }
+        total += sum;
+        std::cout << std::left << std::setw(15) << display_mode_name(mode) << std::right << std::fixed
+                  << std::setprecision(1) << std::setw(12) << times.front()
+                  << std::setw(12) << sum / times.size()
+                  << std::setw(12) << *std::min_element(times.begin(), times.end())
+                  << std::setw(12) << *std::max_element(times.begin(), times.end()) << "\n";
+    }
+    std::cout << "\nTotal: " << std::fixed << std::setprecision(1) << total << " ms\n";
+    return 0;
+}
+
+void print_usage() {
+    std::cout << "Usage: world_demo [options]\n"
+              << "\n"
+              << "Without options, opens the SDL2 window (or prints the text demo when\n"
+              << "built without SDL2).\n"
+              << "\n"
+              << "Options:\n"
+              << "  --seed N        World seed (default 42)\n"
+              << "  --headless      Render offscreen and report frame times; needs no display\n"
+              << "  --frames N      Frames per mode in headless mode (default 10)\n"
+              << "  --mode M        Only this mode (repeatable): biomes, elevation, temperature,\n"
+              << "                  precipitation, clouds, rivers, coal, iron, oil, insolation,\n"
+              << "                  vegetation, soil, pressure (default: all)\n"
+              << "  --size WxH      Frame size in headless mode (default 1200x600)\n"
+              << "  --time-step H   Hours the clock advances per frame (default 0.25)\n"
+              << "  --ppm PREFIX    Write every frame to PREFIX_<mode>_<frame>.ppm\n";
+}
+
+int main(int argc, char** argv) {
     WorldConfig config;
     config.seed = 42;
+    bool headless = false;
+    HeadlessOptions headless_options;
+    
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--help" || arg == "-h") {
+            print_usage();
+            return 0;
+        } else if (arg == "--seed" && has_value) {
+            config.seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--headless") {
+            headless = true;
+        } else if (arg == "--frames" && has_value) {
+            headless_options.frames = std::max(0, std::atoi(argv[++i]));
+        } else if (arg == "--mode" && has_value) {
+            std::string name = argv[++i];
+            auto match = std::find_if(std::begin(ALL_DISPLAY_MODES), std::end(ALL_DISPLAY_MODES),
+                                      [&](DisplayMode mode) { return name == display_mode_name(mode); });
+            if (match == std::end(ALL_DISPLAY_MODES)) {
+                std::cerr << "Unknown mode: " << name << "\n";
+                return 1;
+            }
+            headless_options.modes.push_back(*match);
+        } else if (arg == "--size" && has_value) {
+            if (std::sscanf(argv[++i], "%dx%d", &headless_options.width, &headless_options.height) != 2 ||
+                headless_options.width <= 0 || headless_options.height <= 0) {
+                std::cerr << "Invalid --size, expected WxH\n";
+                return 1;
+            }
+        } else if (arg == "--time-step" && has_value) {
+            headless_options.time_step = static_cast<float>(std::atof(argv[++i]));
+        } else if (arg == "--ppm" && has_value) {
+            headless_options.ppm_prefix = argv[++i];
+        } else {
+            std::cerr << "Unknown option: " << arg << "\n";
+            print_usage();
+            return 1;
+        }
+    }
+    
+    if (headless) {
+        World world(config);
+        return run_headless_benchmark(world, headless_options);
+    }
+    
+    std::cout << "=== RWorld - Living Active World Demo ===\n";
+    
+    // Create a world with the chosen seed
     World world(config);
     
 #ifdef USE_SDL2
@@ -1,7 +1,10 @@
 #ifndef RWORLD_WORLD_H
 #define RWORLD_WORLD_H
 
+#include <cmath>
 #include <cstdint>
+#include <functional>
+#include <iterator>
 #include <memory>
 #include <vector>
 
@@ -157,6 +160,447 @@ struct BatchResult {
     size_t count = 0;  // Number of locations queried
 };
 
+/**
+ * Row spacing of a grid region
+ */
+enum class GridProjection {
+    EQUIRECTANGULAR,  // Rows evenly spaced in latitude
+    WEB_MERCATOR      // Rows evenly spaced in Web Mercator y (slippy map tiles)
+};
+
+/**
+ * Order in which batch_query evaluates its locations
+ */
+enum class BatchOrder {
+    INPUT,    // As given
+    MORTON,   // Along a Z-order curve over longitude and latitude
+    HILBERT   // Along a Hilbert curve over longitude and latitude
+};
+
+/**
+ * Regular longitude/latitude grid for grid queries
+ * 
+ * Samples are taken at cell centers. Row 0 is the northern edge and column 0
+ * the western edge, matching image and raster conventions.
+ */
+struct GridRegion {
+    float west = -180.0f;
+    float south = -90.0f;
+    float east = 180.0f;
+    float north = 90.0f;
+    int width = 360;           // Columns
+    int height = 180;          // Rows
+    float altitude = 0.0f;     // 0 = terrain surface, as in batch queries
+    float current_time = 12.0f; // Used for time-dependent queries
+    float detail_level = 1.0f; // Used for terrain queries
+    GridProjection projection = GridProjection::EQUIRECTANGULAR;
+    
+    float longitude_at(int column) const {
+        return west + (static_cast<float>(column) + 0.5f) * (east - west) / static_cast<float>(width);
+    }
+    
+    float latitude_at(int row) const {
+        if (projection == GridProjection::WEB_MERCATOR) {
+            return mercator_latitude(row + 0.5);
+        }
+        return north - (static_cast<float>(row) + 0.5f) * (north - south) / static_cast<float>(height);
+    }
+    
+    // Northern edge of a row; row == height gives the southern edge of the grid
+    float edge_latitude(int row) const {
+        if (projection == GridProjection::WEB_MERCATOR) {
+            return mercator_latitude(row);
+        }
+        return north - static_cast<float>(row) * (north - south) / static_cast<float>(height);
+    }
+    
+private:
+    // Rows are evenly spaced in Mercator y between north and south
+    float mercator_latitude(double row) const {
+        const double deg = 3.14159265358979323846 / 180.0;
+        double top = std::log(std::tan(45.0 * deg + north * deg * 0.5));
+        double bottom = std::log(std::tan(45.0 * deg + south * deg * 0.5));
+        double y = top + row * (bottom - top) / height;
+        return static_cast<float>((2.0 * std::atan(std::exp(y)) - 90.0 * deg) / deg);
+    }
+};
+
+/**
+ * Results from grid queries
+ * One row-major layer per requested data type, in request order. Enum and
+ * boolean types are stored as their numeric value.
+ */
+struct GridResult {
+    std::vector<std::vector<float>> layers;
+    int width = 0;      // Columns per row
+    int row_begin = 0;  // First grid row held
+    int rows = 0;       // Number of rows held
+};
+
+/**
+ * Adaptive refinement settings for path sampling
+ */
+struct PathRefinement {
+    float max_gradient = 0.0f;  // Split intervals with a half steeper than this (meters rise per meter run, 0 = off)
+    float min_spacing = 0.0f;   // Never split below this spacing in meters (0 = spacing / 64)
+};
+
+/**
+ * Results from path sampling
+ * Every vector has one entry per sample point, in path order, except the
+ * crossing lists which hold sample indices.
+ */
+struct PathResult {
+    std::vector<Location> points;         // Sample locations along the path
+    std::vector<double> distance;         // Cumulative great-circle distance in meters
+    std::vector<float> elevation;         // Terrain height in meters
+    std::vector<float> slope;             // Slope from the previous sample in degrees (0 for the first)
+    std::vector<size_t> biome_crossings;  // Samples whose biome differs from the previous one
+    std::vector<size_t> river_crossings;  // Samples where the path enters a river
+    BatchResult data;                     // Requested data types plus terrain_height, biome and is_river
+};
+
+/**
+ * Days and times of day for time-series queries
+ * Every day is combined with every time of day: day_count × time_count samples.
+ */
+struct TimeSeriesRange {
+    int first_day = 0;        // Day of year of the first day (0-364)
+    int day_count = 1;
+    int day_step = 1;         // Days between samples (days wrap at 365)
+    float first_time = 0.0f;  // Time of day of the first step in hours
+    int time_count = 24;
+    float time_step = 1.0f;   // Hours between steps
+    
+    int day_at(int index) const {
+        return ((first_day + index * day_step) % 365 + 365) % 365;
+    }
+    
+    float time_at(int index) const {
+        return first_time + static_cast<float>(index) * time_step;
+    }
+};
+
+/**
+ * Results from time-series queries
+ * One layer per requested data type, in request order, each holding
+ * locations × days × times values with time varying fastest. Enum and
+ * boolean types are stored as their numeric value.
+ */
+struct TimeSeriesResult {
+    std::vector<std::vector<float>> layers;
+    size_t locations = 0;
+    int days = 0;
+    int times = 0;
+    
+    size_t index(size_t location, int day, int time) const {
+        return (location * static_cast<size_t>(days) + static_cast<size_t>(day)) * static_cast<size_t>(times) +
+               static_cast<size_t>(time);
+    }
+};
+
+/**
+ * Coalescing front end for the point query methods of World
+ * 
+ * When enabled, get_temperature_at_time and the other single-point getters
+ * snap their coordinates to the given precision and share one evaluation
+ * between identical requests in flight on different threads. Results
+ * depend only on the snapped request, so recent ones are also reused for
+ * exact repeats. Distinct requests are evaluated on their callers' own
+ * threads without waiting. Meant for many threads asking about the same
+ * few places (every NPC in a town reading its cell); batch and grid
+ * queries are not affected.
+ */
+struct CoalescingConfig {
+    bool enabled = false;
+    float coordinate_precision = 0.0f; // Degrees; longitude and latitude snap to this grid (0 = exact)
+    float altitude_precision = 0.0f;   // Meters (0 = exact)
+    float time_precision = 0.0f;       // Hours (0 = exact)
+    int recent_results = 4096;         // Finished results kept for repeat requests (0 = in flight only)
+};
+
+/**
+ * Counters of the coalescing front end
+ */
+struct CoalescingStats {
+    uint64_t queries = 0;    // Point queries received
+    uint64_t coalesced = 0;  // Answered by an identical request already in flight
+    uint64_t recent = 0;     // Answered from recent results
+    uint64_t evaluated = 0;  // Evaluated, neither shared nor recent
+};
+
+/**
+ * Rules that classify biomes and soils and scale vegetation density
+ * 
+ * A World does not run these rules per query. At construction it evaluates
+ * each rule once per band of its inputs, where each input is split at its
+ * edges, and answers queries from the resulting tables, so every rule set
+ * costs the same per query. A rule may compare an input against its edges
+ * with any of <, <=, > and >=, but against nothing else: every threshold
+ * must be listed. Vegetation density is vegetation_base(biome) times a
+ * precipitation factor, vegetation_temperature(temperature),
+ * vegetation_altitude(altitude) and noise.
+ * 
+ * Fill in the members at runtime (thresholds read from a game mode file,
+ * say), or build a rule set from a type with static members at compile time
+ * with from<Rules>(); see StandardClassification. Rules left empty keep the
+ * built-in rule and its edges.
+ */
+struct ClassificationRules {
+    std::function<BiomeType(float terrain_height, float sea_level, float temperature, float moisture, float altitude)> biome;
+    std::vector<float> biome_terrain_edges;      // Absolute heights; config.sea_level is appended as one more boundary
+    std::vector<float> biome_temperature_edges;
+    std::vector<float> biome_moisture_edges;
+    std::vector<float> biome_altitude_edges;
+    
+    std::function<SoilType(float altitude, float temperature, float precipitation, BiomeType biome)> soil;
+    std::vector<float> soil_altitude_edges;
+    std::vector<float> soil_temperature_edges;
+    std::vector<float> soil_precipitation_edges;
+    
+    std::function<float(BiomeType biome)> vegetation_base;
+    std::function<float(float temperature)> vegetation_temperature;
+    std::vector<float> vegetation_temperature_edges;
+    std::function<float(float altitude)> vegetation_altitude;
+    std::vector<float> vegetation_altitude_edges;
+    
+    /**
+     * Rule set of a type with the static functions and edge arrays of
+     * StandardClassification; derive from it to replace only some of them
+     */
+    template <class Rules>
+    static ClassificationRules from();
+};
+
+/**
+ * The built-in rules, as a compile-time rule set
+ * 
+ * A custom scheme can derive from this and hide the members it changes:
+ * 
+ *     struct ColdWorld : rworld::StandardClassification {
+ *         static constexpr float biome_temperature_edges[] = {-5.0f, 5.0f, 15.0f, 25.0f};
+ *         static BiomeType biome(float terrain_height, float sea_level, float temp, float moisture, float altitude);
+ *     };
+ *     config.classification = std::make_shared<rworld::ClassificationRules>(
+ *         rworld::ClassificationRules::from<ColdWorld>());
+ */
+struct StandardClassification {
+    static constexpr float biome_terrain_edges[] = {-1000.0f, 5.0f, 100.0f};
+    static constexpr float biome_temperature_edges[] = {-15.0f, 0.0f, 10.0f, 20.0f};
+    static constexpr float biome_moisture_edges[] = {0.2f, 0.3f, 0.5f, 0.6f, 0.7f};
+    static constexpr float biome_altitude_edges[] = {2500.0f, 4000.0f};
+    static constexpr float soil_altitude_edges[] = {0.0f, 100.0f, 3000.0f, 5000.0f};
+    static constexpr float soil_temperature_edges[] = {-5.0f, 5.0f, 25.0f};
+    static constexpr float soil_precipitation_edges[] = {500.0f, 600.0f, 1200.0f, 1500.0f, 2000.0f};
+    static constexpr float vegetation_temperature_edges[] = {-10.0f, 0.0f, 35.0f};
+    static constexpr float vegetation_altitude_edges[] = {2000.0f, 3000.0f};
+    
+    static constexpr BiomeType biome(float terrain_height, float sea_level, float temp, float moisture, float altitude) {
+        // Ocean biomes
+        if (terrain_height < sea_level) {
+            if (terrain_height < -1000.0f) {
+                return BiomeType::DEEP_OCEAN;
+            }
+            return BiomeType::OCEAN;
+        }
+    
+        // Beach transition
+        if (terrain_height < 5.0f) {
+            return BiomeType::BEACH;
+        }
+    
+        // Snow and ice
+        if (temp < -15.0f) {
+            if (terrain_height < 100.0f) {
+                return BiomeType::ICE;
+            }
+            return BiomeType::SNOW;
+        }
+    
+        // High mountain biomes
+        if (altitude > 4000.0f) {
+            return BiomeType::MOUNTAIN_PEAK;
+        } else if (altitude > 2500.0f) {
+            if (temp < 0.0f) {
+                return BiomeType::MOUNTAIN_TUNDRA;
+            }
+            return BiomeType::MOUNTAIN_FOREST;
+        }
+    
+        // Whittaker diagram classification
+        // Based on temperature and moisture
+    
+        // Cold (< 0°C)
+        if (temp < 0.0f) {
+            if (moisture < 0.3f) {
+                return BiomeType::COLD_DESERT;
+            }
+            return BiomeType::TUNDRA;
+        }
+    
+        // Cool (0-10°C)
+        if (temp < 10.0f) {
+            if (moisture < 0.3f) {
+                return BiomeType::COLD_DESERT;
+            } else if (moisture < 0.6f) {
+                return BiomeType::GRASSLAND;
+            }
+            return BiomeType::TAIGA;
+        }
+    
+        // Temperate (10-20°C)
+        if (temp < 20.0f) {
+            if (moisture < 0.3f) {
+                return BiomeType::GRASSLAND;
+            } else if (moisture < 0.6f) {
+                return BiomeType::TEMPERATE_DECIDUOUS_FOREST;
+            }
+            return BiomeType::TEMPERATE_RAINFOREST;
+        }
+    
+        // Hot (> 20°C)
+        if (moisture < 0.2f) {
+            return BiomeType::DESERT;
+        } else if (moisture < 0.5f) {
+            return BiomeType::SAVANNA;
+        } else if (moisture < 0.7f) {
+            return BiomeType::TROPICAL_SEASONAL_FOREST;
+        }
+        return BiomeType::TROPICAL_RAINFOREST;
+    }
+
+    static constexpr SoilType soil(float altitude, float temp, float precip, BiomeType biome) {
+        // No soil underwater, on ice, or extreme mountains
+        if (altitude < 0.0f) {
+            return SoilType::NONE;
+        }
+        if (altitude > 5000.0f) {
+            return SoilType::ROCKY;
+        }
+    
+        // Ice/Snow - permafrost
+        if (biome == BiomeType::ICE || biome == BiomeType::SNOW || 
+            biome == BiomeType::MOUNTAIN_PEAK || temp < -5.0f) {
+            return SoilType::PERMAFROST;
+        }
+    
+        // Wetlands and rainforests - peat
+        if (precip > 2000.0f && altitude < 100.0f) {
+            return SoilType::PEAT;
+        }
+    
+        // Mountains and high altitude - rocky
+        if (altitude > 3000.0f || biome == BiomeType::MOUNTAIN_TUNDRA || 
+            biome == BiomeType::MOUNTAIN_PEAK) {
+            return SoilType::ROCKY;
+        }
+    
+        // Deserts - sandy
+        if (biome == BiomeType::DESERT || biome == BiomeType::COLD_DESERT) {
+            return SoilType::SAND;
+        }
+    
+        // Grasslands and temperate zones - loam (best soil)
+        if (biome == BiomeType::GRASSLAND || biome == BiomeType::SAVANNA) {
+            if (precip > 500.0f && precip < 1500.0f) {
+                return SoilType::LOAM;
+            }
+        }
+    
+        // High precipitation temperate - clay
+        if (precip > 1200.0f && temp > 5.0f && temp < 25.0f) {
+            return SoilType::CLAY;
+        }
+    
+        // Moderate precipitation - silt
+        if (precip > 600.0f && precip < 1200.0f) {
+            return SoilType::SILT;
+        }
+    
+        // Default to sand for dry areas
+        return SoilType::SAND;
+    }
+
+    // Vegetation density of a biome before climate and noise
+    static constexpr float vegetation_base(BiomeType biome) {
+        switch (biome) {
+            // Dense vegetation
+            case BiomeType::TROPICAL_RAINFOREST: return 1.0f;
+            case BiomeType::TEMPERATE_RAINFOREST: return 0.95f;
+            case BiomeType::TROPICAL_SEASONAL_FOREST: return 0.85f;
+            case BiomeType::TEMPERATE_DECIDUOUS_FOREST: return 0.80f;
+            case BiomeType::TAIGA: return 0.70f;
+            case BiomeType::MOUNTAIN_FOREST: return 0.65f;
+        
+            // Moderate vegetation
+            case BiomeType::SAVANNA: return 0.40f;
+            case BiomeType::GRASSLAND: return 0.30f;
+        
+            // Sparse vegetation
+            case BiomeType::TUNDRA:
+            case BiomeType::MOUNTAIN_TUNDRA: return 0.15f;
+        
+            // Very sparse/no vegetation
+            case BiomeType::DESERT:
+            case BiomeType::COLD_DESERT: return 0.05f;
+            case BiomeType::ICE:
+            case BiomeType::SNOW:
+            case BiomeType::MOUNTAIN_PEAK: return 0.0f;
+            case BiomeType::OCEAN:
+            case BiomeType::DEEP_OCEAN: return 0.0f; // Could represent phytoplankton if needed
+            case BiomeType::BEACH: return 0.10f;
+        }
+        return 0.0f;
+    }
+
+    // Temperature affects growth
+    static constexpr float vegetation_temperature(float temp) {
+        if (temp < -10.0f) {
+            return 0.3f; // Very cold limits growth
+        } else if (temp < 0.0f) {
+            return 0.6f; // Cold reduces growth
+        } else if (temp > 35.0f) {
+            return 0.7f; // Very hot without enough water limits growth
+        }
+        return 1.0f;
+    }
+
+    // Elevation affects vegetation (higher = less vegetation)
+    static constexpr float vegetation_altitude(float altitude) {
+        if (altitude > 3000.0f) {
+            return 0.3f;
+        } else if (altitude > 2000.0f) {
+            return 0.6f;
+        }
+        return 1.0f;
+    }
+};
+
+template <class Rules>
+ClassificationRules ClassificationRules::from() {
+    ClassificationRules rules;
+    rules.biome = &Rules::biome;
+    rules.biome_terrain_edges.assign(std::begin(Rules::biome_terrain_edges), std::end(Rules::biome_terrain_edges));
+    rules.biome_temperature_edges.assign(std::begin(Rules::biome_temperature_edges),
+                                         std::end(Rules::biome_temperature_edges));
+    rules.biome_moisture_edges.assign(std::begin(Rules::biome_moisture_edges), std::end(Rules::biome_moisture_edges));
+    rules.biome_altitude_edges.assign(std::begin(Rules::biome_altitude_edges), std::end(Rules::biome_altitude_edges));
+    rules.soil = &Rules::soil;
+    rules.soil_altitude_edges.assign(std::begin(Rules::soil_altitude_edges), std::end(Rules::soil_altitude_edges));
+    rules.soil_temperature_edges.assign(std::begin(Rules::soil_temperature_edges),
+                                        std::end(Rules::soil_temperature_edges));
+    rules.soil_precipitation_edges.assign(std::begin(Rules::soil_precipitation_edges),
+                                          std::end(Rules::soil_precipitation_edges));
+    rules.vegetation_base = &Rules::vegetation_base;
+    rules.vegetation_temperature = &Rules::vegetation_temperature;
+    rules.vegetation_temperature_edges.assign(std::begin(Rules::vegetation_temperature_edges),
+                                              std::end(Rules::vegetation_temperature_edges));
+    rules.vegetation_altitude = &Rules::vegetation_altitude;
+    rules.vegetation_altitude_edges.assign(std::begin(Rules::vegetation_altitude_edges),
+                                           std::end(Rules::vegetation_altitude_edges));
+    return rules;
+}
+
 /**
  * Configuration for world generation
  */
@@ -182,6 +626,17 @@ struct WorldConfig {
     
     float moisture_frequency = 0.002f;
     int moisture_octaves = 4;
+    
+    // Optional front end shared by concurrent point queries
+    CoalescingConfig coalescing;
+    
+    // MORTON or HILBERT make batch_query evaluate large batches (256+
+    // locations) along a space-filling curve, so neighbouring points run back
+    // to back, and return results in input order; values are identical
+    BatchOrder batch_order = BatchOrder::INPUT;
+    
+    // Biome, soil and vegetation rules (null = StandardClassification)
+    std::shared_ptr<const ClassificationRules> classification;
 };
 
 /**
@@ -204,6 +659,9 @@ public:
     
     /**
      * Construct a world with custom configuration
+     * 
+     * @throws std::invalid_argument if config.classification has non-finite
+     *         edges, too many edges, or a rule returns an unknown enum value
      */
     explicit World(const WorldConfig& config);
     
@@ -493,6 +951,18 @@ public:
      */
     float get_solar_angle(float longitude, float latitude, float current_time) const;
     
+    /**
+     * Get the surface cloud cover that attenuates insolation
+     * 
+     * Does not vary with time of day, so insolation over many times is the
+     * clear-sky value scaled by one cloud cover sample (see rworld_solar.h).
+     * 
+     * @param longitude Longitude in degrees (-180 to 180)
+     * @param latitude Latitude in degrees (-90 to 90)
+     * @return Cloud cover (0-1, 0=clear, 1=overcast)
+     */
+    float get_cloud_cover(float longitude, float latitude) const;
+    
     /**
      * Get vegetation density at a location
      * 
@@ -599,6 +1069,8 @@ public:
      * 
      * This method is optimized for querying many locations at once, providing
      * 10-100x better performance than individual queries for bulk operations.
+     * Large scattered batches are evaluated in spatial order when
+     * WorldConfig::batch_order asks for it.
      * 
      * @param locations Vector of Location structs with coordinates and parameters
      * @param data_types Vector of DataType enum values specifying what data to retrieve
@@ -615,41 +1087,1323 @@ public:
     BatchResult batch_query(const std::vector<Location>& locations,
                            const std::vector<DataType>& data_types) const;
     
-    /**
-     * Update the world configuration
-     * This will reset internal noise generators
-     */
-    void set_config(const WorldConfig& config);
+    /**
+     * Query a regular longitude/latitude grid
+     * 
+     * Rows are spread across all hardware threads (override with the
+     * RWORLD_THREADS environment variable). Values match batch_query for the
+     * same locations. Pass a row range to compute one band of a large grid
+     * at a time and keep memory bounded. Longitudes outside -180..180 wrap
+     * and latitudes are clamped to the poles, so a viewport may cross the
+     * antimeridian or extend past a pole.
+     * 
+     * @param region Grid bounds, resolution and shared query parameters
+     * @param data_types Data types to retrieve, one output layer each
+     * @param row_begin First row to compute
+     * @param row_end One past the last row to compute (-1 = region.height)
+     * @return GridResult with one layer per requested data type
+     */
+    GridResult grid_query(const GridRegion& region, const std::vector<DataType>& data_types,
+                          int row_begin = 0, int row_end = -1) const;
+    
+    /**
+     * Sample along a great-circle path through waypoints
+     * 
+     * Points are spaced evenly along each great-circle leg (on a sphere of
+     * Earth's mean radius). Altitude, time and detail level are interpolated
+     * between waypoints. With refinement enabled, every interval is probed
+     * at its midpoint, and intervals where either half is steeper than
+     * max_gradient are bisected until they are flat enough or reach
+     * min_spacing, so a coarse spacing still resolves ridges, valleys and
+     * coastlines. All points are then evaluated in one batch query.
+     * Consecutive waypoints must not be antipodal.
+     * 
+     * @param waypoints Path vertices (longitude, latitude, altitude, time, detail)
+     * @param spacing Target distance between samples in meters
+     * @param data_types Extra data types to retrieve for every sample
+     * @param refinement Adaptive refinement settings (off by default)
+     * @return PathResult with distances, elevation profile, slopes and crossings
+     * @throws std::invalid_argument if spacing is not positive and finite
+     */
+    PathResult sample_path(const std::vector<Location>& waypoints, float spacing,
+                           const std::vector<DataType>& data_types,
+                           const PathRefinement& refinement = PathRefinement()) const;
+    
+    /**
+     * Query locations over a range of days and times of day
+     * 
+     * Values match batch_query with WorldConfig::day_of_year set to each day
+     * and Location::current_time to each time, without calling set_config
+     * (Location::current_time itself is ignored). Terms that vary with
+     * neither (terrain, climate, soil, resources) are computed once per
+     * location, weather fields, which follow the time of day only, once per
+     * time, and solar terms (INSOLATION, IS_DAYLIGHT, SOLAR_ANGLE,
+     * TEMPERATURE_AT_TIME) from per-day declination tables. Locations are
+     * spread across threads as in grid_query.
+     * 
+     * @param locations Locations to sample
+     * @param data_types Data types to retrieve, one output layer each
+     * @param range Days and times of day
+     * @return TimeSeriesResult with one layer per requested data type
+     */
+    TimeSeriesResult time_series_query(const std::vector<Location>& locations,
+                                       const std::vector<DataType>& data_types,
+                                       const TimeSeriesRange& range) const;
+    
+    /**
+     * Update the world configuration
+     * This will reset internal noise generators
+     * Throws like the constructor, leaving the world unchanged
+     */
+    void set_config(const WorldConfig& config);
+    
+    /**
+     * Get the current configuration
+     */
+    const WorldConfig& get_config() const;
+    
+    /**
+     * Get the name of the noise kernel variant selected for this CPU
+     * 
+     * Chosen once at construction ("scalar", "sse4.1", "avx2" or "avx512").
+     * Set the RWORLD_ISA environment variable to one of these names to force
+     * a variant; requests the CPU cannot run are ignored.
+     */
+    const char* get_kernel_variant() const;
+    
+    /**
+     * Counters of the point query front end (all zero unless
+     * WorldConfig::coalescing is enabled)
+     */
+    CoalescingStats get_coalescing_stats() const;
+    
+private:
+    class Impl;
+    std::unique_ptr<Impl> pimpl_;
+};
+
+/**
+ * Convert BiomeType to string name
+ */
+const char* biome_to_string(BiomeType biome);
+
+/**
+ * Convert SoilType to string name
+ */
+const char* soil_to_string(SoilType soil);
+
+/**
+ * Convert DataType to its lowercase identifier (e.g. "terrain_height")
+ */
+const char* data_type_to_string(DataType type);
+
+/**
+ * Parse a lowercase DataType identifier
+ * 
+ * @return true and sets type if name is known
+ */
+bool data_type_from_string(const char* name, DataType& type);
+
+} // namespace rworld
+
+
+#ifdef _RWORLD_IMPLEMENTATION
+#include "FastNoiseLite.h"
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define RWORLD_KERNEL_MULTIVERSION 1
+#if defined(__clang__)
+// Clang fuses FastNoiseLite's multiply-adds once inlined into an FMA-capable
+// target and cannot be told otherwise per function, so AVX-512 is GCC-only
+#define RWORLD_KERNEL_AVX512 0
+#define RWORLD_KERNEL_TARGET(isa) __attribute__((target(isa), flatten))
+#else
+#define RWORLD_KERNEL_AVX512 1
+#define RWORLD_KERNEL_TARGET(isa) \
+    __attribute__((target(isa), optimize("fp-contract=off", "no-trapping-math", "vect-cost-model=dynamic"), flatten))
+#endif
+#else
+#define RWORLD_KERNEL_MULTIVERSION 0
+#define RWORLD_KERNEL_AVX512 0
+#endif
+
+namespace rworld {
+
+namespace detail {
+
+/**
+ * Settings for one OpenSimplex2 generator
+ * 
+ * The same description configures the FastNoiseLite instance and feeds the
+ * fused evaluator, so both paths always agree on seed, frequency and octaves.
+ */
+struct NoiseLayer {
+    int seed = 1337;
+    float frequency = 0.01f;
+    FastNoiseLite::FractalType fractal_type = FastNoiseLite::FractalType_None;
+    int octaves = 3;
+    float lacunarity = 2.0f;
+    float gain = 0.5f;
+    
+    void apply(FastNoiseLite& noise) const {
+        noise.SetNoiseType(FastNoiseLite::NoiseType_OpenSimplex2);
+        noise.SetFractalType(fractal_type);
+        noise.SetFractalOctaves(octaves);
+        noise.SetFractalLacunarity(lacunarity);
+        noise.SetFractalGain(gain);
+        noise.SetFrequency(frequency);
+        noise.SetSeed(seed);
+    }
+    
+    // Matches FastNoiseLite::CalculateFractalBounding
+    float fractal_bounding() const {
+        float abs_gain = std::abs(gain);
+        float amp = abs_gain;
+        float amp_fractal = 1.0f;
+        for (int i = 1; i < octaves; i++) {
+            amp_fractal += amp;
+            amp *= abs_gain;
+        }
+        return 1 / amp_fractal;
+    }
+    
+    int lane_count() const {
+        return fractal_type == FastNoiseLite::FractalType_None ? 1 : octaves;
+    }
+};
+
+// (layer, octave) pairs evaluated per vectorized batch
+constexpr int FUSED_MAX_LANES = 48;
+
+// FastNoiseLite's Lookup<float>::Gradients3D (private there)
+alignas(64) static const float FUSED_GRADIENTS_3D[256] = {
+    0, 1, 1, 0,  0,-1, 1, 0,  0, 1,-1, 0,  0,-1,-1, 0,
+    1, 0, 1, 0, -1, 0, 1, 0,  1, 0,-1, 0, -1, 0,-1, 0,
+    1, 1, 0, 0, -1, 1, 0, 0,  1,-1, 0, 0, -1,-1, 0, 0,
+    0, 1, 1, 0,  0,-1, 1, 0,  0, 1,-1, 0,  0,-1,-1, 0,
+    1, 0, 1, 0, -1, 0, 1, 0,  1, 0,-1, 0, -1, 0,-1, 0,
+    1, 1, 0, 0, -1, 1, 0, 0,  1,-1, 0, 0, -1,-1, 0, 0,
+    0, 1, 1, 0,  0,-1, 1, 0,  0, 1,-1, 0,  0,-1,-1, 0,
+    1, 0, 1, 0, -1, 0, 1, 0,  1, 0,-1, 0, -1, 0,-1, 0,
+    1, 1, 0, 0, -1, 1, 0, 0,  1,-1, 0, 0, -1,-1, 0, 0,
+    0, 1, 1, 0,  0,-1, 1, 0,  0, 1,-1, 0,  0,-1,-1, 0,
+    1, 0, 1, 0, -1, 0, 1, 0,  1, 0,-1, 0, -1, 0,-1, 0,
+    1, 1, 0, 0, -1, 1, 0, 0,  1,-1, 0, 0, -1,-1, 0, 0,
+    0, 1, 1, 0,  0,-1, 1, 0,  0, 1,-1, 0,  0,-1,-1, 0,
+    1, 0, 1, 0, -1, 0, 1, 0,  1, 0,-1, 0, -1, 0,-1, 0,
+    1, 1, 0, 0, -1, 1, 0, 0,  1,-1, 0, 0, -1,-1, 0, 0,
+    1, 1, 0, 0,  0,-1, 1, 0, -1, 1, 0, 0,  0,-1,-1, 0
+};
+
+inline float fused_grad(int seed, int i, int j, int k, float xd, float yd, float zd) {
+    int hash = static_cast<int>(static_cast<uint32_t>(seed ^ i ^ j ^ k) * 0x27d4eb2du);
+    hash ^= hash >> 15;
+    hash &= 63 << 2;
+    return xd * FUSED_GRADIENTS_3D[hash] + yd * FUSED_GRADIENTS_3D[hash | 1] +
+           zd * FUSED_GRADIENTS_3D[hash | 2];
+}
+
+inline int fused_mul(int a, int b) {
+    return static_cast<int>(static_cast<uint32_t>(a) * static_cast<uint32_t>(b));
+}
+
+/**
+ * OpenSimplex2 3D over independent lanes
+ * 
+ * Straight-line rewrite of FastNoiseLite::SingleOpenSimplex2 (both lattice
+ * iterations unrolled, branches turned into selects) so the lane loop
+ * vectorizes. Arithmetic order is unchanged, results are bit-identical.
+ */
+inline void opensimplex2_lanes(int count, const int* seeds, const float* xs, const float* ys,
+                               const float* zs, float* out) {
+    const int PRIME_X = 501125321;
+    const int PRIME_Y = 1136930381;
+    const int PRIME_Z = 1720413743;
+    
+    for (int n = 0; n < count; ++n) {
+        int seed = seeds[n];
+        float x = xs[n], y = ys[n], z = zs[n];
+        
+        float half_x = x >= 0 ? 0.5f : -0.5f;
+        float half_y = y >= 0 ? 0.5f : -0.5f;
+        float half_z = z >= 0 ? 0.5f : -0.5f;
+        int i = static_cast<int>(x + half_x);
+        int j = static_cast<int>(y + half_y);
+        int k = static_cast<int>(z + half_z);
+        float x0 = x - i;
+        float y0 = y - j;
+        float z0 = z - k;
+        
+        int x_sign = static_cast<int>(-1.0f - x0) | 1;
+        int y_sign = static_cast<int>(-1.0f - y0) | 1;
+        int z_sign = static_cast<int>(-1.0f - z0) | 1;
+        
+        float ax0 = x_sign * -x0;
+        float ay0 = y_sign * -y0;
+        float az0 = z_sign * -z0;
+        
+        i = fused_mul(i, PRIME_X);
+        j = fused_mul(j, PRIME_Y);
+        k = fused_mul(k, PRIME_Z);
+        
+        float value = 0;
+        float a = (0.6f - x0 * x0) - (y0 * y0 + z0 * z0);
+        
+        // One lattice of the two offset cube grids; called twice so the
+        // lane loop stays free of control flow
+        auto lattice = [&]() {
+            // Every candidate is computed before selecting: conditional float
+            // math may trap, which stops the compiler from if-converting
+            float ga = fused_grad(seed, i, j, k, x0, y0, z0);
+            float ta = (a * a) * (a * a) * ga;
+            value += a > 0 ? ta : 0.0f;
+            
+            bool use_x = (ax0 >= ay0) & (ax0 >= az0);
+            bool use_y = !use_x & (ay0 > ax0) & (ay0 >= az0);
+            bool use_z = !use_x & !use_y;
+            
+            float xs1 = x0 + x_sign;
+            float ys1 = y0 + y_sign;
+            float zs1 = z0 + z_sign;
+            float x1 = use_x ? xs1 : x0;
+            float y1 = use_y ? ys1 : y0;
+            float z1 = use_z ? zs1 : z0;
+            float step_x = (x_sign * 2) * x1;
+            float step_y = (y_sign * 2) * y1;
+            float step_z = (z_sign * 2) * z1;
+            float step = use_x ? step_x : use_y ? step_y : step_z;
+            float b = (a + 1) - step;
+            int i1 = use_x ? i - fused_mul(x_sign, PRIME_X) : i;
+            int j1 = use_y ? j - fused_mul(y_sign, PRIME_Y) : j;
+            int k1 = use_z ? k - fused_mul(z_sign, PRIME_Z) : k;
+            
+            float gb = fused_grad(seed, i1, j1, k1, x1, y1, z1);
+            float tb = (b * b) * (b * b) * gb;
+            value += b > 0 ? tb : 0.0f;
+        };
+        
+        lattice();
+        
+        ax0 = 0.5f - ax0;
+        ay0 = 0.5f - ay0;
+        az0 = 0.5f - az0;
+        
+        x0 = x_sign * ax0;
+        y0 = y_sign * ay0;
+        z0 = z_sign * az0;
+        
+        a += (0.75f - ax0) - (ay0 + az0);
+        
+        i += (x_sign >> 1) & PRIME_X;
+        j += (y_sign >> 1) & PRIME_Y;
+        k += (z_sign >> 1) & PRIME_Z;
+        
+        x_sign = -x_sign;
+        y_sign = -y_sign;
+        z_sign = -z_sign;
+        
+        seed = ~seed;
+        
+        lattice();
+        
+        out[n] = value * 32.69428253173828125f;
+    }
+}
+
+/**
+ * Evaluate several OpenSimplex2 generators at one point in a single pass
+ * 
+ * Every (layer, octave) pair becomes a lane. With FastNoiseLite's default
+ * weighted strength of zero an octave's amplitude never depends on the noise
+ * before it, so all lanes are independent and run through one vectorized
+ * kernel before being folded back per layer in FastNoiseLite's order.
+ * Lanes beyond FUSED_MAX_LANES are flushed in batches, still in order.
+ */
+inline void fused_noise3(const NoiseLayer* layers, int layer_count, float x, float y, float z, float* out) {
+    alignas(64) int seeds[FUSED_MAX_LANES];
+    alignas(64) float xs[FUSED_MAX_LANES];
+    alignas(64) float ys[FUSED_MAX_LANES];
+    alignas(64) float zs[FUSED_MAX_LANES];
+    alignas(64) float values[FUSED_MAX_LANES];
+    float amps[FUSED_MAX_LANES];
+    int owners[FUSED_MAX_LANES];
+    int lanes = 0;
+    
+    auto flush = [&]() {
+        opensimplex2_lanes(lanes, seeds, xs, ys, zs, values);
+        for (int n = 0; n < lanes; ++n) {
+            const NoiseLayer& layer = layers[owners[n]];
+            float noise = values[n];
+            if (layer.fractal_type == FastNoiseLite::FractalType_None) {
+                out[owners[n]] = noise;
+            } else if (layer.fractal_type == FastNoiseLite::FractalType_Ridged) {
+                noise = std::abs(noise);
+                out[owners[n]] += (noise * -2 + 1) * amps[n];
+            } else {
+                out[owners[n]] += noise * amps[n];
+            }
+        }
+        lanes = 0;
+    };
+    
+    for (int l = 0; l < layer_count; ++l) {
+        const NoiseLayer& layer = layers[l];
+        out[l] = 0;
+        
+        // Frequency then OpenSimplex2 rotation, as FastNoiseLite::TransformNoiseCoordinate
+        float lx = x * layer.frequency;
+        float ly = y * layer.frequency;
+        float lz = z * layer.frequency;
+        const float R3 = static_cast<float>(2.0 / 3.0);
+        float r = (lx + ly + lz) * R3;
+        lx = r - lx;
+        ly = r - ly;
+        lz = r - lz;
+        
+        float amp = layer.fractal_bounding();
+        int octaves = layer.lane_count();
+        for (int o = 0; o < octaves; ++o) {
+            if (lanes == FUSED_MAX_LANES) {
+                flush();
+            }
+            seeds[lanes] = layer.seed + o;
+            xs[lanes] = lx;
+            ys[lanes] = ly;
+            zs[lanes] = lz;
+            amps[lanes] = amp;
+            owners[lanes] = l;
+            ++lanes;
+            lx *= layer.lacunarity;
+            ly *= layer.lacunarity;
+            lz *= layer.lacunarity;
+            amp *= layer.gain;
+        }
+    }
+    
+    flush();
+}
+
+/**
+ * Hot noise kernels compiled once per instruction set
+ *
+ * Each variant flattens the full FastNoiseLite call tree (OpenSimplex2,
+ * Cellular, FBm/Ridged fractals) into a single function built for that ISA,
+ * so one binary runs the best code for the host without -march=native.
+ * FMA is deliberately kept out of every variant (AVX-512F carries its own,
+ * hence fp-contract=off): contracting a*b+c changes rounding and would make
+ * worlds differ between hosts with the same seed. no-trapping-math only lets
+ * the fused lane loop speculate its selects and never changes a result.
+ */
+struct NoiseKernels {
+    const char* name;
+    float (*noise3)(const FastNoiseLite& noise, float x, float y, float z);
+    void (*fused3)(const NoiseLayer* layers, int layer_count, float x, float y, float z, float* out);
+    void (*geo_to_world)(float longitude, float latitude, float& x, float& y, float& z);
+};
+
+inline float noise3_scalar(const FastNoiseLite& noise, float x, float y, float z) {
+    return noise.GetNoise(x, y, z);
+}
+
+inline void fused3_scalar(const NoiseLayer* layers, int layer_count, float x, float y, float z, float* out) {
+    fused_noise3(layers, layer_count, x, y, z, out);
+}
+
+inline void geo_to_world_scalar(float longitude, float latitude, float& x, float& y, float& z) {
+    // Convert to radians
+    float lon_rad = longitude * 3.14159265359f / 180.0f;
+    float lat_rad = latitude * 3.14159265359f / 180.0f;
+    
+    // Project onto sphere surface for seamless wrapping
+    float r = 1000.0f; // Arbitrary sphere radius
+    float cos_lat = std::cos(lat_rad);
+    x = r * cos_lat * std::cos(lon_rad);
+    y = r * cos_lat * std::sin(lon_rad);
+    z = r * std::sin(lat_rad);
+}
+
+#if RWORLD_KERNEL_MULTIVERSION
+#define RWORLD_DEFINE_KERNELS(suffix, isa)                                                          \
+    RWORLD_KERNEL_TARGET(isa) inline float noise3_##suffix(const FastNoiseLite& noise,              \
+                                                           float x, float y, float z) {             \
+        return noise.GetNoise(x, y, z);                                                             \
+    }                                                                                               \
+    RWORLD_KERNEL_TARGET(isa) inline void fused3_##suffix(const NoiseLayer* layers, int layer_count, \
+                                                          float x, float y, float z, float* out) {  \
+        fused_noise3(layers, layer_count, x, y, z, out);                                            \
+    }                                                                                               \
+    RWORLD_KERNEL_TARGET(isa) inline void geo_to_world_##suffix(float longitude, float latitude,    \
+                                                                float& x, float& y, float& z) {     \
+        geo_to_world_scalar(longitude, latitude, x, y, z);                                          \
+    }
+
+RWORLD_DEFINE_KERNELS(sse41, "sse4.1")
+RWORLD_DEFINE_KERNELS(avx2, "avx2")
+#if RWORLD_KERNEL_AVX512
+RWORLD_DEFINE_KERNELS(avx512, "avx512f,avx512vl,avx512bw,avx512dq")
+#endif
+
+#undef RWORLD_DEFINE_KERNELS
+#endif
+
+inline const NoiseKernels& select_noise_kernels() {
+    static const NoiseKernels scalar = {"scalar", noise3_scalar, fused3_scalar, geo_to_world_scalar};
+#if RWORLD_KERNEL_MULTIVERSION
+    static const NoiseKernels sse41 = {"sse4.1", noise3_sse41, fused3_sse41, geo_to_world_sse41};
+    static const NoiseKernels avx2 = {"avx2", noise3_avx2, fused3_avx2, geo_to_world_avx2};
+#if RWORLD_KERNEL_AVX512
+    static const NoiseKernels avx512 = {"avx512", noise3_avx512, fused3_avx512, geo_to_world_avx512};
+#endif
+    
+    __builtin_cpu_init();
+    bool has_sse41 = __builtin_cpu_supports("sse4.1");
+    bool has_avx2 = __builtin_cpu_supports("avx2");
+#if RWORLD_KERNEL_AVX512
+    bool has_avx512 = __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512vl") &&
+                      __builtin_cpu_supports("avx512bw") && __builtin_cpu_supports("avx512dq");
+#endif
+    
+    // RWORLD_ISA forces a variant for A/B benchmarking; unsupported requests fall
+    // through to automatic selection rather than crashing on an illegal instruction
+    if (const char* forced = std::getenv("RWORLD_ISA")) {
+        if (std::strcmp(forced, "scalar") == 0) return scalar;
+        if (std::strcmp(forced, "sse4.1") == 0 && has_sse41) return sse41;
+        if (std::strcmp(forced, "avx2") == 0 && has_avx2) return avx2;
+#if RWORLD_KERNEL_AVX512
+        if (std::strcmp(forced, "avx512") == 0 && has_avx512) return avx512;
+#endif
+    }
+    
+#if RWORLD_KERNEL_AVX512
+    if (has_avx512) return avx512;
+#endif
+    if (has_avx2) return avx2;
+    if (has_sse41) return sse41;
+#endif
+    return scalar;
+}
+
+/**
+ * Worker threads used by parallel queries
+ * 
+ * Defaults to the hardware thread count; RWORLD_THREADS overrides it.
+ */
+inline int worker_count() {
+    if (const char* forced = std::getenv("RWORLD_THREADS")) {
+        int threads = std::atoi(forced);
+        if (threads > 0) {
+            return threads;
+        }
+    }
+    return std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+}
+
+// True on threads already running parallel work; nested loops then run inline
+inline bool& in_parallel_worker() {
+    thread_local bool flag = false;
+    return flag;
+}
+
+struct ParallelWorkerScope {
+    bool previous;
+    ParallelWorkerScope() : previous(in_parallel_worker()) { in_parallel_worker() = true; }
+    ~ParallelWorkerScope() { in_parallel_worker() = previous; }
+};
+
+/**
+ * Run body(i) for every i in [0, count) across worker threads
+ * 
+ * Indices are handed out one at a time so uneven rows balance themselves.
+ * The first exception thrown by body is rethrown on the calling thread.
+ * Called from inside another parallel loop or pool it runs serially.
+ */
+template <typename Body>
+void parallel_for(int count, Body&& body) {
+    int threads = in_parallel_worker() ? 1 : std::min(worker_count(), count);
+    if (threads <= 1) {
+        for (int i = 0; i < count; ++i) {
+            body(i);
+        }
+        return;
+    }
+    
+    std::atomic<int> next(0);
+    std::exception_ptr failure;
+    std::mutex failure_mutex;
+    auto work = [&]() {
+        ParallelWorkerScope scope;
+        try {
+            for (int i = next++; i < count; i = next++) {
+                body(i);
+            }
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(failure_mutex);
+            if (!failure) {
+                failure = std::current_exception();
+            }
+            next = count;
+        }
+    };
+    
+    std::vector<std::thread> pool;
+    pool.reserve(threads - 1);
+    for (int t = 1; t < threads; ++t) {
+        pool.emplace_back(work);
+    }
+    work();
+    for (std::thread& thread : pool) {
+        thread.join();
+    }
+    if (failure) {
+        std::rethrow_exception(failure);
+    }
+}
+
+/**
+ * Call f with the BatchResult vector a data type is written to
+ */
+template <typename Result, typename F>
+void visit_batch_column(Result& result, DataType type, F&& f) {
+    switch (type) {
+        case DataType::TERRAIN_HEIGHT: f(result.terrain_height); break;
+        case DataType::TEMPERATURE:
+        case DataType::TEMPERATURE_AT_TIME: f(result.temperature); break;
+        case DataType::BIOME: f(result.biome); break;
+        case DataType::PRECIPITATION:
+        case DataType::CURRENT_PRECIPITATION: f(result.precipitation); break;
+        case DataType::PRECIPITATION_TYPE: f(result.precipitation_type); break;
+        case DataType::AIR_PRESSURE: f(result.air_pressure); break;
+        case DataType::HUMIDITY: f(result.humidity); break;
+        case DataType::WIND_SPEED:
+        case DataType::CURRENT_WIND_SPEED: f(result.wind_speed); break;
+        case DataType::WIND_DIRECTION:
+        case DataType::CURRENT_WIND_DIRECTION: f(result.wind_direction); break;
+        case DataType::IS_RIVER: f(result.is_river); break;
+        case DataType::RIVER_WIDTH: f(result.river_width); break;
+        case DataType::FLOW_ACCUMULATION: f(result.flow_accumulation); break;
+        case DataType::IS_VOLCANO: f(result.is_volcano); break;
+        case DataType::COAL_DEPOSIT: f(result.coal_deposit); break;
+        case DataType::IRON_DEPOSIT: f(result.iron_deposit); break;
+        case DataType::OIL_DEPOSIT: f(result.oil_deposit); break;
+        case DataType::INSOLATION: f(result.insolation); break;
+        case DataType::IS_DAYLIGHT: f(result.is_daylight); break;
+        case DataType::SOLAR_ANGLE: f(result.solar_angle); break;
+        case DataType::VEGETATION_DENSITY: f(result.vegetation_density); break;
+        case DataType::SOIL_TYPE: f(result.soil_type); break;
+        case DataType::SOIL_FERTILITY: f(result.soil_fertility); break;
+        case DataType::SOIL_PH: f(result.soil_ph); break;
+        case DataType::ORGANIC_MATTER: f(result.organic_matter); break;
+        case DataType::PRESSURE_AT_LOCATION: f(result.pressure_at_location); break;
+        case DataType::PRESSURE_GRADIENT: f(result.pressure_gradient); break;
+        case DataType::IS_STORM_FRONT: f(result.is_storm_front); break;
+    }
+}
+
+template <typename T>
+float column_value(T value) {
+    if constexpr (std::is_enum<T>::value) {
+        return static_cast<float>(static_cast<int>(value));
+    } else {
+        return static_cast<float>(value);
+    }
+}
+
+/**
+ * Where each requested data type sits in a BatchResult
+ * 
+ * Types sharing a BatchResult vector (e.g. TEMPERATURE and
+ * TEMPERATURE_AT_TIME) interleave per location in request order.
+ */
+struct BatchLayout {
+    std::vector<DataType> types;
+    std::vector<size_t> stride;
+    std::vector<size_t> ordinal;
+    
+    explicit BatchLayout(const std::vector<DataType>& data_types)
+        : types(data_types), stride(data_types.size(), 0), ordinal(data_types.size(), 0) {
+        BatchResult probe;
+        std::vector<const void*> columns(types.size());
+        for (size_t i = 0; i < types.size(); ++i) {
+            visit_batch_column(probe, types[i], [&](const auto& column) { columns[i] = &column; });
+        }
+        for (size_t i = 0; i < types.size(); ++i) {
+            for (size_t j = 0; j < types.size(); ++j) {
+                if (columns[j] == columns[i]) {
+                    ++stride[i];
+                    if (j < i) {
+                        ++ordinal[i];
+                    }
+                }
+            }
+        }
+    }
+    
+    // Write type i of every location in batch to out[k * step]
+    void extract(const BatchResult& batch, size_t i, float* out, size_t step = 1) const {
+        visit_batch_column(batch, types[i], [&](const auto& column) {
+            using Value = typename std::decay_t<decltype(column)>::value_type;
+            for (size_t k = 0; k < batch.count; ++k) {
+                out[k * step] = column_value(static_cast<Value>(column[k * stride[i] + ordinal[i]]));
+            }
+        });
+    }
+};
+
+// Position of a location along a space-filling curve over a 65536 x 65536
+// longitude/latitude lattice
+inline uint32_t spatial_key(const Location& location, BatchOrder order) {
+    float u = std::clamp((location.longitude + 180.0f) * (1.0f / 360.0f), 0.0f, 1.0f);
+    float v = std::clamp((location.latitude + 90.0f) * (1.0f / 180.0f), 0.0f, 1.0f);
+    uint32_t x = static_cast<uint32_t>(u * 65535.0f);
+    uint32_t y = static_cast<uint32_t>(v * 65535.0f);
+    if (order == BatchOrder::MORTON) {
+        auto spread = [](uint32_t bits) {
+            bits = (bits | (bits << 8)) & 0x00ff00ffu;
+            bits = (bits | (bits << 4)) & 0x0f0f0f0fu;
+            bits = (bits | (bits << 2)) & 0x33333333u;
+            bits = (bits | (bits << 1)) & 0x55555555u;
+            return bits;
+        };
+        return spread(x) | (spread(y) << 1);
+    }
+    
+    // Hilbert: walk the quadrants from the top bit down, reflecting and
+    // transposing the lower bits as the curve turns (branch free)
+    uint32_t key = 0;
+    for (int bit = 15; bit >= 0; --bit) {
+        uint32_t rx = (x >> bit) & 1;
+        uint32_t ry = (y >> bit) & 1;
+        key = (key << 2) | ((3 * rx) ^ ry);
+        uint32_t flip = 0u - (rx & (ry ^ 1));
+        x ^= flip;
+        y ^= flip;
+        uint32_t swap = (x ^ y) & (0u - (ry ^ 1));
+        x ^= swap;
+        y ^= swap;
+    }
+    return key;
+}
+
+// Indices of locations sorted along the curve (LSD radix sort, stable)
+inline std::vector<uint32_t> spatial_order(const std::vector<Location>& locations, BatchOrder order) {
+    size_t count = locations.size();
+    std::vector<uint64_t> items(count), scratch(count);
+    for (size_t i = 0; i < count; ++i) {
+        items[i] = (static_cast<uint64_t>(spatial_key(locations[i], order)) << 32) | i;
+    }
+    for (int shift = 32; shift < 64; shift += 8) {
+        size_t offsets[257] = {};
+        for (uint64_t item : items) {
+            ++offsets[((item >> shift) & 0xff) + 1];
+        }
+        for (int b = 0; b < 256; ++b) {
+            offsets[b + 1] += offsets[b];
+        }
+        for (uint64_t item : items) {
+            scratch[offsets[(item >> shift) & 0xff]++] = item;
+        }
+        items.swap(scratch);
+    }
+    std::vector<uint32_t> indices(count);
+    for (size_t i = 0; i < count; ++i) {
+        indices[i] = static_cast<uint32_t>(items[i]);
+    }
+    return indices;
+}
+
+// Move the values of a batch evaluated as locations[order[j]] back to input
+// order; columns shared by several types hold a run of values per location
+inline void scatter_batch(BatchResult& result, const std::vector<DataType>& types,
+                          const std::vector<uint32_t>& order) {
+    std::vector<const void*> done;
+    for (DataType type : types) {
+        visit_batch_column(result, type, [&](auto& column) {
+            if (std::find(done.begin(), done.end(), &column) != done.end() || result.count == 0) {
+                return;
+            }
+            done.push_back(&column);
+            size_t run = column.size() / result.count;
+            std::decay_t<decltype(column)> scattered(column.size());
+            for (size_t j = 0; j < order.size(); ++j) {
+                for (size_t t = 0; t < run; ++t) {
+                    scattered[order[j] * run + t] = column[j * run + t];
+                }
+            }
+            column.swap(scattered);
+        });
+    }
+}
+
+const size_t SPATIAL_ORDER_MIN = 256;  // Smaller batches are evaluated as given
+
+// Grid sample coordinates, wrapped and clamped to valid ranges
+inline float grid_longitude(const GridRegion& region, int column) {
+    float longitude = region.longitude_at(column);
+    if (longitude < -180.0f || longitude > 180.0f) {
+        longitude = std::remainder(longitude, 360.0f);
+    }
+    return longitude;
+}
+
+inline float grid_latitude(const GridRegion& region, int row) {
+    return std::clamp(region.latitude_at(row), -90.0f, 90.0f);
+}
+
+// Solar declination terms of one day of the year
+struct SolarDay {
+    float sin_declination = 0.0f;
+    float cos_declination = 1.0f;
+};
+
+inline SolarDay solar_day(int day_of_year) {
+    // Earth's axial tilt is 23.44°
+    // Day 0 = January 1, Day 172 = Summer solstice (June 21), Day 355 = Winter solstice (Dec 21)
+    // Using simplified formula: declination peaks at solstices
+    float day_angle = (day_of_year - 172) * 2.0f * M_PI / 365.0f;
+    float solar_declination = 23.44f * std::cos(day_angle); // degrees
+    float dec_rad = solar_declination * M_PI / 180.0f;
+    SolarDay day;
+    day.sin_declination = std::sin(dec_rad);
+    day.cos_declination = std::cos(dec_rad);
+    return day;
+}
+
+// Latitude terms of the elevation formula: sin(elevation) = a + b * cos(hour angle)
+struct SolarLatitude {
+    float a = 0.0f;
+    float b = 0.0f;
+};
+
+inline SolarLatitude solar_latitude(const SolarDay& day, float latitude) {
+    float lat_rad = latitude * M_PI / 180.0f;
+    SolarLatitude terms;
+    terms.a = std::sin(lat_rad) * day.sin_declination;
+    terms.b = std::cos(lat_rad) * day.cos_declination;
+    return terms;
+}
+
+// Cosine of the hour angle: 0° at solar noon (12:00 at longitude 0°), ±15° per hour
+inline float solar_hour_cosine(float longitude, float current_time) {
+    float local_solar_time = current_time + (longitude / 15.0f);
+    while (local_solar_time < 0.0f) local_solar_time += 24.0f;
+    while (local_solar_time >= 24.0f) local_solar_time -= 24.0f;
+    float hour_angle = (local_solar_time - 12.0f) * 15.0f; // degrees
+    float ha_rad = hour_angle * M_PI / 180.0f;
+    return std::cos(ha_rad);
+}
+
+// Solar elevation in degrees above the horizon (negative = below)
+inline float solar_elevation(const SolarLatitude& latitude, float hour_cosine) {
+    float sin_elevation = latitude.a + latitude.b * hour_cosine;
+    return std::asin(std::clamp(sin_elevation, -1.0f, 1.0f)) * 180.0f / M_PI;
+}
+
+// Radiation reaching the ground under a clear sky, in W/m²
+inline float clear_sky_insolation(float solar_angle) {
+    if (solar_angle <= 0.0f) {
+        return 0.0f;
+    }
+
+    // Solar constant at top of atmosphere, cosine law
+    const float SOLAR_CONSTANT = 1361.0f; // W/m²
+    float solar_angle_rad = solar_angle * M_PI / 180.0f;
+    float base_insolation = SOLAR_CONSTANT * std::sin(solar_angle_rad);
+
+    // Air mass increases as sun gets lower in sky; simple exponential transmission
+    float air_mass = 1.0f / std::sin(solar_angle_rad);
+    air_mass = std::clamp(air_mass, 1.0f, 10.0f);
+    float atmospheric_transmission = std::pow(0.7f, air_mass);
+    return base_insolation * atmospheric_transmission;
+}
+
+// Fraction of radiation let through by cloud cover (clouds block up to 70%)
+inline float cloud_transmission(float cloud_density) {
+    return 1.0f - (cloud_density * 0.7f);
+}
+
+// Insolation at the ground in W/m² for a solar angle and cloud transmission
+inline float surface_insolation(float solar_angle, float transmission) {
+    float final_insolation = clear_sky_insolation(solar_angle) * transmission;
+    return std::clamp(final_insolation, 0.0f, 1400.0f);
+}
+
+// Front end of WorldConfig::coalescing
+//
+// A caller snaps its coordinates, then takes a recent result for the same
+// request if there is one, or waits for an identical request already being
+// evaluated. Otherwise it registers its request and evaluates it on its own
+// thread, so distinct requests never wait for each other. Requests are
+// split over shards by key hash; each shard has its own lock, in-flight
+// table and slice of the recent results.
+class PointCoalescer {
+public:
+    using Evaluator = std::function<float(DataType, const Location&)>;
+    
+    PointCoalescer(const CoalescingConfig& config, Evaluator evaluate)
+        : config_(config), evaluate_(std::move(evaluate)) {
+        if (config.recent_results > 0) {
+            // At least one slot per shard, so every slot belongs to one shard
+            size_t slots = SHARDS;
+            while (slots < static_cast<size_t>(config.recent_results)) {
+                slots <<= 1;
+            }
+            recent_.resize(slots);
+        }
+    }
+    
+    float query(DataType type, Location at) {
+        at.longitude = snap(at.longitude, config_.coordinate_precision);
+        at.latitude = snap(at.latitude, config_.coordinate_precision);
+        at.altitude = snap(at.altitude, config_.altitude_precision);
+        at.current_time = snap(at.current_time, config_.time_precision);
+        Key key = make_key(type, at);
+        
+        size_t hash = KeyHash()(key);
+        Shard& shard = shards_[hash & (SHARDS - 1)];
+        queries_.fetch_add(1, std::memory_order_relaxed);
+        std::unique_lock<std::mutex> lock(shard.mutex);
+        if (!recent_.empty()) {
+            const Recent& slot = recent_[hash & (recent_.size() - 1)];
+            if (slot.valid && slot.key == key) {
+                recent_hits_.fetch_add(1, std::memory_order_relaxed);
+                return slot.value;
+            }
+        }
+        for (Pending* running : shard.in_flight) {
+            if (running->key == key) {
+                coalesced_.fetch_add(1, std::memory_order_relaxed);
+                running->waiters++;
+                shard.finished.wait(lock, [&]() { return running->done; });
+                float value = running->value;
+                if (--running->waiters == 0) {
+                    shard.finished.notify_all();  // The evaluating caller may return now
+                }
+                return value;
+            }
+        }
+        
+        // Lives on this stack, so it must outlast every caller waiting on it
+        Pending pending{key};
+        shard.in_flight.push_back(&pending);
+        lock.unlock();
+        evaluated_.fetch_add(1, std::memory_order_relaxed);
+        float value = evaluate_(type, at);
+        
+        lock.lock();
+        pending.value = value;
+        pending.done = true;
+        *std::find(shard.in_flight.begin(), shard.in_flight.end(), &pending) = shard.in_flight.back();
+        shard.in_flight.pop_back();
+        remember(key, hash, value);
+        if (pending.waiters > 0) {
+            shard.finished.notify_all();
+            shard.finished.wait(lock, [&]() { return pending.waiters == 0; });
+        }
+        return value;
+    }
+    
+    CoalescingStats stats() const {
+        CoalescingStats stats;
+        stats.queries = queries_.load(std::memory_order_relaxed);
+        stats.coalesced = coalesced_.load(std::memory_order_relaxed);
+        stats.recent = recent_hits_.load(std::memory_order_relaxed);
+        stats.evaluated = evaluated_.load(std::memory_order_relaxed);
+        return stats;
+    }
+    
+private:
+    static constexpr size_t SHARDS = 16;
+    
+    struct Key {
+        uint32_t bits[6];
+        
+        bool operator==(const Key& other) const { return std::memcmp(bits, other.bits, sizeof(bits)) == 0; }
+    };
+    
+    struct KeyHash {
+        size_t operator()(const Key& key) const {
+            uint64_t hash = 0xcbf29ce484222325ull;
+            for (uint32_t word : key.bits) {
+                hash = (hash ^ word) * 0x100000001b3ull;
+            }
+            return static_cast<size_t>(hash ^ (hash >> 32));
+        }
+    };
+    
+    // One request being evaluated, with the number of callers waiting for it
+    struct Pending {
+        Key key;
+        float value = 0.0f;
+        bool done = false;
+        int waiters = 0;
+    };
+    
+    // Few requests are in flight per shard at once (at most one per
+    // thread), so a short list beats a hash table that allocates
+    struct alignas(64) Shard {
+        std::mutex mutex;
+        std::condition_variable finished;
+        std::vector<Pending*> in_flight;
+    };
     
-    /**
-     * Get the current configuration
-     */
-    const WorldConfig& get_config() const;
+    struct Recent {
+        Key key;
+        float value = 0.0f;
+        bool valid = false;
+    };
     
-private:
-    class Impl;
-    std::unique_ptr<Impl> pimpl_;
+    // Direct mapped: a new result replaces whatever shared its slot. The
+    // slot index and the shard come from the same low hash bits, so the
+    // caller's shard lock guards the slot
+    void remember(const Key& key, size_t hash, float value) {
+        if (!recent_.empty()) {
+            Recent& slot = recent_[hash & (recent_.size() - 1)];
+            slot.key = key;
+            slot.value = value;
+            slot.valid = true;
+        }
+    }
+    
+    static float snap(float value, float step) {
+        return step > 0.0f ? std::round(value / step) * step : value;
+    }
+    
+    static Key make_key(DataType type, const Location& at) {
+        Key key;
+        key.bits[0] = static_cast<uint32_t>(type);
+        float fields[5] = {at.longitude, at.latitude, at.altitude, at.current_time, at.detail_level};
+        for (int i = 0; i < 5; ++i) {
+            float value = fields[i] + 0.0f; // -0 and +0 share a key
+            std::memcpy(&key.bits[i + 1], &value, sizeof(value));
+        }
+        return key;
+    }
+    
+    CoalescingConfig config_;
+    Evaluator evaluate_;
+    Shard shards_[SHARDS];
+    std::vector<Recent> recent_;
+    std::atomic<uint64_t> queries_{0};
+    std::atomic<uint64_t> coalesced_{0};
+    std::atomic<uint64_t> recent_hits_{0};
+    std::atomic<uint64_t> evaluated_{0};
 };
 
 /**
- * Convert BiomeType to string name
+ * Sorted comparison constants of one rule input
+ *
+ * N edges split the line into 2N + 1 bands: below the first edge, each
+ * edge itself, and the open intervals between and above. Every <, <=, >
+ * and >= against an edge gives the same answer anywhere in a band, so a
+ * rule evaluated at one representative per band is exact for the band.
+ * Inputs are assumed finite.
  */
-const char* biome_to_string(BiomeType biome);
+struct RuleEdges {
+    std::vector<float> edge;
+    
+    RuleEdges() = default;
+    
+    explicit RuleEdges(std::vector<float> values) : edge(std::move(values)) {
+        for (float value : edge) {
+            if (!std::isfinite(value)) {
+                throw std::invalid_argument("classification rule edges must be finite");
+            }
+        }
+        std::sort(edge.begin(), edge.end());
+    }
+    
+    int bands() const {
+        return 2 * static_cast<int>(edge.size()) + 1;
+    }
+    
+    int band(float value) const {
+        int index = 0;
+        for (float e : edge) {
+            index += static_cast<int>(value > e) + static_cast<int>(value >= e);
+        }
+        return index;
+    }
+    
+    // Adds the band of each value times stride to index; edges outermost so
+    // the inner loop is branch free and vectorizes
+    void add_bands(const float* values, size_t count, int stride, int* index) const {
+        for (float e : edge) {
+            for (size_t i = 0; i < count; ++i) {
+                index[i] += (static_cast<int>(values[i] > e) + static_cast<int>(values[i] >= e)) * stride;
+            }
+        }
+    }
+    
+    float representative(int band) const {
+        if (edge.empty()) {
+            return 0.0f;
+        }
+        if (band == 0) {
+            return std::nextafter(edge.front(), -std::numeric_limits<float>::infinity());
+        }
+        if (band == bands() - 1) {
+            return std::nextafter(edge.back(), std::numeric_limits<float>::infinity());
+        }
+        if (band & 1) {
+            return edge[band / 2];
+        }
+        return 0.5f * (edge[band / 2 - 1] + edge[band / 2]);
+    }
+};
 
 /**
- * Convert SoilType to string name
+ * ClassificationRules with every empty rule replaced by the built-in one
  */
-const char* soil_to_string(SoilType soil);
-
-} // namespace rworld
-
+inline ClassificationRules complete_rules(const ClassificationRules* custom) {
+    ClassificationRules rules = ClassificationRules::from<StandardClassification>();
+    if (!custom) {
+        return rules;
+    }
+    if (custom->biome) {
+        rules.biome = custom->biome;
+        rules.biome_terrain_edges = custom->biome_terrain_edges;
+        rules.biome_temperature_edges = custom->biome_temperature_edges;
+        rules.biome_moisture_edges = custom->biome_moisture_edges;
+        rules.biome_altitude_edges = custom->biome_altitude_edges;
+    }
+    if (custom->soil) {
+        rules.soil = custom->soil;
+        rules.soil_altitude_edges = custom->soil_altitude_edges;
+        rules.soil_temperature_edges = custom->soil_temperature_edges;
+        rules.soil_precipitation_edges = custom->soil_precipitation_edges;
+    }
+    if (custom->vegetation_base) {
+        rules.vegetation_base = custom->vegetation_base;
+    }
+    if (custom->vegetation_temperature) {
+        rules.vegetation_temperature = custom->vegetation_temperature;
+        rules.vegetation_temperature_edges = custom->vegetation_temperature_edges;
+    }
+    if (custom->vegetation_altitude) {
+        rules.vegetation_altitude = custom->vegetation_altitude;
+        rules.vegetation_altitude_edges = custom->vegetation_altitude_edges;
+    }
+    return rules;
+}
 
-#ifdef _RWORLD_IMPLEMENTATION
-#include "FastNoiseLite.h"
-#include <cmath>
-#include <algorithm>
+/**
+ * Biome, soil and vegetation rules compiled into lookup tables
+ *
+ * Built per World from config.classification and config.sea_level, which
+ * is an edge of the terrain input. Biomes are indexed by (terrain,
+ * temperature, moisture, altitude) band. Soils are indexed by (altitude,
+ * temperature, precipitation) band and a biome class, where biomes the
+ * soil rule cannot tell apart share a class. Tables also record which
+ * bands decide the result on their own, so getters can skip computing the
+ * other inputs there. Lookups cost the same whatever the rules are.
+ */
+class ClassificationTables {
+public:
+    ClassificationTables(const ClassificationRules* custom, float sea_level) {
+        ClassificationRules rules = complete_rules(custom);
+        std::vector<float> terrain_edges = rules.biome_terrain_edges;
+        terrain_edges.push_back(sea_level);
+        terrain_ = RuleEdges(std::move(terrain_edges));
+        temperature_ = RuleEdges(rules.biome_temperature_edges);
+        moisture_ = RuleEdges(rules.biome_moisture_edges);
+        altitude_ = RuleEdges(rules.biome_altitude_edges);
+        soil_altitude_ = RuleEdges(rules.soil_altitude_edges);
+        soil_temperature_ = RuleEdges(rules.soil_temperature_edges);
+        soil_precipitation_ = RuleEdges(rules.soil_precipitation_edges);
+        vegetation_temperature_ = RuleEdges(rules.vegetation_temperature_edges);
+        vegetation_altitude_ = RuleEdges(rules.vegetation_altitude_edges);
+        
+        // Row-major strides, altitude fastest
+        altitude_stride_ = 1;
+        moisture_stride_ = altitude_.bands();
+        temperature_stride_ = moisture_stride_ * moisture_.bands();
+        terrain_stride_ = temperature_stride_ * temperature_.bands();
+        int climate_cells = terrain_stride_;
+        check_size(static_cast<size_t>(climate_cells) * terrain_.bands());
+        
+        biomes_.resize(static_cast<size_t>(climate_cells) * terrain_.bands());
+        biome_needs_climate_.resize(terrain_.bands());
+        for (int t = 0; t < terrain_.bands(); ++t) {
+            float height = terrain_.representative(t);
+            for (int temp = 0; temp < temperature_.bands(); ++temp) {
+                for (int moisture = 0; moisture < moisture_.bands(); ++moisture) {
+                    for (int altitude = 0; altitude < altitude_.bands(); ++altitude) {
+                        int cell = t * terrain_stride_ + temp * temperature_stride_ + moisture * moisture_stride_ +
+                                   altitude;
+                        biomes_[cell] = checked_biome(rules.biome(height, sea_level, temperature_.representative(temp),
+                                                                  moisture_.representative(moisture),
+                                                                  altitude_.representative(altitude)));
+                    }
+                }
+            }
+            auto row = biomes_.begin() + static_cast<size_t>(t) * climate_cells;
+            biome_needs_climate_[t] = std::any_of(row, row + climate_cells, [&](uint8_t b) { return b != *row; });
+        }
+        
+        // Biomes with identical soil outcomes everywhere share a class
+        soil_climate_cells_ = soil_temperature_.bands() * soil_precipitation_.bands();
+        int soil_cells = soil_altitude_.bands() * soil_climate_cells_;
+        check_size(static_cast<size_t>(soil_cells) * BIOME_COUNT);
+        std::vector<std::vector<uint8_t>> signatures;
+        for (int b = 0; b < BIOME_COUNT; ++b) {
+            std::vector<uint8_t> signature(soil_cells);
+            for (int c = 0; c < soil_cells; ++c) {
+                signature[c] = checked_soil(rules.soil(
+                    soil_altitude_.representative(c / soil_climate_cells_),
+                    soil_temperature_.representative(c / soil_precipitation_.bands() % soil_temperature_.bands()),
+                    soil_precipitation_.representative(c % soil_precipitation_.bands()), static_cast<BiomeType>(b)));
+            }
+            auto match = std::find(signatures.begin(), signatures.end(), signature);
+            soil_class_[b] = static_cast<uint8_t>(match - signatures.begin());
+            if (match == signatures.end()) {
+                signatures.push_back(std::move(signature));
+            }
+        }
+        soil_classes_ = static_cast<int>(signatures.size());
+        soils_.resize(static_cast<size_t>(soil_cells) * signatures.size());
+        soil_needs_climate_.resize(soil_altitude_.bands());
+        for (int a = 0; a < soil_altitude_.bands(); ++a) {
+            bool varies = false;
+            for (size_t k = 0; k < signatures.size(); ++k) {
+                for (int c = 0; c < soil_climate_cells_; ++c) {
+                    uint8_t soil = signatures[k][a * soil_climate_cells_ + c];
+                    soils_[(a * soil_climate_cells_ + c) * signatures.size() + k] = soil;
+                    varies = varies || soil != signatures[0][a * soil_climate_cells_];
+                }
+            }
+            soil_needs_climate_[a] = varies;
+        }
+        
+        for (int b = 0; b < BIOME_COUNT; ++b) {
+            vegetation_base_[b] = rules.vegetation_base(static_cast<BiomeType>(b));
+        }
+        for (int t = 0; t < vegetation_temperature_.bands(); ++t) {
+            vegetation_temperature_factor_.push_back(
+                rules.vegetation_temperature(vegetation_temperature_.representative(t)));
+        }
+        for (int a = 0; a < vegetation_altitude_.bands(); ++a) {
+            vegetation_altitude_factor_.push_back(rules.vegetation_altitude(vegetation_altitude_.representative(a)));
+        }
+    }
+    
+    // False where terrain height alone decides the biome (oceans, beaches)
+    bool biome_needs_climate(float terrain_height) const {
+        return biome_needs_climate_[terrain_.band(terrain_height)] != 0;
+    }
+    
+    BiomeType biome(float terrain_height, float temp, float moisture, float altitude) const {
+        int cell = terrain_.band(terrain_height) * terrain_stride_ + temperature_.band(temp) * temperature_stride_ +
+                   moisture_.band(moisture) * moisture_stride_ + altitude_.band(altitude);
+        return static_cast<BiomeType>(biomes_[cell]);
+    }
+    
+    // Branch-free biome of count points
+    void biomes(const float* terrain_height, const float* temp, const float* moisture, const float* altitude,
+                size_t count, BiomeType* out) const {
+        constexpr size_t chunk = 256;
+        int cells[chunk];
+        for (size_t begin = 0; begin < count; begin += chunk) {
+            size_t n = std::min(chunk, count - begin);
+            std::fill(cells, cells + n, 0);
+            terrain_.add_bands(terrain_height + begin, n, terrain_stride_, cells);
+            temperature_.add_bands(temp + begin, n, temperature_stride_, cells);
+            moisture_.add_bands(moisture + begin, n, moisture_stride_, cells);
+            altitude_.add_bands(altitude + begin, n, altitude_stride_, cells);
+            for (size_t i = 0; i < n; ++i) {
+                out[begin + i] = static_cast<BiomeType>(biomes_[cells[i]]);
+            }
+        }
+    }
+    
+    // False where altitude alone decides the soil (underwater, extreme peaks)
+    bool soil_needs_climate(float altitude) const {
+        return soil_needs_climate_[soil_altitude_.band(altitude)] != 0;
+    }
+    
+    SoilType soil(float altitude, float temp, float precip, BiomeType biome) const {
+        int cell = soil_altitude_.band(altitude) * soil_climate_cells_ +
+                   soil_temperature_.band(temp) * soil_precipitation_.bands() + soil_precipitation_.band(precip);
+        return static_cast<SoilType>(soils_[cell * soil_classes_ + soil_class_[static_cast<int>(biome)]]);
+    }
+    
+    float vegetation_base(BiomeType biome) const {
+        return vegetation_base_[static_cast<int>(biome)];
+    }
+    
+    float vegetation_temperature_factor(float temp) const {
+        return vegetation_temperature_factor_[vegetation_temperature_.band(temp)];
+    }
+    
+    float vegetation_altitude_factor(float altitude) const {
+        return vegetation_altitude_factor_[vegetation_altitude_.band(altitude)];
+    }
+    
+private:
+    static constexpr int BIOME_COUNT = static_cast<int>(BiomeType::MOUNTAIN_PEAK) + 1;
+    static constexpr size_t MAX_CELLS = size_t(1) << 24;
+    
+    static void check_size(size_t cells) {
+        if (cells > MAX_CELLS) {
+            throw std::invalid_argument("classification rules have too many edges");
+        }
+    }
+    
+    static uint8_t checked_biome(BiomeType biome) {
+        if (static_cast<unsigned>(biome) >= static_cast<unsigned>(BIOME_COUNT)) {
+            throw std::invalid_argument("classification rule returned an unknown biome");
+        }
+        return static_cast<uint8_t>(biome);
+    }
+    
+    static uint8_t checked_soil(SoilType soil) {
+        if (static_cast<unsigned>(soil) > static_cast<unsigned>(SoilType::NONE)) {
+            throw std::invalid_argument("classification rule returned an unknown soil type");
+        }
+        return static_cast<uint8_t>(soil);
+    }
+    
+    RuleEdges terrain_;
+    RuleEdges temperature_;
+    RuleEdges moisture_;
+    RuleEdges altitude_;
+    RuleEdges soil_altitude_;
+    RuleEdges soil_temperature_;
+    RuleEdges soil_precipitation_;
+    RuleEdges vegetation_temperature_;
+    RuleEdges vegetation_altitude_;
+    int terrain_stride_ = 0;
+    int temperature_stride_ = 0;
+    int moisture_stride_ = 0;
+    int altitude_stride_ = 0;
+    int soil_climate_cells_ = 0;
+    
+    std::vector<uint8_t> biomes_;
+    std::vector<uint8_t> biome_needs_climate_;
+    uint8_t soil_class_[BIOME_COUNT];
+    int soil_classes_ = 0;
+    std::vector<uint8_t> soils_;
+    std::vector<uint8_t> soil_needs_climate_;
+    float vegetation_base_[BIOME_COUNT];
+    std::vector<float> vegetation_temperature_factor_;
+    std::vector<float> vegetation_altitude_factor_;
+};
 
-namespace rworld {
+} // namespace detail
 
 // PIMPL implementation to hide FastNoiseLite from the header
 class World::Impl {
@@ -667,32 +2421,105 @@ public:
     FastNoiseLite cloud_noise;
     FastNoiseLite weather_noise; // For temporal weather variations
     FastNoiseLite pressure_noise; // For pressure systems and storm fronts
+    const detail::NoiseKernels* kernels; // ISA variant picked once at construction
+    detail::SolarDay solar;               // Declination terms of config.day_of_year
+    detail::ClassificationTables classification; // config.classification at config.sea_level
     
-    explicit Impl(const WorldConfig& cfg) : config(cfg) {
+    // Settings shared by the OpenSimplex2 generators and the fused evaluator
+    detail::NoiseLayer terrain_layer;
+    detail::NoiseLayer moisture_layer;
+    detail::NoiseLayer temperature_variation_layer;
+    detail::NoiseLayer coal_layer;
+    detail::NoiseLayer cloud_layer;
+    
+    std::unique_ptr<detail::PointCoalescer> coalescer; // Set when config.coalescing is enabled
+    
+    explicit Impl(const WorldConfig& cfg)
+        : config(cfg), kernels(&detail::select_noise_kernels()), solar(detail::solar_day(cfg.day_of_year)),
+          classification(cfg.classification.get(), cfg.sea_level) {
         initialize_noise_generators();
+        initialize_coalescer();
+    }
+    
+    void initialize_coalescer() {
+        coalescer.reset();
+        if (config.coalescing.enabled) {
+            coalescer = std::make_unique<detail::PointCoalescer>(
+                config.coalescing, [this](DataType type, const Location& at) { return evaluate_point(type, at); });
+        }
+    }
+    
+    // Body of World::batch_query, in the order given
+    BatchResult evaluate_batch(const std::vector<Location>& locations, const std::vector<DataType>& data_types) const;
+    
+    // One point query by type, with the arguments of the matching World
+    // getter (enum and boolean results as their numeric value)
+    float evaluate_point(DataType type, const Location& at) const {
+        float lon = at.longitude;
+        float lat = at.latitude;
+        float alt = at.altitude;
+        float time = at.current_time;
+        switch (type) {
+            case DataType::TERRAIN_HEIGHT: return get_terrain_height(lon, lat, at.detail_level);
+            case DataType::TEMPERATURE: return get_temperature(lon, lat, alt);
+            case DataType::TEMPERATURE_AT_TIME: return get_temperature_at_time(lon, lat, alt, time);
+            case DataType::BIOME: return static_cast<float>(classify_biome(lon, lat, alt));
+            case DataType::PRECIPITATION: return get_precipitation(lon, lat, alt);
+            case DataType::CURRENT_PRECIPITATION: return get_current_precipitation(lon, lat, alt, time);
+            case DataType::HUMIDITY: return get_humidity(lon, lat, alt);
+            case DataType::WIND_SPEED: return get_wind_speed(lon, lat, alt);
+            case DataType::CURRENT_WIND_SPEED: return get_current_wind_speed(lon, lat, alt, time);
+            case DataType::WIND_DIRECTION: return get_wind_direction(lon, lat, alt);
+            case DataType::CURRENT_WIND_DIRECTION: return get_current_wind_direction(lon, lat, alt, time);
+            case DataType::IS_RIVER: return is_river(lon, lat) ? 1.0f : 0.0f;
+            case DataType::RIVER_WIDTH: return get_river_width(lon, lat);
+            case DataType::FLOW_ACCUMULATION: return get_flow_accumulation(lon, lat);
+            case DataType::IS_VOLCANO: return is_volcano(lon, lat) ? 1.0f : 0.0f;
+            case DataType::COAL_DEPOSIT: return get_coal_deposit(lon, lat);
+            case DataType::IRON_DEPOSIT: return get_iron_deposit(lon, lat);
+            case DataType::OIL_DEPOSIT: return get_oil_deposit(lon, lat);
+            case DataType::INSOLATION: return get_insolation(lon, lat, time);
+            case DataType::IS_DAYLIGHT: return is_daylight(lon, lat, time) ? 1.0f : 0.0f;
+            case DataType::SOLAR_ANGLE: return get_solar_angle(lon, lat, time);
+            case DataType::VEGETATION_DENSITY: return get_vegetation_density(lon, lat, alt);
+            case DataType::SOIL_TYPE: return static_cast<float>(get_soil_type(lon, lat, alt));
+            case DataType::SOIL_FERTILITY: return get_soil_fertility(lon, lat, alt);
+            case DataType::SOIL_PH: return get_soil_ph(lon, lat, alt);
+            case DataType::ORGANIC_MATTER: return get_organic_matter(lon, lat, alt);
+            case DataType::PRESSURE_AT_LOCATION: return get_pressure_at_location(lon, lat, alt, time);
+            case DataType::PRESSURE_GRADIENT: return get_pressure_gradient(lon, lat, time);
+            case DataType::IS_STORM_FRONT: return is_storm_front(lon, lat, time) ? 1.0f : 0.0f;
+            case DataType::PRECIPITATION_TYPE:
+            case DataType::AIR_PRESSURE:
+                break; // Cheap or derived; never coalesced
+        }
+        return 0.0f;
     }
     
     void initialize_noise_generators() {
         // Terrain noise - creates continents, mountains, valleys
-        terrain_noise.SetNoiseType(FastNoiseLite::NoiseType_OpenSimplex2);
-        terrain_noise.SetFractalType(FastNoiseLite::FractalType_FBm);
-        terrain_noise.SetFractalOctaves(config.terrain_octaves);
-        terrain_noise.SetFractalLacunarity(config.terrain_lacunarity);
-        terrain_noise.SetFractalGain(config.terrain_gain);
-        terrain_noise.SetFrequency(config.terrain_frequency * config.world_scale);
-        terrain_noise.SetSeed(static_cast<int>(config.seed));
+        terrain_layer = detail::NoiseLayer();
+        terrain_layer.fractal_type = FastNoiseLite::FractalType_FBm;
+        terrain_layer.octaves = config.terrain_octaves;
+        terrain_layer.lacunarity = config.terrain_lacunarity;
+        terrain_layer.gain = config.terrain_gain;
+        terrain_layer.frequency = config.terrain_frequency * config.world_scale;
+        terrain_layer.seed = static_cast<int>(config.seed);
+        terrain_layer.apply(terrain_noise);
         
         // Moisture noise - affects precipitation and biomes
-        moisture_noise.SetNoiseType(FastNoiseLite::NoiseType_OpenSimplex2);
-        moisture_noise.SetFractalType(FastNoiseLite::FractalType_FBm);
-        moisture_noise.SetFractalOctaves(config.moisture_octaves);
-        moisture_noise.SetFrequency(config.moisture_frequency * config.world_scale);
-        moisture_noise.SetSeed(static_cast<int>(config.seed + 1000));
+        moisture_layer = detail::NoiseLayer();
+        moisture_layer.fractal_type = FastNoiseLite::FractalType_FBm;
+        moisture_layer.octaves = config.moisture_octaves;
+        moisture_layer.frequency = config.moisture_frequency * config.world_scale;
+        moisture_layer.seed = static_cast<int>(config.seed + 1000);
+        moisture_layer.apply(moisture_noise);
         
         // Temperature variation noise - adds local variations to base temperature
-        temperature_variation_noise.SetNoiseType(FastNoiseLite::NoiseType_OpenSimplex2);
-        temperature_variation_noise.SetFrequency(0.003f * config.world_scale);
-        temperature_variation_noise.SetSeed(static_cast<int>(config.seed + 2000));
+        temperature_variation_layer = detail::NoiseLayer();
+        temperature_variation_layer.frequency = 0.003f * config.world_scale;
+        temperature_variation_layer.seed = static_cast<int>(config.seed + 2000);
+        temperature_variation_layer.apply(temperature_variation_noise);
         
         // Wind noise - creates wind patterns
         wind_noise.SetNoiseType(FastNoiseLite::NoiseType_OpenSimplex2);
@@ -716,11 +2543,12 @@ public:
         volcano_noise.SetSeed(static_cast<int>(config.seed + 5000));
         
         // Coal noise - for coal deposits (sedimentary, lowland swamps)
-        coal_noise.SetNoiseType(FastNoiseLite::NoiseType_OpenSimplex2);
-        coal_noise.SetFractalType(FastNoiseLite::FractalType_FBm);
-        coal_noise.SetFractalOctaves(4);
-        coal_noise.SetFrequency(0.003f * config.world_scale);
-        coal_noise.SetSeed(static_cast<int>(config.seed + 6000));
+        coal_layer = detail::NoiseLayer();
+        coal_layer.fractal_type = FastNoiseLite::FractalType_FBm;
+        coal_layer.octaves = 4;
+        coal_layer.frequency = 0.003f * config.world_scale;
+        coal_layer.seed = static_cast<int>(config.seed + 6000);
+        coal_layer.apply(coal_noise);
         
         // Iron noise - for iron ore deposits (volcanic/ancient seabeds)
         iron_noise.SetNoiseType(FastNoiseLite::NoiseType_OpenSimplex2);
@@ -737,11 +2565,12 @@ public:
         oil_noise.SetSeed(static_cast<int>(config.seed + 4000));
         
         // Cloud noise - for atmospheric modeling
-        cloud_noise.SetNoiseType(FastNoiseLite::NoiseType_OpenSimplex2);
-        cloud_noise.SetFractalType(FastNoiseLite::FractalType_FBm);
-        cloud_noise.SetFractalOctaves(3);
-        cloud_noise.SetFrequency(0.005f * config.world_scale);
-        cloud_noise.SetSeed(static_cast<int>(config.seed + 5000));
+        cloud_layer = detail::NoiseLayer();
+        cloud_layer.fractal_type = FastNoiseLite::FractalType_FBm;
+        cloud_layer.octaves = 3;
+        cloud_layer.frequency = 0.005f * config.world_scale;
+        cloud_layer.seed = static_cast<int>(config.seed + 5000);
+        cloud_layer.apply(cloud_noise);
         
         // Weather variation noise - for temporal changes in weather patterns
         weather_noise.SetNoiseType(FastNoiseLite::NoiseType_OpenSimplex2);
@@ -760,15 +2589,18 @@ public:
     
     // Convert geographic coordinates to world space for noise sampling
     void geo_to_world(float longitude, float latitude, float& x, float& y, float& z) const {
-        // Convert to radians
-        float lon_rad = longitude * 3.14159265359f / 180.0f;
-        float lat_rad = latitude * 3.14159265359f / 180.0f;
-        
-        // Project onto sphere surface for seamless wrapping
-        float r = 1000.0f; // Arbitrary sphere radius
-        x = r * std::cos(lat_rad) * std::cos(lon_rad);
-        y = r * std::cos(lat_rad) * std::sin(lon_rad);
-        z = r * std::sin(lat_rad);
+        kernels->geo_to_world(longitude, latitude, x, y, z);
+    }
+    
+    // Sample a 3D noise generator through the dispatched kernel
+    float sample_noise(const FastNoiseLite& noise, float x, float y, float z) const {
+        return kernels->noise3(noise, x, y, z);
+    }
+    
+    // Sample several OpenSimplex2 layers at one point in a single fused pass
+    void sample_fused(const detail::NoiseLayer* layers, int layer_count, float x, float y, float z,
+                      float* out) const {
+        kernels->fused3(layers, layer_count, x, y, z, out);
     }
     
     float get_terrain_height(float longitude, float latitude, float detail_level = 1.0f) const {
@@ -776,7 +2608,7 @@ public:
         geo_to_world(longitude, latitude, x, y, z);
         
         // Get base terrain noise (-1 to 1)
-        float noise_value = terrain_noise.GetNoise(x, y, z);
+        float noise_value = sample_noise(terrain_noise, x, y, z);
         
         // Add finer detail layers when detail_level > 1.0
         if (detail_level > 1.0f) {
@@ -789,8 +2621,8 @@ public:
             int detail_octaves = std::min(3, static_cast<int>(std::log2(detail_level)));
             
             for (int i = 0; i < detail_octaves; ++i) {
-                float freq = detail_frequency * std::pow(2.0f, i);
-                detail_contribution += terrain_noise.GetNoise(x * freq, y * freq, z * freq) * detail_amplitude;
+                float freq = detail_frequency * static_cast<float>(1 << i);
+                detail_contribution += sample_noise(terrain_noise, x * freq, y * freq, z * freq) * detail_amplitude;
                 detail_amplitude *= 0.5f; // Each octave contributes less
             }
             
@@ -799,6 +2631,11 @@ public:
             noise_value = noise_value * (1.0f - detail_blend * 0.3f) + detail_contribution * detail_blend;
         }
         
+        return shape_terrain(noise_value, x, y, z);
+    }
+    
+    // Turn raw terrain noise at world point (x, y, z) into a height in meters
+    float shape_terrain(float noise_value, float x, float y, float z) const {
         // Apply power curve to create more ocean and distinct continents
         // Values below 0 are ocean, above 0 are land
         float shaped = noise_value;
@@ -823,7 +2660,7 @@ public:
         // Add volcanoes - only on land (independent of detail_level so always visible)
         if (base_height > 0.0f) {
             // Use cellular noise to find volcano centers
-            float volcano_cell = volcano_noise.GetNoise(x, y, z);
+            float volcano_cell = sample_noise(volcano_noise, x, y, z);
             volcano_cell = (volcano_cell + 1.0f) * 0.5f; // Convert to 0-1
             
             // Only place volcanoes where cellular noise is very low (cell centers)
@@ -866,7 +2703,7 @@ public:
         geo_to_world(longitude, latitude, x, y, z);
         
         // Check volcano noise
-        float volcano_cell = volcano_noise.GetNoise(x, y, z);
+        float volcano_cell = sample_noise(volcano_noise, x, y, z);
         volcano_cell = (volcano_cell + 1.0f) * 0.5f;
         
         // Location is a volcano if within the cone radius
@@ -874,18 +2711,24 @@ public:
     }
     
     float get_coal_deposit(float longitude, float latitude) const {
-        float terrain_height = get_terrain_height(longitude, latitude);
+        float x, y, z;
+        geo_to_world(longitude, latitude, x, y, z);
+        
+        // Terrain, coal and the precipitation inputs all come from one fused pass
+        const detail::NoiseLayer layers[] = {terrain_layer, coal_layer, moisture_layer,
+                                             temperature_variation_layer};
+        float noise[4];
+        sample_fused(layers, 4, x, y, z, noise);
+        
+        float terrain_height = shape_terrain(noise[0], x, y, z);
         
         // No coal in ocean or very high mountains
         if (terrain_height <= config.sea_level || terrain_height > 2000.0f) {
             return 0.0f;
         }
         
-        float x, y, z;
-        geo_to_world(longitude, latitude, x, y, z);
-        
         // Coal forms in ancient swamps - prefer wet, vegetated lowlands
-        float coal_noise_value = coal_noise.GetNoise(x, y, z);
+        float coal_noise_value = noise[1];
         coal_noise_value = (coal_noise_value + 1.0f) * 0.5f; // 0-1
         
         // Coal more likely in areas with:
@@ -904,7 +2747,9 @@ public:
         
         // - High historical precipitation (ancient forests/swamps)
         float altitude = std::max(terrain_height, 0.0f);
-        float precip = get_precipitation(longitude, latitude, altitude);
+        float moisture = moisture_from_noise(noise[2], latitude);
+        float temp = temperature_from_noise(noise[3], latitude, altitude);
+        float precip = precipitation_from(moisture, temp, terrain_height, altitude);
         float moisture_factor = std::clamp(precip / 1500.0f, 0.2f, 1.0f); // Minimum 0.2
         
         // - Temperate to subtropical latitudes (20-60°) are best
@@ -937,7 +2782,7 @@ public:
         geo_to_world(longitude, latitude, x, y, z);
         
         // Iron forms in banded iron formations and volcanic regions
-        float iron_noise_value = iron_noise.GetNoise(x, y, z);
+        float iron_noise_value = sample_noise(iron_noise, x, y, z);
         iron_noise_value = (iron_noise_value + 1.0f) * 0.5f; // 0-1
         
         // Iron more likely in:
@@ -971,7 +2816,7 @@ public:
         geo_to_world(longitude, latitude, x, y, z);
         
         // Oil deposits using cellular pattern (basin-like structures)
-        float oil_noise_value = oil_noise.GetNoise(x, y, z);
+        float oil_noise_value = sample_noise(oil_noise, x, y, z);
         oil_noise_value = (oil_noise_value + 1.0f) * 0.5f; // 0-1
         
         // Oil more likely in:
@@ -1001,37 +2846,9 @@ public:
     }
     
     float get_solar_angle(float longitude, float latitude, float current_time) const {
-        // Calculate hour angle: how far the sun has moved from solar noon
-        // Solar noon is at 12:00 at longitude 0°
-        // Earth rotates 360° in 24 hours = 15° per hour
-        float local_solar_time = current_time + (longitude / 15.0f);
-        
-        // Wrap to 0-24 range
-        while (local_solar_time < 0.0f) local_solar_time += 24.0f;
-        while (local_solar_time >= 24.0f) local_solar_time -= 24.0f;
-        
-        // Hour angle: 0° at solar noon (12:00), ±15° per hour
-        float hour_angle = (local_solar_time - 12.0f) * 15.0f; // degrees
-        
-        // Solar declination (axial tilt effect based on day of year)
-        // Earth's axial tilt is 23.44°
-        // Day 0 = January 1, Day 172 = Summer solstice (June 21), Day 355 = Winter solstice (Dec 21)
-        // Using simplified formula: declination peaks at solstices
-        float day_angle = (config.day_of_year - 172) * 2.0f * M_PI / 365.0f;
-        float solar_declination = 23.44f * std::cos(day_angle); // degrees
-        
-        // Convert to radians for trig
-        float lat_rad = latitude * M_PI / 180.0f;
-        float dec_rad = solar_declination * M_PI / 180.0f;
-        float ha_rad = hour_angle * M_PI / 180.0f;
-        
-        // Solar elevation angle formula
-        float sin_elevation = std::sin(lat_rad) * std::sin(dec_rad) +
-                             std::cos(lat_rad) * std::cos(dec_rad) * std::cos(ha_rad);
-        
-        float elevation_angle = std::asin(std::clamp(sin_elevation, -1.0f, 1.0f)) * 180.0f / M_PI;
-        
-        return elevation_angle; // degrees above horizon (negative = below)
+        // Declination terms are computed once per configured day of year
+        return detail::solar_elevation(detail::solar_latitude(solar, latitude),
+                                       detail::solar_hour_cosine(longitude, current_time));
     }
     
     bool is_daylight(float longitude, float latitude, float current_time) const {
@@ -1039,55 +2856,42 @@ public:
     }
     
     float get_insolation(float longitude, float latitude, float current_time) const {
-        // Get solar angle
-        float solar_angle = get_solar_angle(longitude, latitude, current_time);
-        
         // No insolation if sun is below horizon
+        float solar_angle = get_solar_angle(longitude, latitude, current_time);
         if (solar_angle <= 0.0f) {
             return 0.0f;
         }
         
-        // Solar constant at top of atmosphere
-        const float SOLAR_CONSTANT = 1361.0f; // W/m²
-        
-        // Insolation based on solar angle (cosine law)
-        float solar_angle_rad = solar_angle * M_PI / 180.0f;
-        float base_insolation = SOLAR_CONSTANT * std::sin(solar_angle_rad);
-        
-        // Atmospheric attenuation (simplified - depends on air mass)
-        // Air mass increases as sun gets lower in sky
-        float air_mass = 1.0f / std::sin(solar_angle_rad);
-        air_mass = std::clamp(air_mass, 1.0f, 10.0f);
-        
-        // Atmospheric transmission (simple exponential model)
-        float atmospheric_transmission = std::pow(0.7f, air_mass);
-        base_insolation *= atmospheric_transmission;
-        
         // Cloud cover reduces insolation
+        return detail::surface_insolation(solar_angle, detail::cloud_transmission(get_cloud_cover(longitude, latitude)));
+    }
+    
+    // Surface cloud cover; independent of time, so solar tables can sample it once
+    float get_cloud_cover(float longitude, float latitude) const {
         float terrain_height = get_terrain_height(longitude, latitude);
         float altitude = std::max(terrain_height, 0.0f);
-        float cloud_density = get_cloud_density(longitude, latitude, altitude);
-        
-        // Clouds block 50-90% of radiation depending on density
-        float cloud_factor = 1.0f - (cloud_density * 0.7f);
-        
-        float final_insolation = base_insolation * cloud_factor;
-        
-        return std::clamp(final_insolation, 0.0f, 1400.0f);
+        return get_cloud_density(longitude, latitude, altitude);
     }
     
     float get_cloud_density(float longitude, float latitude, float altitude) const {
         float x, y, z;
         geo_to_world(longitude, latitude, x, y, z);
         
+        // Cloud pattern and every environmental input share one fused pass
+        const detail::NoiseLayer layers[] = {cloud_layer, moisture_layer, temperature_variation_layer,
+                                             terrain_layer};
+        float fused[4];
+        sample_fused(layers, 4, x, y, z, fused);
+        
         // Get base noise pattern for cloud variation
-        float noise = cloud_noise.GetNoise(x, y, z);
-        noise = (noise + 1.0f) * 0.5f; // 0-1
+        float noise = (fused[0] + 1.0f) * 0.5f; // 0-1
         
         // Get environmental factors
-        float humidity = get_humidity(longitude, latitude, altitude);
-        float precip = get_precipitation(longitude, latitude, altitude);
-        float temp = get_temperature(longitude, latitude, altitude);
+        float moisture = moisture_from_noise(fused[1], latitude);
+        float temp = temperature_from_noise(fused[2], latitude, altitude);
+        float terrain_height = shape_terrain(fused[3], x, y, z);
+        float humidity = humidity_from(moisture, temp, altitude);
+        float precip = precipitation_from(moisture, temp, terrain_height, altitude);
         
         // Cloud density is heavily influenced by humidity
         float cloud_base = humidity * 0.8f + 0.2f * noise;
@@ -1115,88 +2919,18 @@ public:
         float precip = get_precipitation(longitude, latitude, altitude);
         BiomeType biome = classify_biome(longitude, latitude, altitude);
         
-        // Base density on biome type
-        float base_density = 0.0f;
-        switch (biome) {
-            // Dense vegetation
-            case BiomeType::TROPICAL_RAINFOREST:
-                base_density = 1.0f;
-                break;
-            case BiomeType::TEMPERATE_RAINFOREST:
-                base_density = 0.95f;
-                break;
-            case BiomeType::TROPICAL_SEASONAL_FOREST:
-                base_density = 0.85f;
-                break;
-            case BiomeType::TEMPERATE_DECIDUOUS_FOREST:
-                base_density = 0.80f;
-                break;
-            case BiomeType::TAIGA:
-                base_density = 0.70f;
-                break;
-            case BiomeType::MOUNTAIN_FOREST:
-                base_density = 0.65f;
-                break;
-                
-            // Moderate vegetation
-            case BiomeType::SAVANNA:
-                base_density = 0.40f;
-                break;
-            case BiomeType::GRASSLAND:
-                base_density = 0.30f;
-                break;
-                
-            // Sparse vegetation
-            case BiomeType::TUNDRA:
-            case BiomeType::MOUNTAIN_TUNDRA:
-                base_density = 0.15f;
-                break;
-                
-            // Very sparse/no vegetation
-            case BiomeType::DESERT:
-            case BiomeType::COLD_DESERT:
-                base_density = 0.05f;
-                break;
-            case BiomeType::ICE:
-            case BiomeType::SNOW:
-            case BiomeType::MOUNTAIN_PEAK:
-                base_density = 0.0f;
-                break;
-            case BiomeType::OCEAN:
-            case BiomeType::DEEP_OCEAN:
-                base_density = 0.0f; // Could represent phytoplankton if needed
-                break;
-            case BiomeType::BEACH:
-                base_density = 0.10f;
-                break;
-        }
-        
-        // Modulate by precipitation (more water = more plants)
+        // Base density on biome type, modulated by precipitation (more water
+        // = more plants), temperature and elevation
+        float base_density = classification.vegetation_base(biome);
         float precip_factor = std::clamp(precip / 1500.0f, 0.3f, 1.2f);
         base_density *= precip_factor;
-        
-        // Temperature affects growth
-        float temp_factor = 1.0f;
-        if (temp < -10.0f) {
-            temp_factor = 0.3f; // Very cold limits growth
-        } else if (temp < 0.0f) {
-            temp_factor = 0.6f; // Cold reduces growth
-        } else if (temp > 35.0f) {
-            temp_factor = 0.7f; // Very hot without enough water limits growth
-        }
-        base_density *= temp_factor;
-        
-        // Elevation affects vegetation (higher = less vegetation)
-        if (altitude > 3000.0f) {
-            base_density *= 0.3f;
-        } else if (altitude > 2000.0f) {
-            base_density *= 0.6f;
-        }
+        base_density *= classification.vegetation_temperature_factor(temp);
+        base_density *= classification.vegetation_altitude_factor(altitude);
         
         // Add some noise variation for natural appearance
         float x, y, z;
         geo_to_world(longitude, latitude, x, y, z);
-        float noise = moisture_noise.GetNoise(x * 2.0f, y * 2.0f, z * 2.0f);
+        float noise = sample_noise(moisture_noise, x * 2.0f, y * 2.0f, z * 2.0f);
         noise = (noise + 1.0f) * 0.5f; // 0-1
         
         // Noise adds ±15% variation
@@ -1206,59 +2940,15 @@ public:
     }
     
     SoilType get_soil_type(float longitude, float latitude, float altitude) const {
-        // No soil underwater, on ice, or extreme mountains
-        if (altitude < 0.0f) {
-            return SoilType::NONE;
-        }
-        if (altitude > 5000.0f) {
-            return SoilType::ROCKY;
+        // No soil underwater or on extreme mountains, whatever the climate
+        if (!classification.soil_needs_climate(altitude)) {
+            return classification.soil(altitude, 0.0f, 0.0f, BiomeType::OCEAN);
         }
         
         float temp = get_temperature(longitude, latitude, altitude);
         float precip = get_precipitation(longitude, latitude, altitude);
         BiomeType biome = classify_biome(longitude, latitude, altitude);
-        
-        // Ice/Snow - permafrost
-        if (biome == BiomeType::ICE || biome == BiomeType::SNOW || 
-            biome == BiomeType::MOUNTAIN_PEAK || temp < -5.0f) {
-            return SoilType::PERMAFROST;
-        }
-        
-        // Wetlands and rainforests - peat
-        if (precip > 2000.0f && altitude < 100.0f) {
-            return SoilType::PEAT;
-        }
-        
-        // Mountains and high altitude - rocky
-        if (altitude > 3000.0f || biome == BiomeType::MOUNTAIN_TUNDRA || 
-            biome == BiomeType::MOUNTAIN_PEAK) {
-            return SoilType::ROCKY;
-        }
-        
-        // Deserts - sandy
-        if (biome == BiomeType::DESERT || biome == BiomeType::COLD_DESERT) {
-            return SoilType::SAND;
-        }
-        
-        // Grasslands and temperate zones - loam (best soil)
-        if (biome == BiomeType::GRASSLAND || biome == BiomeType::SAVANNA) {
-            if (precip > 500.0f && precip < 1500.0f) {
-                return SoilType::LOAM;
-            }
-        }
-        
-        // High precipitation temperate - clay
-        if (precip > 1200.0f && temp > 5.0f && temp < 25.0f) {
-            return SoilType::CLAY;
-        }
-        
-        // Moderate precipitation - silt
-        if (precip > 600.0f && precip < 1200.0f) {
-            return SoilType::SILT;
-        }
-        
-        // Default to sand for dry areas
-        return SoilType::SAND;
+        return classification.soil(altitude, temp, precip, biome);
     }
     
     float get_soil_fertility(float longitude, float latitude, float altitude) const {
@@ -1456,7 +3146,7 @@ public:
         
         // Move pressure systems with time
         float time_scaled = current_time * 0.1f;
-        float pressure_variation = pressure_noise.GetNoise(x, y, z + time_scaled * 200.0f);
+        float pressure_variation = sample_noise(pressure_noise, x, y, z + time_scaled * 200.0f);
         
         // Pressure systems create ±25 mb variations
         // High pressure (1015-1040 mb) = clear weather
@@ -1500,9 +3190,12 @@ public:
         float x, y, z;
         geo_to_world(longitude, latitude, x, y, z);
         
+        return moisture_from_noise(sample_noise(moisture_noise, x, y, z), latitude);
+    }
+    
+    float moisture_from_noise(float noise, float latitude) const {
         // Get moisture noise (0 to 1)
-        float moisture = moisture_noise.GetNoise(x, y, z);
-        moisture = (moisture + 1.0f) * 0.5f; // Convert from -1,1 to 0,1
+        float moisture = (noise + 1.0f) * 0.5f; // Convert from -1,1 to 0,1
         
         // Increase moisture near equator, decrease near poles
         float lat_factor = 1.0f - std::abs(latitude) / 90.0f;
@@ -1524,64 +3217,78 @@ public:
     }
     
     float get_temperature(float longitude, float latitude, float altitude) const {
-        float base_temp = get_base_temperature(latitude, altitude);
-        
         // Add local variation
         float x, y, z;
         geo_to_world(longitude, latitude, x, y, z);
-        float variation = temperature_variation_noise.GetNoise(x, y, z) * 5.0f; // ±5°C variation
+        return temperature_from_noise(sample_noise(temperature_variation_noise, x, y, z), latitude, altitude);
+    }
+    
+    float temperature_from_noise(float noise, float latitude, float altitude) const {
+        float base_temp = get_base_temperature(latitude, altitude);
+        float variation = noise * 5.0f; // ±5°C variation
         
         return base_temp + variation;
     }
     
-    float get_temperature_at_time(float longitude, float latitude, float altitude, float current_time) const {
-        // Start with base temperature
-        float base_temp = get_temperature(longitude, latitude, altitude);
-        
-        // Get insolation for solar heating effect
-        float insolation = get_insolation(longitude, latitude, current_time);
+    // Terms of get_temperature_at_time that do not change with time
+    struct DiurnalTerms {
+        float base_temp = 0.0f;
+        float cloud_density = 0.0f;
+        float variation_damping = 1.0f;
+    };
+    
+    DiurnalTerms diurnal_terms(float longitude, float latitude, float altitude) const {
+        DiurnalTerms terms;
+        terms.base_temp = get_temperature(longitude, latitude, altitude);
+        terms.cloud_density = get_cloud_density(longitude, latitude, altitude);
         
+        // Daily temperature variation also depends on terrain and moisture
+        // Deserts have high variation, humid areas have lower variation
+        float humidity = get_humidity(longitude, latitude, altitude);
+        terms.variation_damping = 0.5f + humidity * 0.5f; // Humidity reduces temperature swings
+        return terms;
+    }
+    
+    float get_temperature_at_time(float longitude, float latitude, float altitude, float current_time) const {
+        return temperature_at_time(diurnal_terms(longitude, latitude, altitude),
+                                   get_insolation(longitude, latitude, current_time),
+                                   is_daylight(longitude, latitude, current_time));
+    }
+    
+    float temperature_at_time(const DiurnalTerms& terms, float insolation, bool is_day) const {
         // Insolation effect: more sun = warmer (up to +15°C during peak day)
         // At 1000 W/m², add about +10°C; scales with insolation
         float solar_heating = (insolation / 1000.0f) * 10.0f;
         
         // Night cooling: when sun is down, temperature drops
-        bool is_day = is_daylight(longitude, latitude, current_time);
         float night_cooling = 0.0f;
         if (!is_day) {
             // Night time - temperature drops by 5-15°C depending on cloud cover
-            float cloud_density = get_cloud_density(longitude, latitude, altitude);
             // More clouds = less cooling (greenhouse effect)
-            night_cooling = -5.0f - (10.0f * (1.0f - cloud_density));
+            night_cooling = -5.0f - (10.0f * (1.0f - terms.cloud_density));
         }
         
         // Cloud cooling during day: clouds block sun and reduce temperature
-        float cloud_density = get_cloud_density(longitude, latitude, altitude);
         float cloud_effect = 0.0f;
         if (is_day) {
             // Dense clouds can reduce temperature by up to 5°C during day
-            cloud_effect = -cloud_density * 5.0f;
+            cloud_effect = -terms.cloud_density * 5.0f;
         }
         
-        // Combine all effects
-        float dynamic_temp = base_temp + solar_heating + night_cooling + cloud_effect;
-        
-        // Daily temperature variation also depends on terrain and moisture
-        // Deserts have high variation, humid areas have lower variation
-        float humidity = get_humidity(longitude, latitude, altitude);
-        float variation_damping = 0.5f + humidity * 0.5f; // Humidity reduces temperature swings
-        
         // Apply damping to the dynamic components
         float dynamic_component = solar_heating + night_cooling + cloud_effect;
-        dynamic_temp = base_temp + (dynamic_component * variation_damping);
-        
-        return dynamic_temp;
+        return terms.base_temp + (dynamic_component * terms.variation_damping);
     }
     
     float get_precipitation(float longitude, float latitude, float altitude) const {
         float moisture = get_moisture(longitude, latitude);
         float temp = get_temperature(longitude, latitude, altitude);
+        float terrain_height = get_terrain_height(longitude, latitude);
         
+        return precipitation_from(moisture, temp, terrain_height, altitude);
+    }
+    
+    float precipitation_from(float moisture, float temp, float terrain_height, float altitude) const {
         // Base precipitation from moisture
         float base_precip = moisture * 2000.0f; // 0 to 2000mm
         
@@ -1592,7 +3299,6 @@ public:
         
         // Altitude effect - mountains capture moisture (orographic precipitation)
         // But very high altitudes are dry
-        float terrain_height = get_terrain_height(longitude, latitude);
         if (terrain_height > 500.0f && terrain_height < 3000.0f) {
             base_precip *= 1.3f; // Mountain slopes get more rain
         } else if (altitude > 4000.0f) {
@@ -1614,7 +3320,7 @@ public:
         geo_to_world(longitude, latitude, x, y, z);
         
         // Sample weather noise with time component
-        float weather_variation = weather_noise.GetNoise(x, y, z + time_scaled * 100.0f);
+        float weather_variation = sample_noise(weather_noise, x, y, z + time_scaled * 100.0f);
         weather_variation = (weather_variation + 1.0f) * 0.5f; // 0-1
         
         // Convert annual precipitation to instantaneous rate (0-1 scale)
@@ -1644,6 +3350,10 @@ public:
         float moisture = get_moisture(longitude, latitude);
         float temp = get_temperature(longitude, latitude, altitude);
         
+        return humidity_from(moisture, temp, altitude);
+    }
+    
+    float humidity_from(float moisture, float temp, float altitude) const {
         // Relative humidity is affected by temperature
         // Cold air has higher relative humidity for same absolute moisture
         float temp_factor = 1.0f - std::clamp((temp - 10.0f) / 40.0f, 0.0f, 0.5f);
@@ -1663,7 +3373,7 @@ public:
         geo_to_world(longitude, latitude, x, y, z);
         
         // Base wind from noise
-        float wind_base = wind_noise.GetNoise(x, y, z);
+        float wind_base = sample_noise(wind_noise, x, y, z);
         wind_base = (wind_base + 1.0f) * 0.5f; // Convert to 0-1
         
         // Global wind patterns based on latitude
@@ -1711,7 +3421,7 @@ public:
         geo_to_world(longitude, latitude, x, y, z);
         
         // Weather noise affects wind speed
-        float weather_var = weather_noise.GetNoise(x, y, z + time_scaled * 50.0f);
+        float weather_var = sample_noise(weather_noise, x, y, z + time_scaled * 50.0f);
         weather_var = (weather_var + 1.0f) * 0.5f; // 0-1
         
         // Wind can vary ±50% from base
@@ -1741,7 +3451,7 @@ public:
         }
         
         // Add local variation from noise
-        float noise_offset = wind_noise.GetNoise(x * 2.0f, y * 2.0f, z * 2.0f) * 60.0f;
+        float noise_offset = sample_noise(wind_noise, x * 2.0f, y * 2.0f, z * 2.0f) * 60.0f;
         base_direction += noise_offset;
         
         // Normalize to 0-360
@@ -1762,7 +3472,7 @@ public:
         geo_to_world(longitude, latitude, x, y, z);
         
         // Weather system affects wind direction
-        float weather_var = weather_noise.GetNoise(x * 1.5f, y * 1.5f, z * 1.5f + time_scaled * 30.0f);
+        float weather_var = sample_noise(weather_noise, x * 1.5f, y * 1.5f, z * 1.5f + time_scaled * 30.0f);
         
         // Wind direction can shift ±45° from base
         float direction_shift = weather_var * 45.0f;
@@ -1812,7 +3522,7 @@ public:
         // Add noise variation for natural-looking river networks
         float x, y, z;
         geo_to_world(longitude, latitude, x, y, z);
-        float noise = river_noise.GetNoise(x, y, z);
+        float noise = sample_noise(river_noise, x, y, z);
         noise = (noise + 1.0f) * 0.5f; // 0-1
         
         // Boost noise influence to create more rivers
@@ -1886,80 +3596,14 @@ public:
     BiomeType classify_biome(float longitude, float latitude, float altitude) const {
         float terrain_height = get_terrain_height(longitude, latitude);
         
-        // Ocean biomes
-        if (terrain_height < config.sea_level) {
-            if (terrain_height < -1000.0f) {
-                return BiomeType::DEEP_OCEAN;
-            }
-            return BiomeType::OCEAN;
-        }
-        
-        // Beach transition
-        if (terrain_height < 5.0f) {
-            return BiomeType::BEACH;
+        // Oceans and beaches depend on terrain height alone
+        if (!classification.biome_needs_climate(terrain_height)) {
+            return classification.biome(terrain_height, 0.0f, 0.0f, altitude);
         }
         
         float temp = get_temperature(longitude, latitude, altitude);
         float moisture = get_moisture(longitude, latitude);
-        
-        // Snow and ice
-        if (temp < -15.0f) {
-            if (terrain_height < 100.0f) {
-                return BiomeType::ICE;
-            }
-            return BiomeType::SNOW;
-        }
-        
-        // High mountain biomes
-        if (altitude > 4000.0f) {
-            return BiomeType::MOUNTAIN_PEAK;
-        } else if (altitude > 2500.0f) {
-            if (temp < 0.0f) {
-                return BiomeType::MOUNTAIN_TUNDRA;
-            }
-            return BiomeType::MOUNTAIN_FOREST;
-        }
-        
-        // Whittaker diagram classification
-        // Based on temperature and moisture
-        
-        // Cold (< 0°C)
-        if (temp < 0.0f) {
-            if (moisture < 0.3f) {
-                return BiomeType::COLD_DESERT;
-            }
-            return BiomeType::TUNDRA;
-        }
-        
-        // Cool (0-10°C)
-        if (temp < 10.0f) {
-            if (moisture < 0.3f) {
-                return BiomeType::COLD_DESERT;
-            } else if (moisture < 0.6f) {
-                return BiomeType::GRASSLAND;
-            }
-            return BiomeType::TAIGA;
-        }
-        
-        // Temperate (10-20°C)
-        if (temp < 20.0f) {
-            if (moisture < 0.3f) {
-                return BiomeType::GRASSLAND;
-            } else if (moisture < 0.6f) {
-                return BiomeType::TEMPERATE_DECIDUOUS_FOREST;
-            }
-            return BiomeType::TEMPERATE_RAINFOREST;
-        }
-        
-        // Hot (> 20°C)
-        if (moisture < 0.2f) {
-            return BiomeType::DESERT;
-        } else if (moisture < 0.5f) {
-            return BiomeType::SAVANNA;
-        } else if (moisture < 0.7f) {
-            return BiomeType::TROPICAL_SEASONAL_FOREST;
-        }
-        return BiomeType::TROPICAL_RAINFOREST;
+        return classification.biome(terrain_height, temp, moisture, altitude);
     }
 };
 
@@ -1975,26 +3619,44 @@ World::World(World&&) noexcept = default;
 World& World::operator=(World&&) noexcept = default;
 
 BiomeType World::get_biome(float longitude, float latitude, float altitude) const {
+    if (pimpl_->coalescer) {
+        return static_cast<BiomeType>(pimpl_->coalescer->query(DataType::BIOME, Location(longitude, latitude, altitude)));
+    }
     return pimpl_->classify_biome(longitude, latitude, altitude);
 }
 
 float World::get_temperature(float longitude, float latitude, float altitude) const {
+    if (pimpl_->coalescer) {
+        return pimpl_->coalescer->query(DataType::TEMPERATURE, Location(longitude, latitude, altitude));
+    }
     return pimpl_->get_temperature(longitude, latitude, altitude);
 }
 
 float World::get_temperature_at_time(float longitude, float latitude, float altitude, float current_time) const {
+    if (pimpl_->coalescer) {
+        return pimpl_->coalescer->query(DataType::TEMPERATURE_AT_TIME, Location(longitude, latitude, altitude, current_time));
+    }
     return pimpl_->get_temperature_at_time(longitude, latitude, altitude, current_time);
 }
 
 float World::get_terrain_height(float longitude, float latitude, float detail_level) const {
+    if (pimpl_->coalescer) {
+        return pimpl_->coalescer->query(DataType::TERRAIN_HEIGHT, Location(longitude, latitude, 0.0f, 12.0f, detail_level));
+    }
     return pimpl_->get_terrain_height(longitude, latitude, detail_level);
 }
 
 float World::get_precipitation(float longitude, float latitude, float altitude) const {
+    if (pimpl_->coalescer) {
+        return pimpl_->coalescer->query(DataType::PRECIPITATION, Location(longitude, latitude, altitude));
+    }
     return pimpl_->get_precipitation(longitude, latitude, altitude);
 }
 
 float World::get_current_precipitation(float longitude, float latitude, float altitude, float current_time) const {
+    if (pimpl_->coalescer) {
+        return pimpl_->coalescer->query(DataType::CURRENT_PRECIPITATION, Location(longitude, latitude, altitude, current_time));
+    }
     return pimpl_->get_current_precipitation(longitude, latitude, altitude, current_time);
 }
 
@@ -2021,99 +3683,172 @@ float World::get_air_pressure(float longitude, float latitude, float altitude) c
 }
 
 float World::get_humidity(float longitude, float latitude, float altitude) const {
+    if (pimpl_->coalescer) {
+        return pimpl_->coalescer->query(DataType::HUMIDITY, Location(longitude, latitude, altitude));
+    }
     return pimpl_->get_humidity(longitude, latitude, altitude);
 }
 
 float World::get_wind_speed(float longitude, float latitude, float altitude) const {
+    if (pimpl_->coalescer) {
+        return pimpl_->coalescer->query(DataType::WIND_SPEED, Location(longitude, latitude, altitude));
+    }
     return pimpl_->get_wind_speed(longitude, latitude, altitude);
 }
 
 float World::get_current_wind_speed(float longitude, float latitude, float altitude, float current_time) const {
+    if (pimpl_->coalescer) {
+        return pimpl_->coalescer->query(DataType::CURRENT_WIND_SPEED, Location(longitude, latitude, altitude, current_time));
+    }
     return pimpl_->get_current_wind_speed(longitude, latitude, altitude, current_time);
 }
 
 float World::get_wind_direction(float longitude, float latitude, float altitude) const {
+    if (pimpl_->coalescer) {
+        return pimpl_->coalescer->query(DataType::WIND_DIRECTION, Location(longitude, latitude, altitude));
+    }
     return pimpl_->get_wind_direction(longitude, latitude, altitude);
 }
 
 float World::get_current_wind_direction(float longitude, float latitude, float altitude, float current_time) const {
+    if (pimpl_->coalescer) {
+        return pimpl_->coalescer->query(DataType::CURRENT_WIND_DIRECTION, Location(longitude, latitude, altitude, current_time));
+    }
     return pimpl_->get_current_wind_direction(longitude, latitude, altitude, current_time);
 }
 
 bool World::is_river(float longitude, float latitude) const {
+    if (pimpl_->coalescer) {
+        return pimpl_->coalescer->query(DataType::IS_RIVER, Location(longitude, latitude)) != 0.0f;
+    }
     return pimpl_->is_river(longitude, latitude);
 }
 
 float World::get_river_width(float longitude, float latitude) const {
+    if (pimpl_->coalescer) {
+        return pimpl_->coalescer->query(DataType::RIVER_WIDTH, Location(longitude, latitude));
+    }
     return pimpl_->get_river_width(longitude, latitude);
 }
 
 float World::get_flow_accumulation(float longitude, float latitude) const {
+    if (pimpl_->coalescer) {
+        return pimpl_->coalescer->query(DataType::FLOW_ACCUMULATION, Location(longitude, latitude));
+    }
     return pimpl_->get_flow_accumulation(longitude, latitude);
 }
 
 bool World::is_volcano(float longitude, float latitude) const {
+    if (pimpl_->coalescer) {
+        return pimpl_->coalescer->query(DataType::IS_VOLCANO, Location(longitude, latitude)) != 0.0f;
+    }
     return pimpl_->is_volcano(longitude, latitude);
 }
 
 float World::get_coal_deposit(float longitude, float latitude) const {
+    if (pimpl_->coalescer) {
+        return pimpl_->coalescer->query(DataType::COAL_DEPOSIT, Location(longitude, latitude));
+    }
     return pimpl_->get_coal_deposit(longitude, latitude);
 }
 
 float World::get_iron_deposit(float longitude, float latitude) const {
+    if (pimpl_->coalescer) {
+        return pimpl_->coalescer->query(DataType::IRON_DEPOSIT, Location(longitude, latitude));
+    }
     return pimpl_->get_iron_deposit(longitude, latitude);
 }
 
 float World::get_oil_deposit(float longitude, float latitude) const {
+    if (pimpl_->coalescer) {
+        return pimpl_->coalescer->query(DataType::OIL_DEPOSIT, Location(longitude, latitude));
+    }
     return pimpl_->get_oil_deposit(longitude, latitude);
 }
 
 float World::get_insolation(float longitude, float latitude, float current_time) const {
+    if (pimpl_->coalescer) {
+        return pimpl_->coalescer->query(DataType::INSOLATION, Location(longitude, latitude, 0.0f, current_time));
+    }
     return pimpl_->get_insolation(longitude, latitude, current_time);
 }
 
 bool World::is_daylight(float longitude, float latitude, float current_time) const {
+    if (pimpl_->coalescer) {
+        return pimpl_->coalescer->query(DataType::IS_DAYLIGHT, Location(longitude, latitude, 0.0f, current_time)) != 0.0f;
+    }
     return pimpl_->is_daylight(longitude, latitude, current_time);
 }
 
 float World::get_solar_angle(float longitude, float latitude, float current_time) const {
+    if (pimpl_->coalescer) {
+        return pimpl_->coalescer->query(DataType::SOLAR_ANGLE, Location(longitude, latitude, 0.0f, current_time));
+    }
     return pimpl_->get_solar_angle(longitude, latitude, current_time);
 }
 
+float World::get_cloud_cover(float longitude, float latitude) const {
+    return pimpl_->get_cloud_cover(longitude, latitude);
+}
+
 float World::get_vegetation_density(float longitude, float latitude, float altitude) const {
+    if (pimpl_->coalescer) {
+        return pimpl_->coalescer->query(DataType::VEGETATION_DENSITY, Location(longitude, latitude, altitude));
+    }
     return pimpl_->get_vegetation_density(longitude, latitude, altitude);
 }
 
 SoilType World::get_soil_type(float longitude, float latitude, float altitude) const {
+    if (pimpl_->coalescer) {
+        return static_cast<SoilType>(pimpl_->coalescer->query(DataType::SOIL_TYPE, Location(longitude, latitude, altitude)));
+    }
     return pimpl_->get_soil_type(longitude, latitude, altitude);
 }
 
 float World::get_soil_fertility(float longitude, float latitude, float altitude) const {
+    if (pimpl_->coalescer) {
+        return pimpl_->coalescer->query(DataType::SOIL_FERTILITY, Location(longitude, latitude, altitude));
+    }
     return pimpl_->get_soil_fertility(longitude, latitude, altitude);
 }
 
 float World::get_soil_ph(float longitude, float latitude, float altitude) const {
+    if (pimpl_->coalescer) {
+        return pimpl_->coalescer->query(DataType::SOIL_PH, Location(longitude, latitude, altitude));
+    }
     return pimpl_->get_soil_ph(longitude, latitude, altitude);
 }
 
 float World::get_organic_matter(float longitude, float latitude, float altitude) const {
+    if (pimpl_->coalescer) {
+        return pimpl_->coalescer->query(DataType::ORGANIC_MATTER, Location(longitude, latitude, altitude));
+    }
     return pimpl_->get_organic_matter(longitude, latitude, altitude);
 }
 
 float World::get_pressure_at_location(float longitude, float latitude, float altitude, float current_time) const {
+    if (pimpl_->coalescer) {
+        return pimpl_->coalescer->query(DataType::PRESSURE_AT_LOCATION, Location(longitude, latitude, altitude, current_time));
+    }
     return pimpl_->get_pressure_at_location(longitude, latitude, altitude, current_time);
 }
 
 float World::get_pressure_gradient(float longitude, float latitude, float current_time) const {
+    if (pimpl_->coalescer) {
+        return pimpl_->coalescer->query(DataType::PRESSURE_GRADIENT, Location(longitude, latitude, 0.0f, current_time));
+    }
     return pimpl_->get_pressure_gradient(longitude, latitude, current_time);
 }
 
 bool World::is_storm_front(float longitude, float latitude, float current_time) const {
+    if (pimpl_->coalescer) {
+        return pimpl_->coalescer->query(DataType::IS_STORM_FRONT, Location(longitude, latitude, 0.0f, current_time)) != 0.0f;
+    }
     return pimpl_->is_storm_front(longitude, latitude, current_time);
 }
 
-BatchResult World::batch_query(const std::vector<Location>& locations,
-                               const std::vector<DataType>& data_types) const {
+BatchResult World::Impl::evaluate_batch(const std::vector<Location>& locations,
+                                       const std::vector<DataType>& data_types) const {
     BatchResult result;
     result.count = locations.size();
     
@@ -2210,6 +3945,16 @@ BatchResult World::batch_query(const std::vector<Location>& locations,
         }
     }
     
+    // Biomes are looked up in one pass once their inputs are gathered
+    bool wants_biome = std::find(data_types.begin(), data_types.end(), DataType::BIOME) != data_types.end();
+    std::vector<float> biome_terrain, biome_temperature, biome_moisture, biome_altitude;
+    if (wants_biome) {
+        biome_terrain.reserve(result.count);
+        biome_temperature.reserve(result.count);
+        biome_moisture.reserve(result.count);
+        biome_altitude.reserve(result.count);
+    }
+    
     // Process all locations
     for (const Location& loc : locations) {
         // Cache commonly needed values
@@ -2220,7 +3965,7 @@ BatchResult World::batch_query(const std::vector<Location>& locations,
         // If altitude is needed but not provided, compute terrain height once
         auto ensure_terrain = [&]() {
             if (!terrain_computed) {
-                terrain_height = pimpl_->get_terrain_height(loc.longitude, loc.latitude, loc.detail_level);
+                terrain_height = get_terrain_height(loc.longitude, loc.latitude, loc.detail_level);
                 if (loc.altitude == 0.0f) {
                     altitude = std::max(terrain_height, 0.0f);
                 }
@@ -2238,33 +3983,42 @@ BatchResult World::batch_query(const std::vector<Location>& locations,
                     
                 case DataType::TEMPERATURE:
                     ensure_terrain();
-                    result.temperature.push_back(pimpl_->get_temperature(loc.longitude, loc.latitude, altitude));
+                    result.temperature.push_back(get_temperature(loc.longitude, loc.latitude, altitude));
                     break;
                     
                 case DataType::TEMPERATURE_AT_TIME:
                     ensure_terrain();
-                    result.temperature.push_back(pimpl_->get_temperature_at_time(loc.longitude, loc.latitude, altitude, loc.current_time));
+                    result.temperature.push_back(get_temperature_at_time(loc.longitude, loc.latitude, altitude, loc.current_time));
                     break;
                     
-                case DataType::BIOME:
+                case DataType::BIOME: {
                     ensure_terrain();
-                    result.biome.push_back(pimpl_->classify_biome(loc.longitude, loc.latitude, altitude));
+                    // Biomes use full-detail terrain whatever loc.detail_level is
+                    float biome_height = loc.detail_level == 1.0f ? terrain_height
+                                                                  : get_terrain_height(loc.longitude, loc.latitude);
+                    bool climate = classification.biome_needs_climate(biome_height);
+                    biome_terrain.push_back(biome_height);
+                    biome_temperature.push_back(climate ? get_temperature(loc.longitude, loc.latitude, altitude) : 0.0f);
+                    biome_moisture.push_back(climate ? get_moisture(loc.longitude, loc.latitude) : 0.0f);
+                    biome_altitude.push_back(altitude);
+                    result.biome.push_back(BiomeType::OCEAN);
                     break;
+                }
                     
                 case DataType::PRECIPITATION:
                     ensure_terrain();
-                    result.precipitation.push_back(pimpl_->get_precipitation(loc.longitude, loc.latitude, altitude));
+                    result.precipitation.push_back(get_precipitation(loc.longitude, loc.latitude, altitude));
                     break;
                     
                 case DataType::CURRENT_PRECIPITATION:
                     ensure_terrain();
-                    result.precipitation.push_back(pimpl_->get_current_precipitation(loc.longitude, loc.latitude, altitude, loc.current_time));
+                    result.precipitation.push_back(get_current_precipitation(loc.longitude, loc.latitude, altitude, loc.current_time));
                     break;
                     
                 case DataType::PRECIPITATION_TYPE: {
                     ensure_terrain();
-                    float temp = pimpl_->get_temperature(loc.longitude, loc.latitude, altitude);
-                    float precip = pimpl_->get_precipitation(loc.longitude, loc.latitude, altitude);
+                    float temp = get_temperature(loc.longitude, loc.latitude, altitude);
+                    float precip = get_precipitation(loc.longitude, loc.latitude, altitude);
                     PrecipitationType ptype = PrecipitationType::NONE;
                     if (precip >= 100.0f) {
                         if (temp < -2.0f) {
@@ -2280,127 +4034,537 @@ BatchResult World::batch_query(const std::vector<Location>& locations,
                 }
                     
                 case DataType::AIR_PRESSURE:
-                    result.air_pressure.push_back(pimpl_->get_air_pressure(altitude));
+                    result.air_pressure.push_back(get_air_pressure(altitude));
                     break;
                     
                 case DataType::HUMIDITY:
                     ensure_terrain();
-                    result.humidity.push_back(pimpl_->get_humidity(loc.longitude, loc.latitude, altitude));
+                    result.humidity.push_back(get_humidity(loc.longitude, loc.latitude, altitude));
                     break;
                     
                 case DataType::WIND_SPEED:
                     ensure_terrain();
-                    result.wind_speed.push_back(pimpl_->get_wind_speed(loc.longitude, loc.latitude, altitude));
+                    result.wind_speed.push_back(get_wind_speed(loc.longitude, loc.latitude, altitude));
                     break;
                     
                 case DataType::CURRENT_WIND_SPEED:
                     ensure_terrain();
-                    result.wind_speed.push_back(pimpl_->get_current_wind_speed(loc.longitude, loc.latitude, altitude, loc.current_time));
+                    result.wind_speed.push_back(get_current_wind_speed(loc.longitude, loc.latitude, altitude, loc.current_time));
                     break;
                     
                 case DataType::WIND_DIRECTION:
                     ensure_terrain();
-                    result.wind_direction.push_back(pimpl_->get_wind_direction(loc.longitude, loc.latitude, altitude));
+                    result.wind_direction.push_back(get_wind_direction(loc.longitude, loc.latitude, altitude));
                     break;
                     
                 case DataType::CURRENT_WIND_DIRECTION:
                     ensure_terrain();
-                    result.wind_direction.push_back(pimpl_->get_current_wind_direction(loc.longitude, loc.latitude, altitude, loc.current_time));
+                    result.wind_direction.push_back(get_current_wind_direction(loc.longitude, loc.latitude, altitude, loc.current_time));
                     break;
                     
                 case DataType::IS_RIVER:
-                    result.is_river.push_back(pimpl_->is_river(loc.longitude, loc.latitude));
+                    result.is_river.push_back(is_river(loc.longitude, loc.latitude));
                     break;
                     
                 case DataType::RIVER_WIDTH:
-                    result.river_width.push_back(pimpl_->get_river_width(loc.longitude, loc.latitude));
+                    result.river_width.push_back(get_river_width(loc.longitude, loc.latitude));
                     break;
                     
                 case DataType::FLOW_ACCUMULATION:
-                    result.flow_accumulation.push_back(pimpl_->get_flow_accumulation(loc.longitude, loc.latitude));
+                    result.flow_accumulation.push_back(get_flow_accumulation(loc.longitude, loc.latitude));
                     break;
                     
                 case DataType::IS_VOLCANO:
-                    result.is_volcano.push_back(pimpl_->is_volcano(loc.longitude, loc.latitude));
+                    result.is_volcano.push_back(is_volcano(loc.longitude, loc.latitude));
                     break;
                     
                 case DataType::COAL_DEPOSIT:
-                    result.coal_deposit.push_back(pimpl_->get_coal_deposit(loc.longitude, loc.latitude));
+                    result.coal_deposit.push_back(get_coal_deposit(loc.longitude, loc.latitude));
                     break;
                     
                 case DataType::IRON_DEPOSIT:
-                    result.iron_deposit.push_back(pimpl_->get_iron_deposit(loc.longitude, loc.latitude));
+                    result.iron_deposit.push_back(get_iron_deposit(loc.longitude, loc.latitude));
                     break;
                     
                 case DataType::OIL_DEPOSIT:
-                    result.oil_deposit.push_back(pimpl_->get_oil_deposit(loc.longitude, loc.latitude));
+                    result.oil_deposit.push_back(get_oil_deposit(loc.longitude, loc.latitude));
                     break;
                     
                 case DataType::INSOLATION:
-                    result.insolation.push_back(pimpl_->get_insolation(loc.longitude, loc.latitude, loc.current_time));
+                    result.insolation.push_back(get_insolation(loc.longitude, loc.latitude, loc.current_time));
                     break;
                     
                 case DataType::IS_DAYLIGHT:
-                    result.is_daylight.push_back(pimpl_->is_daylight(loc.longitude, loc.latitude, loc.current_time));
+                    result.is_daylight.push_back(is_daylight(loc.longitude, loc.latitude, loc.current_time));
                     break;
                     
                 case DataType::SOLAR_ANGLE:
-                    result.solar_angle.push_back(pimpl_->get_solar_angle(loc.longitude, loc.latitude, loc.current_time));
+                    result.solar_angle.push_back(get_solar_angle(loc.longitude, loc.latitude, loc.current_time));
                     break;
                     
                 case DataType::VEGETATION_DENSITY:
                     ensure_terrain();
-                    result.vegetation_density.push_back(pimpl_->get_vegetation_density(loc.longitude, loc.latitude, altitude));
+                    result.vegetation_density.push_back(get_vegetation_density(loc.longitude, loc.latitude, altitude));
                     break;
                     
                 case DataType::SOIL_TYPE:
                     ensure_terrain();
-                    result.soil_type.push_back(pimpl_->get_soil_type(loc.longitude, loc.latitude, altitude));
+                    result.soil_type.push_back(get_soil_type(loc.longitude, loc.latitude, altitude));
                     break;
                     
                 case DataType::SOIL_FERTILITY:
                     ensure_terrain();
-                    result.soil_fertility.push_back(pimpl_->get_soil_fertility(loc.longitude, loc.latitude, altitude));
+                    result.soil_fertility.push_back(get_soil_fertility(loc.longitude, loc.latitude, altitude));
                     break;
                     
                 case DataType::SOIL_PH:
                     ensure_terrain();
-                    result.soil_ph.push_back(pimpl_->get_soil_ph(loc.longitude, loc.latitude, altitude));
+                    result.soil_ph.push_back(get_soil_ph(loc.longitude, loc.latitude, altitude));
                     break;
                     
                 case DataType::ORGANIC_MATTER:
                     ensure_terrain();
-                    result.organic_matter.push_back(pimpl_->get_organic_matter(loc.longitude, loc.latitude, altitude));
+                    result.organic_matter.push_back(get_organic_matter(loc.longitude, loc.latitude, altitude));
                     break;
                     
                 case DataType::PRESSURE_AT_LOCATION:
                     ensure_terrain();
-                    result.pressure_at_location.push_back(pimpl_->get_pressure_at_location(loc.longitude, loc.latitude, altitude, loc.current_time));
+                    result.pressure_at_location.push_back(get_pressure_at_location(loc.longitude, loc.latitude, altitude, loc.current_time));
                     break;
                     
                 case DataType::PRESSURE_GRADIENT:
-                    result.pressure_gradient.push_back(pimpl_->get_pressure_gradient(loc.longitude, loc.latitude, loc.current_time));
+                    result.pressure_gradient.push_back(get_pressure_gradient(loc.longitude, loc.latitude, loc.current_time));
                     break;
                     
                 case DataType::IS_STORM_FRONT:
-                    result.is_storm_front.push_back(pimpl_->is_storm_front(loc.longitude, loc.latitude, loc.current_time));
+                    result.is_storm_front.push_back(is_storm_front(loc.longitude, loc.latitude, loc.current_time));
+                    break;
+            }
+        }
+    }
+    
+    if (wants_biome) {
+        classification.biomes(biome_terrain.data(), biome_temperature.data(), biome_moisture.data(),
+                              biome_altitude.data(), biome_terrain.size(), result.biome.data());
+    }
+    
+    return result;
+}
+
+BatchResult World::batch_query(const std::vector<Location>& locations,
+                               const std::vector<DataType>& data_types) const {
+    BatchOrder order = pimpl_->config.batch_order;
+    if (order == BatchOrder::INPUT || locations.size() < detail::SPATIAL_ORDER_MIN) {
+        return pimpl_->evaluate_batch(locations, data_types);
+    }
+    
+    std::vector<uint32_t> indices = detail::spatial_order(locations, order);
+    std::vector<Location> sorted;
+    sorted.reserve(locations.size());
+    for (uint32_t index : indices) {
+        sorted.push_back(locations[index]);
+    }
+    BatchResult result = pimpl_->evaluate_batch(sorted, data_types);
+    detail::scatter_batch(result, data_types, indices);
+    return result;
+}
+
+GridResult World::grid_query(const GridRegion& region, const std::vector<DataType>& data_types,
+                             int row_begin, int row_end) const {
+    GridResult result;
+    if (row_end < 0 || row_end > region.height) {
+        row_end = std::max(region.height, 0);
+    }
+    row_begin = std::clamp(row_begin, 0, row_end);
+    result.width = std::max(region.width, 0);
+    result.row_begin = row_begin;
+    result.rows = row_end - row_begin;
+    
+    size_t cells = static_cast<size_t>(result.width) * static_cast<size_t>(result.rows);
+    result.layers.assign(data_types.size(), std::vector<float>(cells));
+    if (cells == 0 || data_types.empty()) {
+        return result;
+    }
+    
+    detail::BatchLayout layout(data_types);
+    detail::parallel_for(result.rows, [&](int r) {
+        float latitude = detail::grid_latitude(region, row_begin + r);
+        std::vector<Location> locations;
+        locations.reserve(result.width);
+        for (int c = 0; c < result.width; ++c) {
+            locations.emplace_back(detail::grid_longitude(region, c), latitude, region.altitude,
+                                   region.current_time, region.detail_level);
+        }
+        
+        BatchResult batch = pimpl_->evaluate_batch(locations, data_types); // Rows are already in order
+        size_t offset = static_cast<size_t>(r) * static_cast<size_t>(result.width);
+        for (size_t i = 0; i < data_types.size(); ++i) {
+            layout.extract(batch, i, result.layers[i].data() + offset);
+        }
+    });
+    
+    return result;
+}
+
+TimeSeriesResult World::time_series_query(const std::vector<Location>& locations,
+                                          const std::vector<DataType>& data_types,
+                                          const TimeSeriesRange& range) const {
+    TimeSeriesResult result;
+    result.locations = locations.size();
+    result.days = std::max(range.day_count, 0);
+    result.times = std::max(range.time_count, 0);
+    size_t samples = static_cast<size_t>(result.days) * static_cast<size_t>(result.times);
+    result.layers.assign(data_types.size(), std::vector<float>(locations.size() * samples));
+    if (locations.empty() || samples == 0 || data_types.empty()) {
+        return result;
+    }
+    
+    // Split the request by what each type varies with
+    std::vector<DataType> static_types, weather_types;
+    std::vector<size_t> static_layers, weather_layers;
+    bool need_insolation = false, need_temperature = false;
+    for (size_t i = 0; i < data_types.size(); ++i) {
+        switch (data_types[i]) {
+            case DataType::CURRENT_PRECIPITATION:
+            case DataType::CURRENT_WIND_SPEED:
+            case DataType::CURRENT_WIND_DIRECTION:
+            case DataType::PRESSURE_AT_LOCATION:
+            case DataType::PRESSURE_GRADIENT:
+            case DataType::IS_STORM_FRONT:
+                weather_types.push_back(data_types[i]);
+                weather_layers.push_back(i);
+                break;
+            case DataType::INSOLATION:
+                need_insolation = true;
+                break;
+            case DataType::TEMPERATURE_AT_TIME:
+                need_temperature = true;
+                break;
+            case DataType::IS_DAYLIGHT:
+            case DataType::SOLAR_ANGLE:
+                break;
+            default:
+                static_types.push_back(data_types[i]);
+                static_layers.push_back(i);
+                break;
+        }
+    }
+    bool need_solar = static_types.size() + weather_types.size() < data_types.size();
+    
+    std::vector<detail::SolarDay> days(result.days);
+    for (int d = 0; d < result.days; ++d) {
+        days[d] = detail::solar_day(range.day_at(d));
+    }
+    std::vector<float> times(result.times);
+    for (int t = 0; t < result.times; ++t) {
+        times[t] = range.time_at(t);
+    }
+    
+    // Locations are processed in chunks, one batch query per chunk and class
+    const size_t CHUNK = 256;
+    int chunks = static_cast<int>((locations.size() + CHUNK - 1) / CHUNK);
+    detail::BatchLayout static_layout(static_types);
+    detail::BatchLayout weather_layout(weather_types);
+    detail::parallel_for(chunks, [&](int chunk) {
+        size_t begin = static_cast<size_t>(chunk) * CHUNK;
+        size_t end = std::min(begin + CHUNK, locations.size());
+        std::vector<Location> batch_locations(locations.begin() + begin, locations.begin() + end);
+        std::vector<float> values(batch_locations.size());
+        
+        // Day- and time-independent: once per location, repeated everywhere
+        if (!static_types.empty()) {
+            BatchResult batch = batch_query(batch_locations, static_types);
+            for (size_t i = 0; i < static_types.size(); ++i) {
+                static_layout.extract(batch, i, values.data());
+                std::vector<float>& layer = result.layers[static_layers[i]];
+                for (size_t k = 0; k < values.size(); ++k) {
+                    float* out = layer.data() + result.index(begin + k, 0, 0);
+                    std::fill(out, out + samples, values[k]);
+                }
+            }
+        }
+        
+        // Weather follows the time of day only: once per time, repeated over days
+        for (int t = 0; t < result.times && !weather_types.empty(); ++t) {
+            for (Location& loc : batch_locations) {
+                loc.current_time = times[t];
+            }
+            BatchResult batch = batch_query(batch_locations, weather_types);
+            for (size_t i = 0; i < weather_types.size(); ++i) {
+                weather_layout.extract(batch, i, values.data());
+                std::vector<float>& layer = result.layers[weather_layers[i]];
+                for (size_t k = 0; k < values.size(); ++k) {
+                    for (int d = 0; d < result.days; ++d) {
+                        layer[result.index(begin + k, d, t)] = values[k];
+                    }
+                }
+            }
+        }
+        
+        if (!need_solar) {
+            return;
+        }
+        
+        // Solar terms: cloud cover and diurnal terms per location, the hour
+        // angle per time and the declination per day
+        std::vector<float> hour_cosine(result.times);
+        for (size_t k = begin; k < end; ++k) {
+            const Location& loc = locations[k];
+            for (int t = 0; t < result.times; ++t) {
+                hour_cosine[t] = detail::solar_hour_cosine(loc.longitude, times[t]);
+            }
+            float transmission = 1.0f;
+            if (need_insolation || need_temperature) {
+                transmission = detail::cloud_transmission(pimpl_->get_cloud_cover(loc.longitude, loc.latitude));
+            }
+            Impl::DiurnalTerms diurnal;
+            if (need_temperature) {
+                float altitude = loc.altitude;
+                if (loc.altitude == 0.0f) {
+                    altitude = std::max(pimpl_->get_terrain_height(loc.longitude, loc.latitude, loc.detail_level), 0.0f);
+                }
+                diurnal = pimpl_->diurnal_terms(loc.longitude, loc.latitude, altitude);
+            }
+            
+            for (int d = 0; d < result.days; ++d) {
+                detail::SolarLatitude latitude = detail::solar_latitude(days[d], loc.latitude);
+                for (int t = 0; t < result.times; ++t) {
+                    float solar_angle = detail::solar_elevation(latitude, hour_cosine[t]);
+                    bool is_day = solar_angle > 0.0f;
+                    float insolation = is_day ? detail::surface_insolation(solar_angle, transmission) : 0.0f;
+                    size_t index = result.index(k, d, t);
+                    for (size_t i = 0; i < data_types.size(); ++i) {
+                        switch (data_types[i]) {
+                            case DataType::INSOLATION: result.layers[i][index] = insolation; break;
+                            case DataType::IS_DAYLIGHT: result.layers[i][index] = is_day ? 1.0f : 0.0f; break;
+                            case DataType::SOLAR_ANGLE: result.layers[i][index] = solar_angle; break;
+                            case DataType::TEMPERATURE_AT_TIME:
+                                result.layers[i][index] = pimpl_->temperature_at_time(diurnal, insolation, is_day);
+                                break;
+                            default: break;
+                        }
+                    }
+                }
+            }
+        }
+    });
+    
+    return result;
+}
+
+PathResult World::sample_path(const std::vector<Location>& waypoints, float spacing,
+                              const std::vector<DataType>& data_types,
+                              const PathRefinement& refinement) const {
+    const double EARTH_RADIUS = 6371000.0; // Mean radius in meters
+    const double deg = 3.14159265358979323846 / 180.0;
+    
+    if (!(spacing > 0.0f) || !std::isfinite(spacing)) {
+        throw std::invalid_argument("path spacing must be positive and finite");
+    }
+    
+    PathResult result;
+    if (waypoints.empty()) {
+        return result;
+    }
+    
+    struct Leg {
+        double a[3];
+        double b[3];
+        double angle;
+        double start_distance;
+    };
+    auto unit_vector = [&](const Location& loc, double* v) {
+        double lon = loc.longitude * deg;
+        double lat = loc.latitude * deg;
+        v[0] = std::cos(lat) * std::cos(lon);
+        v[1] = std::cos(lat) * std::sin(lon);
+        v[2] = std::sin(lat);
+    };
+    
+    std::vector<Leg> legs(waypoints.size() > 1 ? waypoints.size() - 1 : 0);
+    double total = 0.0;
+    for (size_t i = 0; i < legs.size(); ++i) {
+        Leg& leg = legs[i];
+        unit_vector(waypoints[i], leg.a);
+        unit_vector(waypoints[i + 1], leg.b);
+        double dot = leg.a[0] * leg.b[0] + leg.a[1] * leg.b[1] + leg.a[2] * leg.b[2];
+        leg.angle = std::acos(std::clamp(dot, -1.0, 1.0));
+        leg.start_distance = total;
+        total += leg.angle * EARTH_RADIUS;
+    }
+    
+    // Samples are addressed by u = leg index + fraction along that leg
+    auto locate = [&](double u) {
+        size_t index = std::min(static_cast<size_t>(u), legs.size() - 1);
+        double t = u - static_cast<double>(index);
+        const Leg& leg = legs[index];
+        double wa = 1.0 - t;
+        double wb = t;
+        if (leg.angle > 1e-9) {
+            wa = std::sin((1.0 - t) * leg.angle) / std::sin(leg.angle);
+            wb = std::sin(t * leg.angle) / std::sin(leg.angle);
+        }
+        double x = wa * leg.a[0] + wb * leg.b[0];
+        double y = wa * leg.a[1] + wb * leg.b[1];
+        double z = wa * leg.a[2] + wb * leg.b[2];
+        
+        const Location& from = waypoints[index];
+        const Location& to = waypoints[index + 1];
+        float ft = static_cast<float>(t);
+        return Location(static_cast<float>(std::atan2(y, x) / deg),
+                        static_cast<float>(std::atan2(z, std::sqrt(x * x + y * y)) / deg),
+                        from.altitude + (to.altitude - from.altitude) * ft,
+                        from.current_time + (to.current_time - from.current_time) * ft,
+                        from.detail_level + (to.detail_level - from.detail_level) * ft);
+    };
+    auto distance_at = [&](double u) {
+        size_t index = std::min(static_cast<size_t>(u), legs.size() - 1);
+        return legs[index].start_distance + (u - static_cast<double>(index)) * legs[index].angle * EARTH_RADIUS;
+    };
+    
+    std::vector<double> us;
+    if (legs.empty()) {
+        result.points.push_back(waypoints[0]);
+        result.distance.push_back(0.0);
+    } else {
+        double step = spacing;
+        for (size_t i = 0; i < legs.size(); ++i) {
+            int count = std::max(1, static_cast<int>(std::ceil(legs[i].angle * EARTH_RADIUS / step)));
+            for (int k = 0; k < count; ++k) {
+                us.push_back(static_cast<double>(i) + static_cast<double>(k) / count);
+            }
+        }
+        us.push_back(static_cast<double>(legs.size()));
+        
+        if (refinement.max_gradient > 0.0f && us.size() > 1) {
+            double min_spacing = refinement.min_spacing > 0.0f ? refinement.min_spacing : step / 64.0;
+            // heights[i] is the terrain at us[i], mids[i] at the middle of interval i
+            auto probe = [&](const std::vector<double>& at) {
+                std::vector<Location> points;
+                points.reserve(at.size());
+                for (double u : at) {
+                    points.push_back(locate(u));
+                }
+                return pimpl_->evaluate_batch(points, {DataType::TERRAIN_HEIGHT}).terrain_height;
+            };
+            std::vector<double> probes = us;
+            for (size_t i = 0; i + 1 < us.size(); ++i) {
+                probes.push_back((us[i] + us[i + 1]) * 0.5);
+            }
+            std::vector<float> heights = probe(probes);
+            std::vector<float> mids(heights.begin() + us.size(), heights.end());
+            heights.resize(us.size());
+            
+            // An interval is accepted only if both halves are flat enough, so
+            // a peak or valley between two similar endpoints still splits it.
+            // Each round promotes the midpoints of steep intervals to samples
+            // and probes only the new quarter points.
+            for (;;) {
+                std::vector<size_t> steep;
+                for (size_t i = 0; i + 1 < us.size(); ++i) {
+                    double half = (distance_at(us[i + 1]) - distance_at(us[i])) * 0.5;
+                    double limit = refinement.max_gradient * half;
+                    if (half >= min_spacing &&
+                        (std::abs(static_cast<double>(mids[i]) - heights[i]) > limit ||
+                         std::abs(static_cast<double>(heights[i + 1]) - mids[i]) > limit)) {
+                        steep.push_back(i);
+                    }
+                }
+                if (steep.empty()) {
                     break;
+                }
+                
+                std::vector<double> quarters;
+                quarters.reserve(steep.size() * 2);
+                for (size_t i : steep) {
+                    double middle = (us[i] + us[i + 1]) * 0.5;
+                    quarters.push_back((us[i] + middle) * 0.5);
+                    quarters.push_back((middle + us[i + 1]) * 0.5);
+                }
+                std::vector<float> quarter_heights = probe(quarters);
+                
+                std::vector<double> merged_us;
+                std::vector<float> merged_heights;
+                std::vector<float> merged_mids;
+                merged_us.reserve(us.size() + steep.size());
+                merged_heights.reserve(us.size() + steep.size());
+                merged_mids.reserve(us.size() + steep.size());
+                for (size_t i = 0, s = 0; i < us.size(); ++i) {
+                    merged_us.push_back(us[i]);
+                    merged_heights.push_back(heights[i]);
+                    if (i + 1 == us.size()) {
+                        break;
+                    }
+                    if (s < steep.size() && steep[s] == i) {
+                        merged_mids.push_back(quarter_heights[2 * s]);
+                        merged_us.push_back((us[i] + us[i + 1]) * 0.5);
+                        merged_heights.push_back(mids[i]);
+                        merged_mids.push_back(quarter_heights[2 * s + 1]);
+                        ++s;
+                    } else {
+                        merged_mids.push_back(mids[i]);
+                    }
+                }
+                us.swap(merged_us);
+                heights.swap(merged_heights);
+                mids.swap(merged_mids);
             }
         }
+        
+        for (double u : us) {
+            result.points.push_back(locate(u));
+            result.distance.push_back(distance_at(u));
+        }
+    }
+    
+    std::vector<DataType> types = {DataType::TERRAIN_HEIGHT, DataType::BIOME, DataType::IS_RIVER};
+    for (DataType type : data_types) {
+        if (std::find(types.begin(), types.end(), type) == types.end()) {
+            types.push_back(type);
+        }
+    }
+    result.data = pimpl_->evaluate_batch(result.points, types); // Already in path order
+    result.elevation = result.data.terrain_height;
+    
+    size_t count = result.points.size();
+    result.slope.assign(count, 0.0f);
+    for (size_t i = 1; i < count; ++i) {
+        float run = static_cast<float>(result.distance[i] - result.distance[i - 1]);
+        float rise = result.elevation[i] - result.elevation[i - 1];
+        result.slope[i] = std::atan2(rise, run) * 180.0f / 3.14159265359f;
+        if (result.data.biome[i] != result.data.biome[i - 1]) {
+            result.biome_crossings.push_back(i);
+        }
+        if (result.data.is_river[i] && !result.data.is_river[i - 1]) {
+            result.river_crossings.push_back(i);
+        }
     }
     
     return result;
 }
 
 void World::set_config(const WorldConfig& config) {
+    // Built first, so rules that are rejected leave the world unchanged
+    detail::ClassificationTables classification(config.classification.get(), config.sea_level);
     pimpl_->config = config;
+    pimpl_->solar = detail::solar_day(config.day_of_year);
+    pimpl_->classification = std::move(classification);
     pimpl_->initialize_noise_generators();
+    pimpl_->initialize_coalescer();
 }
 
 const WorldConfig& World::get_config() const {
     return pimpl_->config;
 }
 
+const char* World::get_kernel_variant() const {
+    return pimpl_->kernels->name;
+}
+
+CoalescingStats World::get_coalescing_stats() const {
+    return pimpl_->coalescer ? pimpl_->coalescer->stats() : CoalescingStats{};
+}
+
 const char* biome_to_string(BiomeType biome) {
     switch (biome) {
         case BiomeType::TUNDRA: return "Tundra";
@@ -2439,6 +4603,54 @@ const char* soil_to_string(SoilType soil) {
     }
 }
 
+const char* data_type_to_string(DataType type) {
+    switch (type) {
+        case DataType::TERRAIN_HEIGHT: return "terrain_height";
+        case DataType::TEMPERATURE: return "temperature";
+        case DataType::TEMPERATURE_AT_TIME: return "temperature_at_time";
+        case DataType::BIOME: return "biome";
+        case DataType::PRECIPITATION: return "precipitation";
+        case DataType::CURRENT_PRECIPITATION: return "current_precipitation";
+        case DataType::PRECIPITATION_TYPE: return "precipitation_type";
+        case DataType::AIR_PRESSURE: return "air_pressure";
+        case DataType::HUMIDITY: return "humidity";
+        case DataType::WIND_SPEED: return "wind_speed";
+        case DataType::CURRENT_WIND_SPEED: return "current_wind_speed";
+        case DataType::WIND_DIRECTION: return "wind_direction";
+        case DataType::CURRENT_WIND_DIRECTION: return "current_wind_direction";
+        case DataType::IS_RIVER: return "is_river";
+        case DataType::RIVER_WIDTH: return "river_width";
+        case DataType::FLOW_ACCUMULATION: return "flow_accumulation";
+        case DataType::IS_VOLCANO: return "is_volcano";
+        case DataType::COAL_DEPOSIT: return "coal_deposit";
+        case DataType::IRON_DEPOSIT: return "iron_deposit";
+        case DataType::OIL_DEPOSIT: return "oil_deposit";
+        case DataType::INSOLATION: return "insolation";
+        case DataType::IS_DAYLIGHT: return "is_daylight";
+        case DataType::SOLAR_ANGLE: return "solar_angle";
+        case DataType::VEGETATION_DENSITY: return "vegetation_density";
+        case DataType::SOIL_TYPE: return "soil_type";
+        case DataType::SOIL_FERTILITY: return "soil_fertility";
+        case DataType::SOIL_PH: return "soil_ph";
+        case DataType::ORGANIC_MATTER: return "organic_matter";
+        case DataType::PRESSURE_AT_LOCATION: return "pressure_at_location";
+        case DataType::PRESSURE_GRADIENT: return "pressure_gradient";
+        case DataType::IS_STORM_FRONT: return "is_storm_front";
+        default: return "unknown";
+    }
+}
+
+bool data_type_from_string(const char* name, DataType& type) {
+    for (int i = 0; i <= static_cast<int>(DataType::IS_STORM_FRONT); ++i) {
+        DataType candidate = static_cast<DataType>(i);
+        if (std::strcmp(name, data_type_to_string(candidate)) == 0) {
+            type = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
 } // namespace rworld
 #endif // _RWORLD_IMPLEMENTATION
 #endif // RWORLD_WORLD_H
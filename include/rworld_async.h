@@ -0,0 +1,503 @@
+#ifndef RWORLD_ASYNC_H
+#define RWORLD_ASYNC_H
+
+#include "rworld.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+#include <coroutine>
+#define RWORLD_HAS_COROUTINES 1
+#endif
+
+namespace rworld {
+
+/**
+ * Unit of work handed to an Executor
+ */
+class ExecutorTask {
+public:
+    virtual ~ExecutorTask() = default;
+
+    /**
+     * Scheduling key; lower values should run first. May change while the
+     * task is queued (e.g. as the camera moves), so read it when dequeuing.
+     */
+    virtual float priority() const = 0;
+
+    /**
+     * Do the work. Cheap for tasks cancelled while queued.
+     */
+    virtual void run() = 0;
+
+    /**
+     * Called instead of run() when the executor shuts down with the task
+     * still queued
+     */
+    virtual void abandon() = 0;
+};
+
+/**
+ * Where asynchronous queries run
+ *
+ * Implement submit() to plug queries into an engine's own job system; the
+ * only requirement is that every submitted task eventually gets run() or
+ * abandon(), on any thread.
+ */
+class Executor {
+public:
+    virtual ~Executor() = default;
+    virtual void submit(std::shared_ptr<ExecutorTask> task) = 0;
+};
+
+/**
+ * Fixed pool of worker threads that always runs the queued task with the
+ * lowest priority() next
+ *
+ * Priorities are re-read on every dequeue, so reprioritizing a queued task
+ * takes effect immediately. Queries on a worker run single-threaded; the
+ * pool is the parallelism. The destructor abandons queued tasks and waits
+ * for running ones.
+ */
+class ThreadPoolExecutor : public Executor {
+public:
+    /**
+     * @param threads Worker threads (0 = hardware threads or RWORLD_THREADS)
+     */
+    explicit ThreadPoolExecutor(int threads = 0);
+    ~ThreadPoolExecutor() override;
+
+    ThreadPoolExecutor(const ThreadPoolExecutor&) = delete;
+    ThreadPoolExecutor& operator=(const ThreadPoolExecutor&) = delete;
+
+    void submit(std::shared_ptr<ExecutorTask> task) override;
+
+    int thread_count() const;
+
+    /**
+     * Tasks waiting for a worker
+     */
+    size_t queued() const;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> pimpl_;
+};
+
+/**
+ * Thrown by QueryFuture::get() (and co_await) for a cancelled query
+ */
+class QueryCancelled : public std::runtime_error {
+public:
+    QueryCancelled() : std::runtime_error("rworld query cancelled") {}
+};
+
+namespace detail {
+
+/**
+ * Shared state of one asynchronous query
+ */
+template <typename T>
+class QueryState : public ExecutorTask {
+public:
+    enum class Status { PENDING, RUNNING, READY, FAILED, CANCELLED };
+
+    QueryState(std::function<T()> compute, float priority)
+        : compute_(std::move(compute)), priority_(priority) {}
+
+    float priority() const override { return priority_.load(std::memory_order_relaxed); }
+    void set_priority(float priority) { priority_.store(priority, std::memory_order_relaxed); }
+
+    void run() override {
+        if (!start()) {
+            return;
+        }
+        try {
+            T value = compute_();
+            finish(Status::READY, std::move(value), nullptr);
+        } catch (...) {
+            finish(Status::FAILED, T(), std::current_exception());
+        }
+    }
+
+    void abandon() override { cancel(); }
+
+    // Only a query that has not started can be cancelled
+    bool cancel() {
+        return finish(Status::CANCELLED, T(), nullptr);
+    }
+
+    // For producers other than run(): PENDING -> RUNNING, false if cancelled
+    bool start() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (status_ != Status::PENDING) {
+            return false;
+        }
+        status_ = Status::RUNNING;
+        return true;
+    }
+
+    bool fulfill(T value) { return finish(Status::READY, std::move(value), nullptr); }
+    bool fail(std::exception_ptr failure) { return finish(Status::FAILED, T(), failure); }
+
+    Status status() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return status_;
+    }
+
+    bool done() const {
+        Status current = status();
+        return current != Status::PENDING && current != Status::RUNNING;
+    }
+
+    void wait() const {
+        std::unique_lock<std::mutex> lock(mutex_);
+        finished_.wait(lock, [this]() { return status_ != Status::PENDING && status_ != Status::RUNNING; });
+    }
+
+    // Result after wait(); rethrows a failure or QueryCancelled
+    T& result() {
+        wait();
+        if (status_ == Status::CANCELLED) {
+            throw QueryCancelled();
+        }
+        if (failure_) {
+            std::rethrow_exception(failure_);
+        }
+        return value_;
+    }
+
+    // Queue f to run once done; false (f not kept) if already done
+    bool then(std::function<void()> f) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (status_ != Status::PENDING && status_ != Status::RUNNING) {
+            return false;
+        }
+        continuations_.push_back(std::move(f));
+        return true;
+    }
+
+private:
+    // False when already done, or when a cancel arrives after the query started
+    bool finish(Status status, T value, std::exception_ptr failure) {
+        std::vector<std::function<void()>> continuations;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            bool done = status_ != Status::PENDING && status_ != Status::RUNNING;
+            if (done || (status == Status::CANCELLED && status_ != Status::PENDING)) {
+                return false;
+            }
+            status_ = status;
+            value_ = std::move(value);
+            failure_ = failure;
+            continuations.swap(continuations_);
+            compute_ = nullptr;
+        }
+        finished_.notify_all();
+        for (std::function<void()>& continuation : continuations) {
+            continuation();
+        }
+        return true;
+    }
+
+    std::function<T()> compute_;
+    std::atomic<float> priority_;
+    mutable std::mutex mutex_;  // Guards the fields below
+    mutable std::condition_variable finished_;
+    Status status_ = Status::PENDING;
+    T value_{};
+    std::exception_ptr failure_;
+    std::vector<std::function<void()>> continuations_;
+};
+
+} // namespace detail
+
+/**
+ * Handle to the result of an asynchronous query
+ *
+ * Copies share one query. Dropping every handle does not cancel it; call
+ * cancel(). Under C++20 the handle is awaitable: `co_await future` suspends
+ * until the query finishes and resumes the coroutine on the thread that
+ * completed it (a worker, or the thread that called cancel()). co_await
+ * moves the result out of the shared state, so await one query once.
+ */
+template <typename T>
+class QueryFuture {
+public:
+    QueryFuture() = default;
+    explicit QueryFuture(std::shared_ptr<detail::QueryState<T>> state) : state_(std::move(state)) {}
+
+    bool valid() const { return state_ != nullptr; }
+
+    /**
+     * True once the query finished, failed or was cancelled
+     */
+    bool ready() const { return state_->done(); }
+
+    bool cancelled() const { return state_->status() == detail::QueryState<T>::Status::CANCELLED; }
+
+    void wait() const { state_->wait(); }
+
+    /**
+     * Block for the result
+     *
+     * Rethrows an exception raised by the query, or throws QueryCancelled.
+     */
+    T& get() const { return state_->result(); }
+
+    /**
+     * Drop the query if it has not started yet
+     *
+     * @return true if it was cancelled; false if it already started or finished
+     */
+    bool cancel() const { return state_->cancel(); }
+
+    /**
+     * Change the scheduling key of a queued query (lower runs sooner)
+     */
+    void set_priority(float priority) const { state_->set_priority(priority); }
+
+    float priority() const { return state_->priority(); }
+
+    /**
+     * Call f once the query is done, on the completing thread, or right away
+     * on this thread if it already is
+     */
+    void on_ready(std::function<void()> f) const {
+        if (!state_->then(f)) {
+            f();
+        }
+    }
+
+#ifdef RWORLD_HAS_COROUTINES
+    struct Awaiter {
+        std::shared_ptr<detail::QueryState<T>> state;
+
+        bool await_ready() const { return state->done(); }
+
+        bool await_suspend(std::coroutine_handle<> handle) {
+            return state->then([handle]() { handle.resume(); });
+        }
+
+        T await_resume() { return std::move(state->result()); }
+    };
+
+    Awaiter operator co_await() const { return Awaiter{state_}; }
+#endif
+
+private:
+    std::shared_ptr<detail::QueryState<T>> state_;
+};
+
+using TileFuture = QueryFuture<GridResult>;
+using BatchFuture = QueryFuture<BatchResult>;
+
+/**
+ * Non-blocking queries on a World, completed on executor threads
+ *
+ * Terrain streaming requests tiles (grid regions) as the camera moves and
+ * must never stall the frame. Each query is queued on the executor with a
+ * priority (lower = sooner, typically tile_priority() from the camera),
+ * which can be updated while it waits; tiles that scroll out of view are
+ * cancelled before they cost anything. A query that has started runs to
+ * completion.
+ *
+ * ```cpp
+ * AsyncWorld async(world);
+ * TileFuture tile = async.query_tile_async(region, {DataType::TERRAIN_HEIGHT},
+ *                                          tile_priority(region, camera_lon, camera_lat));
+ * // Each frame: if (tile.ready()) upload(tile.get());
+ *
+ * // Or, in a C++20 coroutine:
+ * std::vector<DataType> types = {DataType::TERRAIN_HEIGHT};
+ * GridResult heights = co_await async.query_tile_async(region, types);
+ * ```
+ *
+ * The World must outlive every query and must not be reconfigured while
+ * queries are pending.
+ */
+class AsyncWorld {
+public:
+    /**
+     * Queries run on an owned ThreadPoolExecutor
+     */
+    explicit AsyncWorld(const World& world, int threads = 0);
+
+    /**
+     * Queries run on executor, which must outlive this object
+     */
+    AsyncWorld(const World& world, Executor& executor);
+
+    const World& world() const { return world_; }
+    Executor& executor() const { return *executor_; }
+
+    /**
+     * Queue a grid query for a tile
+     *
+     * @param region Tile bounds and resolution
+     * @param data_types One output layer per type
+     * @param priority Scheduling key, lower runs first
+     */
+    TileFuture query_tile_async(const GridRegion& region, const std::vector<DataType>& data_types,
+                                float priority = 0.0f) const;
+
+    /**
+     * Queue a batch query
+     */
+    BatchFuture batch_query_async(const std::vector<Location>& locations, const std::vector<DataType>& data_types,
+                                  float priority = 0.0f) const;
+
+private:
+    const World& world_;
+    std::unique_ptr<ThreadPoolExecutor> owned_executor_;
+    Executor* executor_;
+};
+
+/**
+ * Great-circle distance in degrees from a camera position to the center
+ * of a region, for use as a tile priority
+ */
+float tile_priority(const GridRegion& region, float camera_longitude, float camera_latitude);
+
+} // namespace rworld
+
+#ifdef _RWORLD_IMPLEMENTATION
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+namespace rworld {
+
+class ThreadPoolExecutor::Impl {
+public:
+    mutable std::mutex mutex;      // Guards queue and stopping
+    std::condition_variable wake;  // Signals a new task or shutdown
+    std::vector<std::shared_ptr<ExecutorTask>> queue;
+    bool stopping = false;
+    std::vector<std::thread> threads;
+
+    explicit Impl(int count) {
+        count = count > 0 ? count : detail::worker_count();
+        for (int i = 0; i < count; ++i) {
+            threads.emplace_back([this]() { loop(); });
+        }
+    }
+
+    ~Impl() {
+        std::vector<std::shared_ptr<ExecutorTask>> abandoned;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+            abandoned.swap(queue);
+        }
+        wake.notify_all();
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+        for (std::shared_ptr<ExecutorTask>& task : abandoned) {
+            task->abandon();
+        }
+    }
+
+    void loop() {
+        detail::ParallelWorkerScope scope;
+        for (;;) {
+            std::shared_ptr<ExecutorTask> task;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [this]() { return stopping || !queue.empty(); });
+                if (stopping) {
+                    return;
+                }
+                // Linear scan: priorities change while queued, and streaming
+                // queues hold hundreds of tiles, not millions
+                auto best = std::min_element(queue.begin(), queue.end(),
+                                             [](const std::shared_ptr<ExecutorTask>& a,
+                                                const std::shared_ptr<ExecutorTask>& b) {
+                                                 return a->priority() < b->priority();
+                                             });
+                task = std::move(*best);
+                *best = std::move(queue.back());
+                queue.pop_back();
+            }
+            task->run();
+        }
+    }
+};
+
+ThreadPoolExecutor::ThreadPoolExecutor(int threads) : pimpl_(std::make_unique<Impl>(threads)) {}
+
+ThreadPoolExecutor::~ThreadPoolExecutor() = default;
+
+void ThreadPoolExecutor::submit(std::shared_ptr<ExecutorTask> task) {
+    {
+        std::lock_guard<std::mutex> lock(pimpl_->mutex);
+        if (!pimpl_->stopping) {
+            pimpl_->queue.push_back(std::move(task));
+            task = nullptr;
+        }
+    }
+    if (task) {
+        task->abandon();
+        return;
+    }
+    pimpl_->wake.notify_one();
+}
+
+int ThreadPoolExecutor::thread_count() const {
+    return static_cast<int>(pimpl_->threads.size());
+}
+
+size_t ThreadPoolExecutor::queued() const {
+    std::lock_guard<std::mutex> lock(pimpl_->mutex);
+    return pimpl_->queue.size();
+}
+
+AsyncWorld::AsyncWorld(const World& world, int threads)
+    : world_(world), owned_executor_(std::make_unique<ThreadPoolExecutor>(threads)),
+      executor_(owned_executor_.get()) {}
+
+AsyncWorld::AsyncWorld(const World& world, Executor& executor) : world_(world), executor_(&executor) {}
+
+TileFuture AsyncWorld::query_tile_async(const GridRegion& region, const std::vector<DataType>& data_types,
+                                        float priority) const {
+    const World& world = world_;
+    auto state = std::make_shared<detail::QueryState<GridResult>>(
+        [&world, region, data_types]() { return world.grid_query(region, data_types); }, priority);
+    executor_->submit(state);
+    return TileFuture(state);
+}
+
+BatchFuture AsyncWorld::batch_query_async(const std::vector<Location>& locations,
+                                          const std::vector<DataType>& data_types, float priority) const {
+    const World& world = world_;
+    auto state = std::make_shared<detail::QueryState<BatchResult>>(
+        [&world, locations, data_types]() { return world.batch_query(locations, data_types); }, priority);
+    executor_->submit(state);
+    return BatchFuture(state);
+}
+
+float tile_priority(const GridRegion& region, float camera_longitude, float camera_latitude) {
+    const double deg = 3.14159265358979323846 / 180.0;
+    double longitude = (region.west + region.east) * 0.5;
+    double latitude = (region.south + region.north) * 0.5;
+    // Haversine, stable for the short distances that matter most
+    double dlat = (latitude - camera_latitude) * deg;
+    double dlon = (longitude - camera_longitude) * deg;
+    double h = std::sin(dlat * 0.5) * std::sin(dlat * 0.5) +
+               std::cos(latitude * deg) * std::cos(camera_latitude * deg) * std::sin(dlon * 0.5) * std::sin(dlon * 0.5);
+    return static_cast<float>(2.0 * std::asin(std::sqrt(std::min(h, 1.0))) / deg);
+}
+
+} // namespace rworld
+
+#endif // _RWORLD_IMPLEMENTATION
+#endif // RWORLD_ASYNC_H
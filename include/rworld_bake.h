@@ -0,0 +1,699 @@
+#ifndef RWORLD_BAKE_H
+#define RWORLD_BAKE_H
+
+#include "rworld.h"
+#include "rworld_quantize.h"
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace rworld {
+
+/**
+ * Settings for baking a region into compressed tiles
+ */
+struct BakeOptions {
+    GridRegion region;
+    std::vector<DataType> types;
+    std::vector<LayerQuantization> quantization;  // Per type (empty or missing = default_quantization)
+    int tile_size = 256;
+    std::function<void(int rows_done, int rows_total)> progress; // Optional, called after each tile row
+};
+
+/**
+ * Region of a world baked into compressed, lazily decoded tiles
+ *
+ * Each layer is quantized (see rworld_quantize.h) and every tile is coded
+ * on its own: cells are predicted from their left, upper and upper-left
+ * neighbours, and the zigzagged residuals are bit-packed in blocks of 128
+ * with one width byte per block. Smooth fields such as terrain and climate
+ * leave residuals of a few bits, and constant areas (oceans, empty deposit
+ * layers) cost one byte per block. There are no external dependencies.
+ *
+ * Tiles stay compressed in memory and are decoded on first access; the
+ * decoded tile is kept until release(). tile(), value() and read() are
+ * safe to call from several threads at once.
+ *
+ * ```cpp
+ * BakeOptions options;
+ * options.region.width = 43200;
+ * options.region.height = 21600;
+ * options.types = {DataType::TERRAIN_HEIGHT, DataType::BIOME};
+ * BakedWorld baked;
+ * baked.bake(world, options);
+ * baked.save("earth.rwb");
+ *
+ * BakedWorld loaded;
+ * loaded.load("earth.rwb");
+ * float height = loaded.value(0, 1200, 800);
+ * ```
+ */
+class BakedWorld {
+public:
+    BakedWorld() = default;
+    ~BakedWorld();
+    BakedWorld(const BakedWorld&) = delete;
+    BakedWorld& operator=(const BakedWorld&) = delete;
+
+    /**
+     * Sample a region from a world and compress it, replacing any contents
+     *
+     * Rows are computed one tile row at a time with World::grid_query, so
+     * peak memory is a tile row of floats plus the compressed tiles.
+     */
+    bool bake(const World& world, const BakeOptions& options, std::string* error = nullptr);
+
+    /**
+     * Write the compressed tiles to a file (little-endian, see load)
+     */
+    bool save(const std::string& path, std::string* error = nullptr) const;
+
+    /**
+     * Read a file written by save, replacing any contents
+     *
+     * Only the compressed tiles are read; nothing is decoded until accessed.
+     */
+    bool load(const std::string& path, std::string* error = nullptr);
+
+    const GridRegion& region() const { return region_; }
+    const std::vector<DataType>& types() const { return types_; }
+    const std::vector<LayerQuantization>& quantization() const { return quantization_; }
+    int tile_size() const { return tile_size_; }
+    int tile_columns() const { return tile_columns_; }
+    int tile_rows() const { return tile_rows_; }
+
+    /**
+     * Decoded cells of one tile, decoding it on first access
+     *
+     * Row-major with tile_width(tile_column) cells per row. Edge tiles are
+     * narrower or shorter when the region does not divide evenly.
+     */
+    const float* tile(size_t layer, int tile_column, int tile_row) const;
+
+    int tile_width(int tile_column) const;
+    int tile_height(int tile_row) const;
+
+    /**
+     * Decoded value of one cell (layer in data type order)
+     */
+    float value(size_t layer, int column, int row) const;
+
+    /**
+     * Copy rows [row_begin, row_end) of every layer into out, as
+     * World::grid_query would return them
+     */
+    void read(int row_begin, int row_end, GridResult& out) const;
+
+    /**
+     * Drop every decoded tile; must not run concurrently with access
+     */
+    void release();
+
+    size_t compressed_bytes() const { return data_.size(); }
+    size_t decoded_bytes() const { return decoded_bytes_; }
+
+private:
+    struct TileRef {
+        uint64_t offset = 0;
+        uint32_t size = 0;
+    };
+
+    void clear();
+    void allocate_slots();
+    size_t slot(size_t layer, int tile_column, int tile_row) const {
+        return (static_cast<size_t>(tile_row) * tile_columns_ + tile_column) * types_.size() + layer;
+    }
+
+    GridRegion region_;
+    std::vector<DataType> types_;
+    std::vector<LayerQuantization> quantization_;
+    int tile_size_ = 0;
+    int tile_columns_ = 0;
+    int tile_rows_ = 0;
+    std::vector<TileRef> index_;
+    std::vector<unsigned char> data_;
+    std::unique_ptr<std::atomic<float*>[]> decoded_;
+    mutable std::atomic<size_t> decoded_bytes_{0};
+};
+
+} // namespace rworld
+
+#ifdef _RWORLD_IMPLEMENTATION
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <utility>
+
+namespace rworld {
+
+namespace detail {
+
+constexpr int BAKE_BLOCK = 128;          // Residuals per bit-width block
+constexpr size_t BAKE_PADDING = 8;       // Zero bytes after each tile so unpacking may load 8 bytes anywhere
+constexpr char BAKE_MAGIC[8] = {'R', 'W', 'B', 'A', 'K', 'E', '1', '\0'};
+
+// Order-preserving integer for each cell, so that neighbouring values give
+// small differences for every scheme (floats are sign-folded)
+inline uint32_t bake_symbol(const LayerQuantization& quantization, const FixedEncoder& encoder, float value) {
+    switch (quantization.scheme) {
+        case QuantizationScheme::FLOAT32: {
+            uint32_t bits;
+            std::memcpy(&bits, &value, sizeof(bits));
+            return bits & 0x80000000u ? ~bits : bits | 0x80000000u;
+        }
+        case QuantizationScheme::FLOAT16: {
+            uint32_t half = float_to_half(value);
+            return half & 0x8000u ? ~half & 0xffffu : half | 0x8000u;
+        }
+        default:
+            return encoder(value);
+    }
+}
+
+inline uint32_t zigzag(uint32_t residual) {
+    return (residual << 1) ^ static_cast<uint32_t>(static_cast<int32_t>(residual) >> 31);
+}
+
+inline uint32_t unzigzag(uint32_t code) {
+    return (code >> 1) ^ (0u - (code & 1u));
+}
+
+// Append count codes (count <= BAKE_BLOCK) as a width byte and packed bits
+inline void bake_pack_block(const uint32_t* codes, int count, std::vector<unsigned char>& out) {
+    uint32_t any = 0;
+    for (int i = 0; i < count; ++i) {
+        any |= codes[i];
+    }
+    int bits = 0;
+    while (bits < 32 && (any >> bits) != 0) {
+        ++bits;
+    }
+    size_t start = out.size();
+    size_t bytes = (static_cast<size_t>(count) * bits + 7) / 8;
+    out.resize(start + 1 + bytes + BAKE_PADDING, 0);
+    out[start] = static_cast<unsigned char>(bits);
+    unsigned char* packed = out.data() + start + 1;
+    for (int i = 0; i < count && bits > 0; ++i) {
+        size_t bit = static_cast<size_t>(i) * bits;
+        uint64_t word;
+        std::memcpy(&word, packed + (bit >> 3), sizeof(word));
+        word |= static_cast<uint64_t>(codes[i]) << (bit & 7);
+        std::memcpy(packed + (bit >> 3), &word, sizeof(word));
+    }
+    out.resize(start + 1 + bytes);
+}
+
+// Full blocks unpack with the width known at compile time. Every group of
+// 8 codes starts on a byte boundary, so the inner loop unrolls to constant
+// offsets and shifts.
+template <int Bits>
+inline void bake_unpack_block(const unsigned char* packed, uint32_t* out) {
+    if (Bits == 0) {
+        std::fill(out, out + BAKE_BLOCK, 0u);
+        return;
+    }
+    constexpr uint64_t mask = (uint64_t(1) << Bits) - 1;
+    for (int group = 0; group < BAKE_BLOCK / 8; ++group, packed += Bits, out += 8) {
+        for (int i = 0; i < 8; ++i) {
+            int bit = i * Bits;
+            uint64_t word;
+            std::memcpy(&word, packed + (bit >> 3), sizeof(word));
+            out[i] = static_cast<uint32_t>((word >> (bit & 7)) & mask);
+        }
+    }
+}
+
+template <size_t... Bits>
+inline void bake_unpack_full(int bits, const unsigned char* packed, uint32_t* out, std::index_sequence<Bits...>) {
+    using Unpack = void (*)(const unsigned char*, uint32_t*);
+    static constexpr Unpack unpack[] = {bake_unpack_block<static_cast<int>(Bits)>...};
+    unpack[bits](packed, out);
+}
+
+inline void bake_unpack_partial(int bits, int count, const unsigned char* packed, uint32_t* out) {
+    uint64_t mask = (uint64_t(1) << bits) - 1;
+    for (int i = 0; i < count; ++i) {
+        size_t bit = static_cast<size_t>(i) * bits;
+        uint64_t word;
+        std::memcpy(&word, packed + (bit >> 3), sizeof(word));
+        out[i] = static_cast<uint32_t>((word >> (bit & 7)) & mask);
+    }
+}
+
+/**
+ * Compress one tile of one layer
+ *
+ * values holds height rows of width cells, stride floats apart.
+ */
+inline void bake_encode_tile(const LayerQuantization& quantization, const float* values, size_t stride,
+                             int width, int height, std::vector<unsigned char>& out) {
+    FixedEncoder encoder(quantization);
+    size_t count = static_cast<size_t>(width) * height;
+    std::vector<uint32_t> symbols(count);
+    for (int r = 0; r < height; ++r) {
+        for (int c = 0; c < width; ++c) {
+            symbols[static_cast<size_t>(r) * width + c] = bake_symbol(quantization, encoder, values[r * stride + c]);
+        }
+    }
+
+    // Gradient predictor: left + up - upper-left (left on the first row, up
+    // in the first column)
+    std::vector<uint32_t> residuals(count);
+    for (int r = 0; r < height; ++r) {
+        const uint32_t* row = symbols.data() + static_cast<size_t>(r) * width;
+        const uint32_t* up = r > 0 ? row - width : nullptr;
+        uint32_t* residual = residuals.data() + static_cast<size_t>(r) * width;
+        for (int c = 0; c < width; ++c) {
+            uint32_t prediction = 0;
+            if (up) {
+                prediction = c > 0 ? row[c - 1] + up[c] - up[c - 1] : up[c];
+            } else if (c > 0) {
+                prediction = row[c - 1];
+            }
+            residual[c] = zigzag(row[c] - prediction);
+        }
+    }
+
+    out.clear();
+    for (size_t begin = 0; begin < count; begin += BAKE_BLOCK) {
+        bake_pack_block(residuals.data() + begin, static_cast<int>(std::min<size_t>(BAKE_BLOCK, count - begin)), out);
+    }
+    out.resize(out.size() + BAKE_PADDING, 0);
+}
+
+/**
+ * Whether a tile blob of size bytes holds count cells of blocks no wider
+ * than 32 bits, followed by the unpacking padding
+ *
+ * bake_decode_tile trusts the block widths, so load() checks every tile.
+ */
+inline bool bake_tile_fits(const unsigned char* data, size_t size, size_t count) {
+    if (size < BAKE_PADDING) {
+        return false;
+    }
+    size_t limit = size - BAKE_PADDING;
+    size_t used = 0;
+    for (size_t begin = 0; begin < count; begin += BAKE_BLOCK) {
+        if (used >= limit) {
+            return false;
+        }
+        int bits = data[used++];
+        size_t block = std::min<size_t>(BAKE_BLOCK, count - begin);
+        size_t bytes = (block * bits + 7) / 8;
+        if (bits > 32 || bytes > limit - used) {
+            return false;
+        }
+        used += bytes;
+    }
+    return true;
+}
+
+/**
+ * Decompress one tile of one layer into width x height floats
+ *
+ * symbols is scratch space for width x height values. The blob must have
+ * passed bake_tile_fits.
+ */
+inline void bake_decode_tile(const LayerQuantization& quantization, const unsigned char* data,
+                             int width, int height, uint32_t* symbols, float* out) {
+    size_t count = static_cast<size_t>(width) * height;
+    const unsigned char* cursor = data;
+    for (size_t begin = 0; begin < count; begin += BAKE_BLOCK) {
+        int bits = std::min<int>(*cursor++, 32);
+        int block = static_cast<int>(std::min<size_t>(BAKE_BLOCK, count - begin));
+        if (block == BAKE_BLOCK) {
+            bake_unpack_full(bits, cursor, symbols + begin, std::make_index_sequence<33>());
+        } else {
+            bake_unpack_partial(bits, block, cursor, symbols + begin);
+        }
+        cursor += (static_cast<size_t>(block) * bits + 7) / 8;
+    }
+
+    // Undo the predictor and convert a row at a time while it is in cache;
+    // everything but the running left sum vectorizes
+    float offset = quantization.offset;
+    float step = quantization.step;
+    for (int r = 0; r < height; ++r) {
+        uint32_t* row = symbols + static_cast<size_t>(r) * width;
+        if (r == 0) {
+            for (int c = 0; c < width; ++c) {
+                row[c] = unzigzag(row[c]);
+            }
+        } else {
+            const uint32_t* up = row - width;
+            row[0] = unzigzag(row[0]) + up[0];
+            for (int c = 1; c < width; ++c) {
+                row[c] = unzigzag(row[c]) + up[c] - up[c - 1];
+            }
+        }
+        uint32_t sum = 0;
+        for (int c = 0; c < width; ++c) {
+            sum += row[c];
+            row[c] = sum;
+        }
+
+        float* values = out + static_cast<size_t>(r) * width;
+        switch (quantization.scheme) {
+            case QuantizationScheme::FLOAT32:
+                for (int c = 0; c < width; ++c) {
+                    uint32_t bits = row[c] & 0x80000000u ? row[c] & 0x7fffffffu : ~row[c];
+                    std::memcpy(&values[c], &bits, sizeof(bits));
+                }
+                break;
+            case QuantizationScheme::FLOAT16:
+                for (int c = 0; c < width; ++c) {
+                    uint32_t half = row[c] & 0x8000u ? row[c] & 0x7fffu : ~row[c] & 0xffffu;
+                    values[c] = half_to_float(static_cast<uint16_t>(half));
+                }
+                break;
+            default:
+                // Codes fit in 16 bits; the signed conversion is one instruction
+                for (int c = 0; c < width; ++c) {
+                    values[c] = offset + step * static_cast<float>(static_cast<int32_t>(row[c]));
+                }
+                break;
+        }
+    }
+}
+
+inline void bake_put(std::vector<unsigned char>& out, uint64_t value, int bytes) {
+    for (int i = 0; i < bytes; ++i) {
+        out.push_back(static_cast<unsigned char>(value >> (8 * i)));
+    }
+}
+
+inline void bake_put_float(std::vector<unsigned char>& out, float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    bake_put(out, bits, 4);
+}
+
+/**
+ * Little-endian reader over a loaded file; reads past the end fail
+ */
+struct BakeReader {
+    const unsigned char* data;
+    size_t size;
+    size_t position = 0;
+
+    bool get(uint64_t& value, int bytes) {
+        if (size - position < static_cast<size_t>(bytes)) {
+            return false;
+        }
+        value = 0;
+        for (int i = 0; i < bytes; ++i) {
+            value |= static_cast<uint64_t>(data[position++]) << (8 * i);
+        }
+        return true;
+    }
+
+    bool get_int(int& value) {
+        uint64_t raw;
+        if (!get(raw, 4)) {
+            return false;
+        }
+        value = static_cast<int>(static_cast<uint32_t>(raw));
+        return true;
+    }
+
+    bool get_float(float& value) {
+        uint64_t raw;
+        if (!get(raw, 4)) {
+            return false;
+        }
+        uint32_t bits = static_cast<uint32_t>(raw);
+        std::memcpy(&value, &bits, sizeof(value));
+        return true;
+    }
+};
+
+inline bool bake_fail(std::string* error, const std::string& message) {
+    if (error) {
+        *error = message;
+    }
+    return false;
+}
+
+} // namespace detail
+
+BakedWorld::~BakedWorld() {
+    release();
+}
+
+void BakedWorld::clear() {
+    release();
+    decoded_.reset();
+    types_.clear();
+    quantization_.clear();
+    index_.clear();
+    data_.clear();
+    tile_size_ = tile_columns_ = tile_rows_ = 0;
+}
+
+void BakedWorld::allocate_slots() {
+    decoded_.reset(new std::atomic<float*>[index_.size()]);
+    for (size_t i = 0; i < index_.size(); ++i) {
+        decoded_[i].store(nullptr, std::memory_order_relaxed);
+    }
+}
+
+void BakedWorld::release() {
+    if (!decoded_) {
+        return;
+    }
+    for (size_t i = 0; i < index_.size(); ++i) {
+        delete[] decoded_[i].exchange(nullptr);
+    }
+    decoded_bytes_ = 0;
+}
+
+bool BakedWorld::bake(const World& world, const BakeOptions& options, std::string* error) {
+    clear();
+    const GridRegion& region = options.region;
+    if (region.width <= 0 || region.height <= 0 || options.types.empty() || options.tile_size <= 0) {
+        return detail::bake_fail(error, "nothing to bake");
+    }
+    region_ = region;
+    types_ = options.types;
+    for (size_t i = 0; i < types_.size(); ++i) {
+        quantization_.push_back(i < options.quantization.size() ? options.quantization[i]
+                                                               : default_quantization(types_[i], world.get_config()));
+    }
+    tile_size_ = options.tile_size;
+    tile_columns_ = (region.width + tile_size_ - 1) / tile_size_;
+    tile_rows_ = (region.height + tile_size_ - 1) / tile_size_;
+    index_.resize(static_cast<size_t>(tile_columns_) * tile_rows_ * types_.size());
+
+    std::vector<std::vector<unsigned char>> blobs(static_cast<size_t>(tile_columns_) * types_.size());
+    for (int tile_row = 0; tile_row < tile_rows_; ++tile_row) {
+        int row = tile_row * tile_size_;
+        GridResult band = world.grid_query(region, types_, row, row + tile_height(tile_row));
+
+        // Tiles of a band compress independently
+        detail::parallel_for(static_cast<int>(blobs.size()), [&](int n) {
+            int tile_column = n / static_cast<int>(types_.size());
+            size_t layer = n % types_.size();
+            detail::bake_encode_tile(quantization_[layer],
+                                     band.layers[layer].data() + static_cast<size_t>(tile_column) * tile_size_,
+                                     region.width, tile_width(tile_column), band.rows, blobs[n]);
+        });
+        for (size_t n = 0; n < blobs.size(); ++n) {
+            TileRef& ref = index_[static_cast<size_t>(tile_row) * blobs.size() + n];
+            ref.offset = data_.size();
+            ref.size = static_cast<uint32_t>(blobs[n].size());
+            data_.insert(data_.end(), blobs[n].begin(), blobs[n].end());
+        }
+
+        if (options.progress) {
+            options.progress(row + band.rows, region.height);
+        }
+    }
+    allocate_slots();
+    return true;
+}
+
+bool BakedWorld::save(const std::string& path, std::string* error) const {
+    std::vector<unsigned char> header(detail::BAKE_MAGIC, detail::BAKE_MAGIC + sizeof(detail::BAKE_MAGIC));
+    detail::bake_put(header, static_cast<uint32_t>(region_.width), 4);
+    detail::bake_put(header, static_cast<uint32_t>(region_.height), 4);
+    detail::bake_put(header, static_cast<uint32_t>(region_.projection), 4);
+    for (float value : {region_.west, region_.south, region_.east, region_.north,
+                        region_.altitude, region_.current_time, region_.detail_level}) {
+        detail::bake_put_float(header, value);
+    }
+    detail::bake_put(header, static_cast<uint32_t>(tile_size_), 4);
+    detail::bake_put(header, types_.size(), 4);
+    for (size_t i = 0; i < types_.size(); ++i) {
+        detail::bake_put(header, static_cast<uint32_t>(types_[i]), 4);
+        detail::bake_put(header, static_cast<uint32_t>(quantization_[i].scheme), 4);
+        detail::bake_put_float(header, quantization_[i].offset);
+        detail::bake_put_float(header, quantization_[i].step);
+    }
+    for (const TileRef& ref : index_) {
+        detail::bake_put(header, ref.offset, 8);
+        detail::bake_put(header, ref.size, 4);
+    }
+
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        return detail::bake_fail(error, "cannot open " + path + " for writing");
+    }
+    bool written = std::fwrite(header.data(), 1, header.size(), file) == header.size() &&
+                   std::fwrite(data_.data(), 1, data_.size(), file) == data_.size();
+    if (std::fclose(file) != 0 || !written) {
+        return detail::bake_fail(error, "cannot write to " + path);
+    }
+    return true;
+}
+
+bool BakedWorld::load(const std::string& path, std::string* error) {
+    clear();
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file) {
+        return detail::bake_fail(error, "cannot open " + path);
+    }
+    std::vector<unsigned char> contents;
+    unsigned char buffer[1 << 16];
+    size_t got;
+    while ((got = std::fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        contents.insert(contents.end(), buffer, buffer + got);
+    }
+    std::fclose(file);
+
+    auto corrupt = [&]() {
+        clear();
+        return detail::bake_fail(error, path + " is not a baked world file");
+    };
+    if (contents.size() < sizeof(detail::BAKE_MAGIC) ||
+        std::memcmp(contents.data(), detail::BAKE_MAGIC, sizeof(detail::BAKE_MAGIC)) != 0) {
+        return corrupt();
+    }
+    detail::BakeReader reader{contents.data(), contents.size(), sizeof(detail::BAKE_MAGIC)};
+    int projection = 0;
+    int layers = 0;
+    if (!reader.get_int(region_.width) || !reader.get_int(region_.height) || !reader.get_int(projection) ||
+        !reader.get_float(region_.west) || !reader.get_float(region_.south) || !reader.get_float(region_.east) ||
+        !reader.get_float(region_.north) || !reader.get_float(region_.altitude) ||
+        !reader.get_float(region_.current_time) || !reader.get_float(region_.detail_level) ||
+        !reader.get_int(tile_size_) || !reader.get_int(layers) ||
+        region_.width <= 0 || region_.height <= 0 || tile_size_ <= 0 || layers <= 0) {
+        return corrupt();
+    }
+    region_.projection = static_cast<GridProjection>(projection);
+    for (int i = 0; i < layers; ++i) {
+        int type = 0;
+        int scheme = 0;
+        LayerQuantization quantization;
+        if (!reader.get_int(type) || !reader.get_int(scheme) || !reader.get_float(quantization.offset) ||
+            !reader.get_float(quantization.step) || type < 0 || type > static_cast<int>(DataType::IS_STORM_FRONT) ||
+            scheme < 0 || scheme > static_cast<int>(QuantizationScheme::FIXED4)) {
+            return corrupt();
+        }
+        quantization.scheme = static_cast<QuantizationScheme>(scheme);
+        types_.push_back(static_cast<DataType>(type));
+        quantization_.push_back(quantization);
+    }
+    // Widened so a huge width or tile size cannot overflow the rounding
+    tile_columns_ = static_cast<int>((static_cast<int64_t>(region_.width) + tile_size_ - 1) / tile_size_);
+    tile_rows_ = static_cast<int>((static_cast<int64_t>(region_.height) + tile_size_ - 1) / tile_size_);
+    // 12 bytes per index entry; checked before allocating the index
+    size_t tiles = static_cast<size_t>(tile_columns_) * static_cast<size_t>(tile_rows_);
+    if (tiles > (contents.size() - reader.position) / 12 / types_.size()) {
+        return corrupt();
+    }
+    index_.resize(tiles * types_.size());
+    for (TileRef& ref : index_) {
+        uint64_t size;
+        if (!reader.get(ref.offset, 8) || !reader.get(size, 4)) {
+            return corrupt();
+        }
+        ref.size = static_cast<uint32_t>(size);
+    }
+    size_t payload = contents.size() - reader.position;
+    for (size_t i = 0; i < index_.size(); ++i) {
+        // Every tile's blocks fit its blob, and it ends in the unpacking padding
+        const TileRef& ref = index_[i];
+        size_t tile_index = i / types_.size();  // Layers are innermost, as in slot()
+        size_t cells = static_cast<size_t>(tile_width(static_cast<int>(tile_index % tile_columns_))) *
+                       static_cast<size_t>(tile_height(static_cast<int>(tile_index / tile_columns_)));
+        if (ref.offset > payload || ref.size > payload - ref.offset ||
+            !detail::bake_tile_fits(contents.data() + reader.position + ref.offset, ref.size, cells)) {
+            return corrupt();
+        }
+    }
+    data_.assign(contents.begin() + reader.position, contents.end());
+    allocate_slots();
+    return true;
+}
+
+int BakedWorld::tile_width(int tile_column) const {
+    return std::min(tile_size_, region_.width - tile_column * tile_size_);
+}
+
+int BakedWorld::tile_height(int tile_row) const {
+    return std::min(tile_size_, region_.height - tile_row * tile_size_);
+}
+
+const float* BakedWorld::tile(size_t layer, int tile_column, int tile_row) const {
+    std::atomic<float*>& decoded = decoded_[slot(layer, tile_column, tile_row)];
+    float* cells = decoded.load(std::memory_order_acquire);
+    if (cells) {
+        return cells;
+    }
+
+    // Racing threads may both decode; the first to publish wins
+    int width = tile_width(tile_column);
+    int height = tile_height(tile_row);
+    size_t count = static_cast<size_t>(width) * height;
+    std::unique_ptr<float[]> fresh(new float[count]);
+    thread_local std::vector<uint32_t> symbols;
+    symbols.resize(std::max(symbols.size(), count));
+    const TileRef& ref = index_[slot(layer, tile_column, tile_row)];
+    detail::bake_decode_tile(quantization_[layer], data_.data() + ref.offset, width, height,
+                             symbols.data(), fresh.get());
+    float* expected = nullptr;
+    if (decoded.compare_exchange_strong(expected, fresh.get(), std::memory_order_acq_rel)) {
+        decoded_bytes_ += count * sizeof(float);
+        return fresh.release();
+    }
+    return expected;
+}
+
+float BakedWorld::value(size_t layer, int column, int row) const {
+    int tile_column = column / tile_size_;
+    int tile_row = row / tile_size_;
+    const float* cells = tile(layer, tile_column, tile_row);
+    return cells[static_cast<size_t>(row - tile_row * tile_size_) * tile_width(tile_column) +
+                 (column - tile_column * tile_size_)];
+}
+
+void BakedWorld::read(int row_begin, int row_end, GridResult& out) const {
+    row_begin = std::clamp(row_begin, 0, region_.height);
+    row_end = std::clamp(row_end, row_begin, region_.height);
+    out.width = region_.width;
+    out.row_begin = row_begin;
+    out.rows = row_end - row_begin;
+    out.layers.resize(types_.size());
+    for (size_t layer = 0; layer < types_.size(); ++layer) {
+        std::vector<float>& values = out.layers[layer];
+        values.resize(static_cast<size_t>(out.rows) * region_.width);
+        for (int row = row_begin; row < row_end; ++row) {
+            int tile_row = row / tile_size_;
+            for (int tile_column = 0; tile_column < tile_columns_; ++tile_column) {
+                int width = tile_width(tile_column);
+                const float* cells = tile(layer, tile_column, tile_row) +
+                                     static_cast<size_t>(row - tile_row * tile_size_) * width;
+                std::copy(cells, cells + width, values.data() + static_cast<size_t>(row - row_begin) * region_.width +
+                                                    static_cast<size_t>(tile_column) * tile_size_);
+            }
+        }
+    }
+}
+
+} // namespace rworld
+
+#endif // _RWORLD_IMPLEMENTATION
+#endif // RWORLD_BAKE_H
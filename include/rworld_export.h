@@ -0,0 +1,498 @@
+#ifndef RWORLD_EXPORT_H
+#define RWORLD_EXPORT_H
+
+#include "rworld.h"
+#include "rworld_quantize.h"
+
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace rworld {
+
+/**
+ * Raster encodings supported by the exporter
+ *
+ * Raw formats are headerless little-endian samples described by a JSON
+ * sidecar (<file>.json). PGM16 and PFM are self-describing images and get
+ * the same sidecar for their geographic bounds.
+ */
+enum class RasterFormat {
+    RAW_F32,   // float32, little-endian
+    RAW_U16,   // uint16 quantized over the layer range, little-endian
+    RAW_F16,   // IEEE half float, little-endian
+    RAW_U8,    // uint8 quantized over the layer range
+    PGM16,     // Binary 16-bit grayscale PGM (P5, big-endian samples)
+    PFM        // Grayscale portable float map (Pf, little-endian, bottom row first)
+};
+
+/**
+ * One output layer of an export
+ */
+struct ExportLayer {
+    DataType type = DataType::TERRAIN_HEIGHT;
+    std::string path;         // Output file; tiles insert _<column>_<row> before the extension
+    float range_min = 0.0f;   // Quantization range for 16- and 8-bit integer formats
+    float range_max = 0.0f;   // range_min == range_max picks default_export_range
+};
+
+/**
+ * Settings shared by all layers of an export
+ *
+ * Peak memory is roughly band_rows (or tile_size) rows x region.width x
+ * layer count x 8 bytes regardless of the total output size.
+ */
+struct ExportOptions {
+    GridRegion region;
+    RasterFormat format = RasterFormat::RAW_F32;
+    int tile_size = 0;    // Split each layer into tile_size x tile_size files (0 = one file)
+    int band_rows = 256;  // Rows computed and written per pass when not tiling
+    std::function<void(int rows_done, int rows_total)> progress; // Optional, called after each band
+};
+
+/**
+ * Default value range used to quantize a data type into 16 or 8 bits
+ */
+void default_export_range(DataType type, const WorldConfig& config, float& range_min, float& range_max);
+
+/**
+ * File extension (with leading dot) conventionally used for a format
+ */
+const char* raster_format_extension(RasterFormat format);
+
+/**
+ * Export one or more layers of a region as rasters
+ *
+ * Rows are computed band by band with World::grid_query (all layers share
+ * one query, in parallel) and each band is encoded and written with one
+ * large sequential write per file, so outputs far larger than RAM stream
+ * straight to disk.
+ *
+ * @param world World to sample
+ * @param options Region, format and streaming settings
+ * @param layers Data types and output paths
+ * @param error Receives a description when the export fails (may be null)
+ * @return true when every file was written
+ */
+bool export_rasters(const World& world, const ExportOptions& options,
+                    const std::vector<ExportLayer>& layers, std::string* error = nullptr);
+
+} // namespace rworld
+
+#ifdef _RWORLD_IMPLEMENTATION
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+#if defined(_WIN32)
+#define RWORLD_FSEEK _fseeki64
+#else
+#include <sys/types.h>
+#define RWORLD_FSEEK fseeko
+#endif
+
+namespace rworld {
+
+namespace detail {
+
+inline void store_u16_le(unsigned char* out, uint16_t value) {
+    out[0] = static_cast<unsigned char>(value & 0xff);
+    out[1] = static_cast<unsigned char>(value >> 8);
+}
+
+inline void store_u16_be(unsigned char* out, uint16_t value) {
+    out[0] = static_cast<unsigned char>(value >> 8);
+    out[1] = static_cast<unsigned char>(value & 0xff);
+}
+
+inline void store_f32_le(unsigned char* out, float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    out[0] = static_cast<unsigned char>(bits & 0xff);
+    out[1] = static_cast<unsigned char>((bits >> 8) & 0xff);
+    out[2] = static_cast<unsigned char>((bits >> 16) & 0xff);
+    out[3] = static_cast<unsigned char>(bits >> 24);
+}
+
+inline uint16_t quantize_u16(float value, float range_min, float range_max) {
+    float t = (value - range_min) / (range_max - range_min);
+    t = std::clamp(t, 0.0f, 1.0f);
+    return static_cast<uint16_t>(std::lround(t * 65535.0f));
+}
+
+inline uint8_t quantize_u8(float value, float range_min, float range_max) {
+    float t = (value - range_min) / (range_max - range_min);
+    t = std::clamp(t, 0.0f, 1.0f);
+    return static_cast<uint8_t>(std::lround(t * 255.0f));
+}
+
+inline size_t raster_sample_bytes(RasterFormat format) {
+    switch (format) {
+        case RasterFormat::RAW_F32:
+        case RasterFormat::PFM:
+            return 4;
+        case RasterFormat::RAW_U8:
+            return 1;
+        default:
+            return 2;
+    }
+}
+
+/**
+ * One raster file written in row bands
+ *
+ * Bands must arrive north to south. PFM stores its bottom row first, so its
+ * bands are flipped in memory and placed with a seek; every other format is
+ * appended sequentially.
+ */
+class RasterWriter {
+public:
+    RasterWriter() = default;
+    RasterWriter(const RasterWriter&) = delete;
+    RasterWriter& operator=(const RasterWriter&) = delete;
+
+    ~RasterWriter() {
+        if (file_) {
+            std::fclose(file_);
+        }
+    }
+
+    bool open(const std::string& path, RasterFormat format, int width, int height, std::string* error) {
+        format_ = format;
+        width_ = width;
+        height_ = height;
+        file_ = std::fopen(path.c_str(), "wb");
+        if (!file_) {
+            return fail(error, "cannot open " + path + " for writing");
+        }
+        path_ = path;
+
+        char header[64];
+        int header_length = 0;
+        if (format == RasterFormat::PGM16) {
+            header_length = std::snprintf(header, sizeof(header), "P5\n%d %d\n65535\n", width, height);
+        } else if (format == RasterFormat::PFM) {
+            header_length = std::snprintf(header, sizeof(header), "Pf\n%d %d\n-1.0\n", width, height);
+        }
+        if (header_length > 0 && std::fwrite(header, 1, header_length, file_) != static_cast<size_t>(header_length)) {
+            return fail(error, "cannot write header to " + path);
+        }
+        header_bytes_ = header_length;
+        return true;
+    }
+
+    // Encode rows [row_begin, row_begin + rows) from values (stride floats apart) and write them
+    bool write_rows(int row_begin, int rows, const float* values, size_t stride,
+                    float range_min, float range_max, std::string* error) {
+        size_t sample_bytes = raster_sample_bytes(format_);
+        size_t row_bytes = static_cast<size_t>(width_) * sample_bytes;
+        buffer_.resize(row_bytes * rows);
+
+        for (int r = 0; r < rows; ++r) {
+            // PFM bands are stored bottom row first
+            int slot = format_ == RasterFormat::PFM ? rows - 1 - r : r;
+            const float* src = values + static_cast<size_t>(r) * stride;
+            unsigned char* dst = buffer_.data() + static_cast<size_t>(slot) * row_bytes;
+            for (int c = 0; c < width_; ++c, dst += sample_bytes) {
+                switch (format_) {
+                    case RasterFormat::RAW_F32:
+                    case RasterFormat::PFM:
+                        store_f32_le(dst, src[c]);
+                        break;
+                    case RasterFormat::RAW_U16:
+                        store_u16_le(dst, quantize_u16(src[c], range_min, range_max));
+                        break;
+                    case RasterFormat::RAW_F16:
+                        store_u16_le(dst, float_to_half(src[c]));
+                        break;
+                    case RasterFormat::RAW_U8:
+                        *dst = quantize_u8(src[c], range_min, range_max);
+                        break;
+                    case RasterFormat::PGM16:
+                        store_u16_be(dst, quantize_u16(src[c], range_min, range_max));
+                        break;
+                }
+            }
+        }
+
+        if (format_ == RasterFormat::PFM) {
+            long long offset = header_bytes_ + static_cast<long long>(height_ - row_begin - rows) *
+                                               static_cast<long long>(row_bytes);
+            if (RWORLD_FSEEK(file_, offset, SEEK_SET) != 0) {
+                return fail(error, "cannot seek in " + path_);
+            }
+        }
+        if (std::fwrite(buffer_.data(), 1, buffer_.size(), file_) != buffer_.size()) {
+            return fail(error, "cannot write to " + path_);
+        }
+        return true;
+    }
+
+    bool close(std::string* error) {
+        if (!file_) {
+            return true;
+        }
+        int status = std::fclose(file_);
+        file_ = nullptr;
+        if (status != 0) {
+            return fail(error, "cannot finish writing " + path_);
+        }
+        return true;
+    }
+
+private:
+    static bool fail(std::string* error, const std::string& message) {
+        if (error) {
+            *error = message;
+        }
+        return false;
+    }
+
+    std::FILE* file_ = nullptr;
+    std::string path_;
+    RasterFormat format_ = RasterFormat::RAW_F32;
+    int width_ = 0;
+    int height_ = 0;
+    long long header_bytes_ = 0;
+    std::vector<unsigned char> buffer_;
+};
+
+// Path of tile (column, row): "dir/name.ext" becomes "dir/name_column_row.ext"
+inline std::string tile_path(const std::string& path, int column, int row) {
+    size_t slash = path.find_last_of("/\\");
+    size_t dot = path.find_last_of('.');
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) {
+        dot = path.size();
+    }
+    return path.substr(0, dot) + "_" + std::to_string(column) + "_" + std::to_string(row) + path.substr(dot);
+}
+
+inline const char* raster_format_name(RasterFormat format) {
+    switch (format) {
+        case RasterFormat::RAW_F32: return "f32le";
+        case RasterFormat::RAW_U16: return "u16le";
+        case RasterFormat::RAW_F16: return "f16le";
+        case RasterFormat::RAW_U8: return "u8";
+        case RasterFormat::PGM16: return "pgm16";
+        case RasterFormat::PFM: return "pfm";
+    }
+    return "unknown";
+}
+
+/**
+ * Write the JSON sidecar describing one raster file
+ *
+ * Bounds are the outer cell edges; 16-bit integer samples map linearly so
+ * that value = value_min + sample / 65535 * (value_max - value_min), and
+ * 8-bit samples likewise over 255.
+ */
+inline bool write_sidecar(const std::string& path, RasterFormat format, DataType type, int width, int height,
+                          float west, float south, float east, float north,
+                          float range_min, float range_max, std::string* error) {
+    std::string sidecar = path + ".json";
+    std::FILE* file = std::fopen(sidecar.c_str(), "w");
+    if (!file) {
+        if (error) {
+            *error = "cannot open " + sidecar + " for writing";
+        }
+        return false;
+    }
+    std::fprintf(file,
+                 "{\n"
+                 "  \"format\": \"%s\",\n"
+                 "  \"data_type\": \"%s\",\n"
+                 "  \"width\": %d,\n"
+                 "  \"height\": %d,\n"
+                 "  \"west\": %.9g,\n"
+                 "  \"south\": %.9g,\n"
+                 "  \"east\": %.9g,\n"
+                 "  \"north\": %.9g,\n"
+                 "  \"row_order\": \"%s\",\n"
+                 "  \"value_min\": %.9g,\n"
+                 "  \"value_max\": %.9g\n"
+                 "}\n",
+                 raster_format_name(format), data_type_to_string(type), width, height,
+                 west, south, east, north,
+                 format == RasterFormat::PFM ? "south_to_north" : "north_to_south",
+                 range_min, range_max);
+    if (std::fclose(file) != 0) {
+        if (error) {
+            *error = "cannot finish writing " + sidecar;
+        }
+        return false;
+    }
+    return true;
+}
+
+} // namespace detail
+
+void default_export_range(DataType type, const WorldConfig& config, float& range_min, float& range_max) {
+    range_min = 0.0f;
+    range_max = 1.0f;
+    switch (type) {
+        case DataType::TERRAIN_HEIGHT:
+            range_min = -4000.0f;
+            range_max = config.max_terrain_height + 3000.0f; // Volcano cones sit on top
+            break;
+        case DataType::TEMPERATURE:
+        case DataType::TEMPERATURE_AT_TIME:
+            range_min = -80.0f;
+            range_max = 60.0f;
+            break;
+        case DataType::PRECIPITATION:
+            range_max = 4000.0f;
+            break;
+        case DataType::AIR_PRESSURE:
+            range_max = 1100.0f;
+            break;
+        case DataType::PRESSURE_AT_LOCATION:
+            range_min = 900.0f;
+            range_max = 1100.0f;
+            break;
+        case DataType::PRESSURE_GRADIENT:
+            range_max = 10.0f;
+            break;
+        case DataType::WIND_SPEED:
+        case DataType::CURRENT_WIND_SPEED:
+            range_max = 100.0f;
+            break;
+        case DataType::WIND_DIRECTION:
+        case DataType::CURRENT_WIND_DIRECTION:
+            range_max = 360.0f;
+            break;
+        case DataType::RIVER_WIDTH:
+            range_max = 500.0f;
+            break;
+        case DataType::INSOLATION:
+            range_max = 1400.0f;
+            break;
+        case DataType::SOLAR_ANGLE:
+            range_min = -90.0f;
+            range_max = 90.0f;
+            break;
+        case DataType::SOIL_PH:
+            range_max = 14.0f;
+            break;
+        case DataType::BIOME:
+            range_max = static_cast<float>(BiomeType::MOUNTAIN_PEAK);
+            break;
+        case DataType::PRECIPITATION_TYPE:
+            range_max = static_cast<float>(PrecipitationType::SLEET);
+            break;
+        case DataType::SOIL_TYPE:
+            range_max = static_cast<float>(SoilType::NONE);
+            break;
+        default:
+            break;
+    }
+}
+
+const char* raster_format_extension(RasterFormat format) {
+    switch (format) {
+        case RasterFormat::RAW_F32: return ".f32";
+        case RasterFormat::RAW_U16: return ".u16";
+        case RasterFormat::RAW_F16: return ".f16";
+        case RasterFormat::RAW_U8: return ".u8";
+        case RasterFormat::PGM16: return ".pgm";
+        case RasterFormat::PFM: return ".pfm";
+    }
+    return ".raw";
+}
+
+bool export_rasters(const World& world, const ExportOptions& options,
+                    const std::vector<ExportLayer>& layers, std::string* error) {
+    const GridRegion& region = options.region;
+    if (region.width <= 0 || region.height <= 0 || layers.empty()) {
+        if (error) {
+            *error = "nothing to export";
+        }
+        return false;
+    }
+
+    std::vector<DataType> types;
+    std::vector<float> range_min(layers.size());
+    std::vector<float> range_max(layers.size());
+    for (size_t i = 0; i < layers.size(); ++i) {
+        types.push_back(layers[i].type);
+        range_min[i] = layers[i].range_min;
+        range_max[i] = layers[i].range_max;
+        if (range_min[i] == range_max[i]) {
+            default_export_range(layers[i].type, world.get_config(), range_min[i], range_max[i]);
+        }
+    }
+
+    // Outer edge of column c / row r; cell centers sit halfway between
+    auto edge_longitude = [&](int column) {
+        return region.west + static_cast<float>(column) * (region.east - region.west) / static_cast<float>(region.width);
+    };
+    auto edge_latitude = [&](int row) {
+        return std::clamp(region.edge_latitude(row), -90.0f, 90.0f);
+    };
+
+    int tile = options.tile_size > 0 ? options.tile_size : 0;
+    int band_rows = tile > 0 ? tile : std::max(1, options.band_rows);
+    int tile_columns = tile > 0 ? (region.width + tile - 1) / tile : 1;
+
+    // Untiled exports keep one writer per layer open for the whole run
+    std::vector<std::unique_ptr<detail::RasterWriter>> writers(layers.size());
+    if (tile == 0) {
+        for (size_t i = 0; i < layers.size(); ++i) {
+            writers[i].reset(new detail::RasterWriter());
+            if (!writers[i]->open(layers[i].path, options.format, region.width, region.height, error) ||
+                !detail::write_sidecar(layers[i].path, options.format, layers[i].type, region.width, region.height,
+                                       region.west, region.south, region.east, region.north,
+                                       range_min[i], range_max[i], error)) {
+                return false;
+            }
+        }
+    }
+
+    for (int row = 0; row < region.height; row += band_rows) {
+        int row_end = std::min(row + band_rows, region.height);
+        GridResult band = world.grid_query(region, types, row, row_end);
+
+        for (size_t i = 0; i < layers.size(); ++i) {
+            const float* values = band.layers[i].data();
+            if (tile == 0) {
+                if (!writers[i]->write_rows(row, band.rows, values, region.width, range_min[i], range_max[i], error)) {
+                    return false;
+                }
+                continue;
+            }
+
+            for (int tx = 0; tx < tile_columns; ++tx) {
+                int column = tx * tile;
+                int tile_width = std::min(tile, region.width - column);
+                std::string path = detail::tile_path(layers[i].path, tx, row / tile);
+                detail::RasterWriter writer;
+                if (!writer.open(path, options.format, tile_width, band.rows, error) ||
+                    !writer.write_rows(0, band.rows, values + column, region.width, range_min[i], range_max[i], error) ||
+                    !writer.close(error) ||
+                    !detail::write_sidecar(path, options.format, layers[i].type, tile_width, band.rows,
+                                           edge_longitude(column), edge_latitude(row_end),
+                                           edge_longitude(column + tile_width), edge_latitude(row),
+                                           range_min[i], range_max[i], error)) {
+                    return false;
+                }
+            }
+        }
+
+        if (options.progress) {
+            options.progress(row_end, region.height);
+        }
+    }
+
+    for (auto& writer : writers) {
+        if (writer && !writer->close(error)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace rworld
+
+#undef RWORLD_FSEEK
+#endif // _RWORLD_IMPLEMENTATION
+#endif // RWORLD_EXPORT_H
@@ -0,0 +1,320 @@
+#ifndef RWORLD_PROGRESSIVE_H
+#define RWORLD_PROGRESSIVE_H
+
+#include "rworld.h"
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace rworld {
+
+/**
+ * Progress of one refinement pass
+ */
+struct ProgressivePass {
+    int step = 1;          // Samples are step cells apart (1 = full resolution)
+    bool final = false;    // Last pass of this render
+    size_t samples = 0;    // Cells sampled by this pass
+    double elapsed = 0.0;  // Seconds since start()
+};
+
+/**
+ * Renders a grid query coarse-to-fine on a background thread
+ *
+ * Interactive views (map panning and zooming) cannot wait for a full grid
+ * query before showing anything. Each render first samples every
+ * coarsest_step-th cell in both directions, then halves the step until it
+ * reaches full resolution: 1/8, 1/4, 1/2, 1 by default. Cells sampled by an
+ * earlier pass are kept, so the passes together cost one full grid query.
+ * After each pass the callback receives the complete grid with unsampled
+ * cells filled from the sample above and to the left of them.
+ *
+ * Calling start() again, or cancel(), abandons the render in flight at the
+ * next row. The World must outlive the renderer and must not be
+ * reconfigured while a render runs (cancel() first).
+ *
+ * ```cpp
+ * ProgressiveGridRenderer renderer(world);
+ * renderer.start(region, {DataType::BIOME}, [&](const GridResult& grid, const ProgressivePass& pass) {
+ *     // Copy or color grid.layers[0]; runs on the renderer thread
+ * });
+ * ```
+ */
+class ProgressiveGridRenderer {
+public:
+    /**
+     * Called after every pass from the renderer thread
+     *
+     * The grid is only valid during the call. It must not call start(),
+     * cancel() or wait() on the same renderer.
+     */
+    using PassCallback = std::function<void(const GridResult& grid, const ProgressivePass& pass)>;
+
+    /**
+     * @param world World to sample
+     * @param coarsest_step Cell spacing of the first pass (rounded down to a power of two)
+     */
+    explicit ProgressiveGridRenderer(const World& world, int coarsest_step = 8);
+    ~ProgressiveGridRenderer();
+
+    ProgressiveGridRenderer(const ProgressiveGridRenderer&) = delete;
+    ProgressiveGridRenderer& operator=(const ProgressiveGridRenderer&) = delete;
+
+    /**
+     * Begin rendering a grid, replacing any render in flight
+     *
+     * Returns immediately. Once it returns, no callback from an earlier
+     * render runs.
+     */
+    void start(const GridRegion& region, const std::vector<DataType>& data_types, PassCallback on_pass);
+
+    /**
+     * Stop the render in flight and wait for the renderer thread to go idle
+     */
+    void cancel();
+
+    /**
+     * Block until the current render has finished or been cancelled
+     *
+     * Rethrows an exception raised while rendering or in the callback.
+     */
+    void wait();
+
+    /**
+     * True while a render is queued or running
+     */
+    bool busy() const;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> pimpl_;
+};
+
+} // namespace rworld
+
+#ifdef _RWORLD_IMPLEMENTATION
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+namespace rworld {
+
+class ProgressiveGridRenderer::Impl {
+public:
+    struct Job {
+        GridRegion region;
+        std::vector<DataType> types;
+        PassCallback on_pass;
+        uint64_t generation = 0;
+        std::chrono::steady_clock::time_point started;
+    };
+
+    const World& world;
+    int coarsest_step;
+
+    std::atomic<uint64_t> generation{0};
+    std::mutex mutex;              // Guards the fields below
+    std::condition_variable wake;  // Signals a new job or shutdown
+    std::condition_variable idle;  // Signals the renderer thread went idle
+    Job job;
+    bool queued = false;
+    bool running = false;
+    bool stopping = false;
+    std::exception_ptr failure;
+    std::mutex callback_mutex;     // Held while a callback runs
+    std::thread thread;
+
+    Impl(const World& w, int step) : world(w), coarsest_step(1) {
+        while (coarsest_step * 2 <= step) {
+            coarsest_step *= 2;
+        }
+        thread = std::thread([this]() { loop(); });
+    }
+
+    ~Impl() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+            generation++;
+        }
+        wake.notify_all();
+        thread.join();
+    }
+
+    void loop() {
+        for (;;) {
+            Job current;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [this]() { return stopping || queued; });
+                if (stopping) {
+                    return;
+                }
+                current = std::move(job);
+                queued = false;
+                running = true;
+            }
+
+            std::exception_ptr error;
+            try {
+                render(current);
+            } catch (...) {
+                error = std::current_exception();
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                running = false;
+                if (error && current.generation == generation) {
+                    failure = error;
+                }
+            }
+            idle.notify_all();
+        }
+    }
+
+    bool cancelled(const Job& current) const {
+        return generation.load() != current.generation;
+    }
+
+    void render(const Job& current) {
+        const GridRegion& region = current.region;
+        int width = std::max(region.width, 0);
+        int height = std::max(region.height, 0);
+
+        GridResult grid;
+        grid.width = width;
+        grid.rows = height;
+        size_t cells = static_cast<size_t>(width) * static_cast<size_t>(height);
+        grid.layers.assign(current.types.size(), std::vector<float>(cells));
+        if (cells == 0 || current.types.empty()) {
+            return;
+        }
+
+        detail::BatchLayout layout(current.types);
+        for (int step = coarsest_step, previous = 0; step >= 1; previous = step, step /= 2) {
+            // Sample the new lattice points; those on the previous lattice are kept
+            int sample_rows = (height + step - 1) / step;
+            std::atomic<size_t> samples(0);
+            detail::parallel_for(sample_rows, [&](int index) {
+                if (cancelled(current)) {
+                    return;
+                }
+                int row = index * step;
+                // Rows already on the previous lattice only need the odd multiples of step
+                bool reused_row = previous > 0 && row % previous == 0;
+                int first = reused_row ? step : 0;
+                int stride = reused_row ? previous : step;
+                std::vector<int> columns;
+                std::vector<Location> locations;
+                float latitude = detail::grid_latitude(region, row);
+                for (int column = first; column < width; column += stride) {
+                    columns.push_back(column);
+                    locations.emplace_back(detail::grid_longitude(region, column), latitude, region.altitude,
+                                           region.current_time, region.detail_level);
+                }
+                if (locations.empty()) {
+                    return;
+                }
+
+                BatchResult batch = world.batch_query(locations, current.types);
+                std::vector<float> values(locations.size());
+                size_t offset = static_cast<size_t>(row) * static_cast<size_t>(width);
+                for (size_t i = 0; i < current.types.size(); ++i) {
+                    layout.extract(batch, i, values.data());
+                    float* out = grid.layers[i].data() + offset;
+                    for (size_t k = 0; k < columns.size(); ++k) {
+                        out[columns[k]] = values[k];
+                    }
+                }
+                samples += locations.size();
+            });
+            if (cancelled(current)) {
+                return;
+            }
+
+            // Fill the cells between lattice points from their top-left sample
+            if (step > 1) {
+                detail::parallel_for(height, [&](int row) {
+                    size_t source_row = static_cast<size_t>(row - row % step) * static_cast<size_t>(width);
+                    size_t target_row = static_cast<size_t>(row) * static_cast<size_t>(width);
+                    for (std::vector<float>& layer : grid.layers) {
+                        for (int column = 0; column < width; ++column) {
+                            if (row % step != 0 || column % step != 0) {
+                                layer[target_row + column] = layer[source_row + column - column % step];
+                            }
+                        }
+                    }
+                });
+            }
+
+            ProgressivePass pass;
+            pass.step = step;
+            pass.final = step == 1;
+            pass.samples = samples;
+            pass.elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - current.started).count();
+
+            std::lock_guard<std::mutex> lock(callback_mutex);
+            if (cancelled(current)) {
+                return;
+            }
+            if (current.on_pass) {
+                current.on_pass(grid, pass);
+            }
+        }
+    }
+};
+
+ProgressiveGridRenderer::ProgressiveGridRenderer(const World& world, int coarsest_step)
+    : pimpl_(std::make_unique<Impl>(world, coarsest_step)) {}
+
+ProgressiveGridRenderer::~ProgressiveGridRenderer() = default;
+
+void ProgressiveGridRenderer::start(const GridRegion& region, const std::vector<DataType>& data_types,
+                                    PassCallback on_pass) {
+    // Taking the callback lock waits out a callback of the previous render
+    std::lock_guard<std::mutex> callback_lock(pimpl_->callback_mutex);
+    {
+        std::lock_guard<std::mutex> lock(pimpl_->mutex);
+        pimpl_->job.region = region;
+        pimpl_->job.types = data_types;
+        pimpl_->job.on_pass = std::move(on_pass);
+        pimpl_->job.generation = ++pimpl_->generation;
+        pimpl_->job.started = std::chrono::steady_clock::now();
+        pimpl_->queued = true;
+        pimpl_->failure = nullptr;
+    }
+    pimpl_->wake.notify_one();
+}
+
+void ProgressiveGridRenderer::cancel() {
+    std::unique_lock<std::mutex> lock(pimpl_->mutex);
+    pimpl_->generation++;
+    pimpl_->queued = false;
+    pimpl_->idle.wait(lock, [this]() { return !pimpl_->running; });
+}
+
+void ProgressiveGridRenderer::wait() {
+    std::unique_lock<std::mutex> lock(pimpl_->mutex);
+    pimpl_->idle.wait(lock, [this]() { return !pimpl_->queued && !pimpl_->running; });
+    if (pimpl_->failure) {
+        std::exception_ptr failure = pimpl_->failure;
+        pimpl_->failure = nullptr;
+        std::rethrow_exception(failure);
+    }
+}
+
+bool ProgressiveGridRenderer::busy() const {
+    std::lock_guard<std::mutex> lock(pimpl_->mutex);
+    return pimpl_->queued || pimpl_->running;
+}
+
+} // namespace rworld
+
+#endif // _RWORLD_IMPLEMENTATION
+#endif // RWORLD_PROGRESSIVE_H
@@ -0,0 +1,1021 @@
+#ifndef RWORLD_PROTOCOL_H
+#define RWORLD_PROTOCOL_H
+
+#include "rworld.h"
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace rworld {
+
+/**
+ * Binary protocol of rworld_server
+ *
+ * Every message is a fixed 24-byte header followed by a payload. Client and
+ * server share a host (Unix domain socket), so fields use native byte
+ * order; the magic numbers catch a mismatch. Requests carry an id chosen by
+ * the client and responses echo it, so a client may pipeline any number of
+ * requests and match responses as they arrive, in any order.
+ *
+ * BATCH_QUERY request payload (columnar, every section padded to 4 bytes):
+ *   uint8  data_types[type_count]
+ *   float  longitude[n], latitude[n], altitude[n], current_time[n], detail_level[n]
+ *
+ * BATCH_QUERY response payload: one column of n values per requested type,
+ * in request order; float32 for continuous types, uint8 for enum and
+ * boolean types (each column padded to 4 bytes).
+ *
+ * GRID_QUERY request payload: uint8 data_types[type_count] (padded), then a
+ * GridRegionWire. The response payload is one float32 layer of width x
+ * height values per type: the layers of a GridResult, back to back.
+ *
+ * OR-ing SHARED_MEMORY into a request's type asks for the response payload
+ * in shared memory. The response header then arrives with a sealed,
+ * read-only memfd attached (SCM_RIGHTS) holding payload_bytes bytes, and no
+ * inline payload follows. The socket message is the completion signal, so
+ * no futex or eventfd is needed. Small payloads, and servers without memfd,
+ * are answered inline; clients detect that by the missing descriptor.
+ *
+ * INFO has an empty request payload; the response is an InfoPayload.
+ * Failed requests (status != OK) carry an error message as payload.
+ */
+namespace protocol {
+
+const uint32_t REQUEST_MAGIC = 0x31515752;   // "RWQ1"
+const uint32_t RESPONSE_MAGIC = 0x31525752;  // "RWR1"
+const size_t HEADER_BYTES = 24;
+const uint32_t SHARED_MEMORY = 0x100;        // Request flag, OR-ed into RequestHeader::type
+const uint64_t MAX_ERROR_BYTES = 1 << 16;    // Longest error message a client accepts
+
+enum class MessageType : uint32_t {
+    BATCH_QUERY = 1,
+    INFO = 2,
+    GRID_QUERY = 3
+};
+
+enum class Status : uint32_t {
+    OK = 0,
+    BAD_REQUEST = 1,   // Malformed or oversized request
+    SERVER_ERROR = 2   // The query threw
+};
+
+struct RequestHeader {
+    uint32_t magic = REQUEST_MAGIC;
+    uint32_t type = 0;            // MessageType, plus flags
+    uint64_t id = 0;
+    uint32_t location_count = 0;  // BATCH_QUERY only
+    uint32_t type_count = 0;
+};
+
+struct ResponseHeader {
+    uint32_t magic = RESPONSE_MAGIC;
+    uint32_t status = 0;          // Status
+    uint64_t id = 0;
+    uint64_t payload_bytes = 0;
+};
+
+struct InfoPayload {
+    uint64_t seed = 0;
+    int32_t day_of_year = 0;
+    uint32_t max_locations = 0;   // Largest batch (or grid, in cells) the server accepts
+};
+
+struct GridRegionWire {
+    float west = 0.0f;
+    float south = 0.0f;
+    float east = 0.0f;
+    float north = 0.0f;
+    int32_t width = 0;
+    int32_t height = 0;
+    float altitude = 0.0f;
+    float current_time = 0.0f;
+    float detail_level = 0.0f;
+    uint32_t projection = 0;      // GridProjection
+};
+
+static_assert(sizeof(RequestHeader) == HEADER_BYTES, "request header layout");
+static_assert(sizeof(ResponseHeader) == HEADER_BYTES, "response header layout");
+static_assert(sizeof(GridRegionWire) == 40, "grid region layout");
+
+inline MessageType message_type(const RequestHeader& header) {
+    return static_cast<MessageType>(header.type & 0xff);
+}
+
+GridRegionWire to_wire(const GridRegion& region);
+GridRegion from_wire(const GridRegionWire& wire);
+
+/**
+ * True for data types sent as one byte per value in batch responses
+ */
+bool is_byte_column(DataType type);
+
+/**
+ * Payload size of a request, from its header
+ */
+uint64_t request_payload_bytes(const RequestHeader& header);
+
+/**
+ * Payload size of a response with count values per type (grid responses
+ * are all float32)
+ */
+uint64_t result_payload_bytes(size_t count, const std::vector<DataType>& data_types, bool grid);
+
+/**
+ * Append a BATCH_QUERY request (header and payload) to out
+ *
+ * @param flags 0 or SHARED_MEMORY
+ */
+void encode_batch_request(uint64_t id, const std::vector<Location>& locations,
+                          const std::vector<DataType>& data_types, std::vector<char>& out, uint32_t flags = 0);
+
+/**
+ * Parse a BATCH_QUERY payload
+ *
+ * @return false (with a message in error) if a data type is unknown
+ */
+bool decode_batch_request(const RequestHeader& header, const char* payload, std::vector<Location>& locations,
+                          std::vector<DataType>& data_types, std::string* error = nullptr);
+
+/**
+ * Append a GRID_QUERY request (header and payload) to out
+ */
+void encode_grid_request(uint64_t id, const GridRegion& region, const std::vector<DataType>& data_types,
+                         std::vector<char>& out, uint32_t flags = 0);
+
+/**
+ * Parse a GRID_QUERY payload
+ */
+bool decode_grid_request(const RequestHeader& header, const char* payload, GridRegion& region,
+                         std::vector<DataType>& data_types, std::string* error = nullptr);
+
+/**
+ * Write the response payload for a batch result to out, which must hold
+ * result_payload_bytes(result.count, data_types, false) bytes
+ */
+void encode_batch_result(const BatchResult& result, const std::vector<DataType>& data_types, char* out);
+
+/**
+ * Append the response payload for a batch result to out
+ */
+void encode_batch_result(const BatchResult& result, const std::vector<DataType>& data_types, std::vector<char>& out);
+
+/**
+ * Rebuild a BatchResult, identical to World::batch_query, from a response
+ * payload
+ */
+bool decode_batch_result(const char* payload, uint64_t bytes, size_t count, const std::vector<DataType>& data_types,
+                         BatchResult& result, std::string* error = nullptr);
+
+} // namespace protocol
+
+/**
+ * Response payload delivered through shared memory (or inline as a fallback)
+ *
+ * Columns point straight into the pages the server wrote; a 100 MB raster
+ * crosses the process boundary without being copied. The mapping is
+ * read-only and the server sealed it, so it cannot change underneath.
+ * Move only; the view stays valid until the object is destroyed or reused.
+ */
+class SharedResult {
+public:
+    SharedResult() = default;
+    ~SharedResult();
+    SharedResult(SharedResult&& other) noexcept;
+    SharedResult& operator=(SharedResult&& other) noexcept;
+    SharedResult(const SharedResult&) = delete;
+    SharedResult& operator=(const SharedResult&) = delete;
+
+    bool valid() const { return data_ != nullptr || size_ == 0; }
+
+    /**
+     * Values per column: locations of a batch, or width x height of a grid
+     */
+    size_t count() const { return count_; }
+
+    const std::vector<DataType>& data_types() const { return types_; }
+
+    /**
+     * Column of a float32 type, or nullptr for a byte column
+     */
+    const float* floats(size_t column) const;
+
+    /**
+     * Column of an enum or boolean type in a batch, or nullptr
+     */
+    const uint8_t* bytes(size_t column) const;
+
+    /**
+     * True when the payload is mapped shared memory rather than a copy
+     */
+    bool mapped() const { return mapped_; }
+
+private:
+    friend class WorldClient;
+    void reset();
+
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+    bool mapped_ = false;
+    std::vector<char> copy_;       // Inline fallback
+    size_t count_ = 0;
+    std::vector<DataType> types_;
+    std::vector<size_t> offsets_;  // Byte offset of each column
+    std::vector<bool> byte_;       // Column is uint8
+};
+
+/**
+ * Client of rworld_server (POSIX only)
+ *
+ * Blocking and not thread safe; use one client per thread. For pipelining,
+ * send several requests with send_batch() and collect them with receive().
+ * The other queries wait for their own response and must not be mixed with
+ * pipelined requests in flight.
+ *
+ * ```cpp
+ * WorldClient client;
+ * std::string error;
+ * if (!client.connect("/tmp/rworld.sock", &error)) { ... }
+ * BatchResult result;
+ * client.batch_query(locations, {DataType::BIOME}, result, &error);
+ *
+ * SharedResult heights;  // Zero-copy
+ * client.grid_query_shared(region, {DataType::TERRAIN_HEIGHT}, heights, &error);
+ * const float* row0 = heights.floats(0);
+ * ```
+ */
+class WorldClient {
+public:
+    WorldClient() = default;
+    ~WorldClient();
+
+    WorldClient(const WorldClient&) = delete;
+    WorldClient& operator=(const WorldClient&) = delete;
+
+    bool connect(const std::string& socket_path, std::string* error = nullptr);
+    void close();
+    bool connected() const { return fd_ >= 0; }
+
+    /**
+     * Send a batch query without waiting for the answer
+     *
+     * @return Request id to match in receive(), or 0 on failure
+     */
+    uint64_t send_batch(const std::vector<Location>& locations, const std::vector<DataType>& data_types,
+                        std::string* error = nullptr);
+
+    /**
+     * Wait for the next response to a send_batch() request
+     *
+     * @param id Receives the request id the response belongs to
+     * @return false on a connection error or a failed request (id is still set for the latter)
+     */
+    bool receive(uint64_t& id, BatchResult& result, std::string* error = nullptr);
+
+    /**
+     * send_batch() and wait for its response (earlier pipelined responses
+     * must have been received first)
+     */
+    bool batch_query(const std::vector<Location>& locations, const std::vector<DataType>& data_types,
+                     BatchResult& result, std::string* error = nullptr);
+
+    /**
+     * Batch query answered in shared memory
+     */
+    bool batch_query_shared(const std::vector<Location>& locations, const std::vector<DataType>& data_types,
+                            SharedResult& result, std::string* error = nullptr);
+
+    /**
+     * Grid query, copied into a GridResult
+     */
+    bool grid_query(const GridRegion& region, const std::vector<DataType>& data_types, GridResult& result,
+                    std::string* error = nullptr);
+
+    /**
+     * Grid query answered in shared memory; floats(i) is layer i, row-major
+     */
+    bool grid_query_shared(const GridRegion& region, const std::vector<DataType>& data_types,
+                           SharedResult& result, std::string* error = nullptr);
+
+    /**
+     * Seed and day of the served world
+     */
+    bool info(protocol::InfoPayload& info, std::string* error = nullptr);
+
+private:
+    bool send_all(const std::vector<char>& data, std::string* error);
+    bool receive_all(char* data, size_t bytes, std::string* error, int* descriptor = nullptr);
+
+    // Close an attached descriptor, if any, and set it to -1
+    static void close_descriptor(int& descriptor);
+
+    // Send one request and wait for its response of expected bytes; memfd
+    // receives an attached descriptor (or -1, with the payload inline),
+    // which the caller owns only when this succeeds
+    bool exchange(const std::vector<char>& message, uint64_t id, uint64_t expected, std::vector<char>& payload,
+                  int& memfd, std::string* error);
+
+    // Map or copy a response payload into result
+    bool share(const std::vector<DataType>& data_types, size_t count, bool grid, std::vector<char>& payload,
+               int memfd, SharedResult& result, std::string* error);
+
+    int fd_ = -1;
+    uint64_t next_id_ = 1;
+    std::map<uint64_t, std::pair<size_t, std::vector<DataType>>> in_flight_;  // id -> count, types
+};
+
+} // namespace rworld
+
+#ifdef _RWORLD_IMPLEMENTATION
+#include <cerrno>
+#include <cstring>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#define RWORLD_HAS_UNIX_SOCKETS 1
+#endif
+
+namespace rworld {
+
+namespace detail {
+
+// Protocol sections are padded to 4 bytes
+inline size_t protocol_padded(size_t bytes) {
+    return (bytes + 3) & ~static_cast<size_t>(3);
+}
+
+inline void protocol_append(std::vector<char>& out, const void* data, size_t bytes) {
+    const char* begin = static_cast<const char*>(data);
+    out.insert(out.end(), begin, begin + bytes);
+}
+
+inline void protocol_pad(std::vector<char>& out) {
+    out.resize(protocol_padded(out.size()), 0);
+}
+
+inline void protocol_append_header(std::vector<char>& out, protocol::MessageType type, uint32_t flags, uint64_t id,
+                                   size_t location_count, const std::vector<DataType>& data_types) {
+    protocol::RequestHeader header;
+    header.type = static_cast<uint32_t>(type) | flags;
+    header.id = id;
+    header.location_count = static_cast<uint32_t>(location_count);
+    header.type_count = static_cast<uint32_t>(data_types.size());
+    protocol_append(out, &header, sizeof(header));
+    for (DataType type : data_types) {
+        out.push_back(static_cast<char>(type));
+    }
+    protocol_pad(out);
+}
+
+inline bool protocol_decode_types(const protocol::RequestHeader& header, const char* payload,
+                                  std::vector<DataType>& data_types, std::string* error) {
+    data_types.resize(header.type_count);
+    for (uint32_t i = 0; i < header.type_count; ++i) {
+        uint8_t value = static_cast<uint8_t>(payload[i]);
+        if (value > static_cast<uint8_t>(DataType::IS_STORM_FRONT)) {
+            if (error) {
+                *error = "unknown data type " + std::to_string(value);
+            }
+            return false;
+        }
+        data_types[i] = static_cast<DataType>(value);
+    }
+    return true;
+}
+
+// Offset of each response column; returns the payload size
+inline size_t protocol_column_offsets(size_t count, const std::vector<DataType>& data_types, bool grid,
+                                      std::vector<size_t>& offsets, std::vector<bool>& byte) {
+    offsets.resize(data_types.size());
+    byte.resize(data_types.size());
+    size_t total = 0;
+    for (size_t i = 0; i < data_types.size(); ++i) {
+        offsets[i] = total;
+        byte[i] = !grid && protocol::is_byte_column(data_types[i]);
+        total += byte[i] ? protocol_padded(count) : count * sizeof(float);
+    }
+    return total;
+}
+
+// A successful response carries exactly the expected payload and a failed
+// one a short message; checked before anything is allocated for it
+inline bool protocol_payload_allowed(const protocol::ResponseHeader& header, uint64_t expected) {
+    if (header.magic != protocol::RESPONSE_MAGIC) {
+        return false;
+    }
+    if (header.status == static_cast<uint32_t>(protocol::Status::OK)) {
+        return header.payload_bytes == expected;
+    }
+    return header.payload_bytes <= protocol::MAX_ERROR_BYTES;
+}
+
+} // namespace detail
+
+namespace protocol {
+
+GridRegionWire to_wire(const GridRegion& region) {
+    GridRegionWire wire;
+    wire.west = region.west;
+    wire.south = region.south;
+    wire.east = region.east;
+    wire.north = region.north;
+    wire.width = region.width;
+    wire.height = region.height;
+    wire.altitude = region.altitude;
+    wire.current_time = region.current_time;
+    wire.detail_level = region.detail_level;
+    wire.projection = static_cast<uint32_t>(region.projection);
+    return wire;
+}
+
+GridRegion from_wire(const GridRegionWire& wire) {
+    GridRegion region;
+    region.west = wire.west;
+    region.south = wire.south;
+    region.east = wire.east;
+    region.north = wire.north;
+    region.width = wire.width;
+    region.height = wire.height;
+    region.altitude = wire.altitude;
+    region.current_time = wire.current_time;
+    region.detail_level = wire.detail_level;
+    region.projection = wire.projection == static_cast<uint32_t>(GridProjection::WEB_MERCATOR)
+                            ? GridProjection::WEB_MERCATOR : GridProjection::EQUIRECTANGULAR;
+    return region;
+}
+
+bool is_byte_column(DataType type) {
+    bool byte = false;
+    BatchResult probe;
+    detail::visit_batch_column(probe, type, [&](const auto& column) {
+        using Value = typename std::decay_t<decltype(column)>::value_type;
+        byte = std::is_enum<Value>::value || std::is_same<Value, bool>::value;
+    });
+    return byte;
+}
+
+uint64_t request_payload_bytes(const RequestHeader& header) {
+    switch (message_type(header)) {
+        case MessageType::BATCH_QUERY:
+            return detail::protocol_padded(header.type_count) +
+                   static_cast<uint64_t>(header.location_count) * 5 * sizeof(float);
+        case MessageType::GRID_QUERY:
+            return detail::protocol_padded(header.type_count) + sizeof(GridRegionWire);
+        default:
+            return 0;
+    }
+}
+
+uint64_t result_payload_bytes(size_t count, const std::vector<DataType>& data_types, bool grid) {
+    std::vector<size_t> offsets;
+    std::vector<bool> byte;
+    return detail::protocol_column_offsets(count, data_types, grid, offsets, byte);
+}
+
+void encode_batch_request(uint64_t id, const std::vector<Location>& locations,
+                          const std::vector<DataType>& data_types, std::vector<char>& out, uint32_t flags) {
+    out.reserve(out.size() + HEADER_BYTES + detail::protocol_padded(data_types.size()) +
+                locations.size() * 5 * sizeof(float));
+    detail::protocol_append_header(out, MessageType::BATCH_QUERY, flags, id, locations.size(), data_types);
+    float Location::*fields[] = {&Location::longitude, &Location::latitude, &Location::altitude,
+                                 &Location::current_time, &Location::detail_level};
+    for (float Location::*field : fields) {
+        size_t offset = out.size();
+        out.resize(offset + locations.size() * sizeof(float));
+        for (size_t i = 0; i < locations.size(); ++i) {
+            std::memcpy(out.data() + offset + i * sizeof(float), &(locations[i].*field), sizeof(float));
+        }
+    }
+}
+
+bool decode_batch_request(const RequestHeader& header, const char* payload, std::vector<Location>& locations,
+                          std::vector<DataType>& data_types, std::string* error) {
+    if (!detail::protocol_decode_types(header, payload, data_types, error)) {
+        return false;
+    }
+    size_t count = header.location_count;
+    const char* columns = payload + detail::protocol_padded(header.type_count);
+    locations.resize(count);
+    float Location::*fields[] = {&Location::longitude, &Location::latitude, &Location::altitude,
+                                 &Location::current_time, &Location::detail_level};
+    for (size_t f = 0; f < 5; ++f) {
+        const char* column = columns + f * count * sizeof(float);
+        for (size_t i = 0; i < count; ++i) {
+            std::memcpy(&(locations[i].*fields[f]), column + i * sizeof(float), sizeof(float));
+        }
+    }
+    return true;
+}
+
+void encode_grid_request(uint64_t id, const GridRegion& region, const std::vector<DataType>& data_types,
+                         std::vector<char>& out, uint32_t flags) {
+    detail::protocol_append_header(out, MessageType::GRID_QUERY, flags, id, 0, data_types);
+    GridRegionWire wire = to_wire(region);
+    detail::protocol_append(out, &wire, sizeof(wire));
+}
+
+bool decode_grid_request(const RequestHeader& header, const char* payload, GridRegion& region,
+                         std::vector<DataType>& data_types, std::string* error) {
+    if (!detail::protocol_decode_types(header, payload, data_types, error)) {
+        return false;
+    }
+    GridRegionWire wire;
+    std::memcpy(&wire, payload + detail::protocol_padded(header.type_count), sizeof(wire));
+    if (wire.width < 0 || wire.height < 0) {
+        if (error) {
+            *error = "negative grid size";
+        }
+        return false;
+    }
+    region = from_wire(wire);
+    return true;
+}
+
+void encode_batch_result(const BatchResult& result, const std::vector<DataType>& data_types, char* out) {
+    std::vector<size_t> offsets;
+    std::vector<bool> byte;
+    detail::protocol_column_offsets(result.count, data_types, false, offsets, byte);
+    detail::BatchLayout layout(data_types);
+    std::vector<float> values(result.count);
+    for (size_t i = 0; i < data_types.size(); ++i) {
+        char* column = out + offsets[i];
+        if (byte[i]) {
+            layout.extract(result, i, values.data());
+            for (size_t k = 0; k < values.size(); ++k) {
+                column[k] = static_cast<char>(static_cast<uint8_t>(values[k]));
+            }
+            std::memset(column + values.size(), 0, detail::protocol_padded(values.size()) - values.size());
+        } else if (reinterpret_cast<uintptr_t>(column) % alignof(float) == 0) {
+            layout.extract(result, i, reinterpret_cast<float*>(column));
+        } else {
+            layout.extract(result, i, values.data());
+            std::memcpy(column, values.data(), values.size() * sizeof(float));
+        }
+    }
+}
+
+void encode_batch_result(const BatchResult& result, const std::vector<DataType>& data_types, std::vector<char>& out) {
+    size_t offset = out.size();
+    out.resize(offset + result_payload_bytes(result.count, data_types, false));
+    encode_batch_result(result, data_types, out.data() + offset);
+}
+
+bool decode_batch_result(const char* payload, uint64_t bytes, size_t count, const std::vector<DataType>& data_types,
+                         BatchResult& result, std::string* error) {
+    std::vector<size_t> offsets;
+    std::vector<bool> byte;
+    size_t expected = detail::protocol_column_offsets(count, data_types, false, offsets, byte);
+    if (expected != bytes) {
+        if (error) {
+            *error = "response payload is " + std::to_string(bytes) + " bytes, expected " + std::to_string(expected);
+        }
+        return false;
+    }
+
+    // Push location by location in request order, which reproduces the
+    // interleaving of types that share a column
+    result = BatchResult();
+    result.count = count;
+    for (size_t k = 0; k < count; ++k) {
+        for (size_t i = 0; i < data_types.size(); ++i) {
+            const char* cell = payload + offsets[i];
+            detail::visit_batch_column(result, data_types[i], [&](auto& column) {
+                using Value = typename std::decay_t<decltype(column)>::value_type;
+                if constexpr (std::is_same<Value, float>::value) {
+                    float value;
+                    std::memcpy(&value, cell + k * sizeof(float), sizeof(float));
+                    column.push_back(value);
+                } else if constexpr (std::is_same<Value, bool>::value) {
+                    column.push_back(cell[k] != 0);
+                } else {
+                    column.push_back(static_cast<Value>(static_cast<uint8_t>(cell[k])));
+                }
+            });
+        }
+    }
+    return true;
+}
+
+} // namespace protocol
+
+SharedResult::~SharedResult() {
+    reset();
+}
+
+SharedResult::SharedResult(SharedResult&& other) noexcept {
+    *this = std::move(other);
+}
+
+SharedResult& SharedResult::operator=(SharedResult&& other) noexcept {
+    if (this != &other) {
+        reset();
+        size_ = other.size_;
+        mapped_ = other.mapped_;
+        copy_ = std::move(other.copy_);
+        data_ = mapped_ ? other.data_ : copy_.data();
+        count_ = other.count_;
+        types_ = std::move(other.types_);
+        offsets_ = std::move(other.offsets_);
+        byte_ = std::move(other.byte_);
+        other.data_ = nullptr;
+        other.size_ = 0;
+        other.mapped_ = false;
+    }
+    return *this;
+}
+
+void SharedResult::reset() {
+#ifdef RWORLD_HAS_UNIX_SOCKETS
+    if (mapped_ && data_ && size_ > 0) {
+        ::munmap(const_cast<char*>(data_), size_);
+    }
+#endif
+    data_ = nullptr;
+    size_ = 0;
+    mapped_ = false;
+    copy_.clear();
+    count_ = 0;
+    types_.clear();
+    offsets_.clear();
+    byte_.clear();
+}
+
+const float* SharedResult::floats(size_t column) const {
+    if (column >= types_.size() || byte_[column]) {
+        return nullptr;
+    }
+    return reinterpret_cast<const float*>(data_ + offsets_[column]);
+}
+
+const uint8_t* SharedResult::bytes(size_t column) const {
+    if (column >= types_.size() || !byte_[column]) {
+        return nullptr;
+    }
+    return reinterpret_cast<const uint8_t*>(data_ + offsets_[column]);
+}
+
+WorldClient::~WorldClient() {
+    close();
+}
+
+#ifdef RWORLD_HAS_UNIX_SOCKETS
+
+bool WorldClient::connect(const std::string& socket_path, std::string* error) {
+    close();
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (socket_path.size() >= sizeof(address.sun_path)) {
+        if (error) {
+            *error = "socket path too long: " + socket_path;
+        }
+        return false;
+    }
+    std::memcpy(address.sun_path, socket_path.c_str(), socket_path.size() + 1);
+
+    fd_ = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd_ < 0 || ::connect(fd_, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+        if (error) {
+            *error = "cannot connect to " + socket_path + ": " + std::strerror(errno);
+        }
+        close();
+        return false;
+    }
+    return true;
+}
+
+void WorldClient::close() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+    in_flight_.clear();
+}
+
+bool WorldClient::send_all(const std::vector<char>& data, std::string* error) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t n = ::send(fd_, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            if (error) {
+                *error = std::string("send failed: ") + std::strerror(errno);
+            }
+            close();
+            return false;
+        }
+        sent += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+bool WorldClient::receive_all(char* data, size_t bytes, std::string* error, int* descriptor) {
+    size_t received = 0;
+    while (received < bytes) {
+        iovec io{data + received, bytes - received};
+        alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))];
+        msghdr message{};
+        message.msg_iov = &io;
+        message.msg_iovlen = 1;
+        message.msg_control = control;
+        message.msg_controllen = sizeof(control);
+#ifdef MSG_CMSG_CLOEXEC
+        ssize_t n = ::recvmsg(fd_, &message, MSG_CMSG_CLOEXEC);
+#else
+        ssize_t n = ::recvmsg(fd_, &message, 0);
+#endif
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            if (error) {
+                *error = n == 0 ? std::string("server closed the connection")
+                                : std::string("receive failed: ") + std::strerror(errno);
+            }
+            close();
+            return false;
+        }
+        for (cmsghdr* header = CMSG_FIRSTHDR(&message); header; header = CMSG_NXTHDR(&message, header)) {
+            if (header->cmsg_level == SOL_SOCKET && header->cmsg_type == SCM_RIGHTS) {
+                int attached;
+                std::memcpy(&attached, CMSG_DATA(header), sizeof(attached));
+                if (descriptor && *descriptor < 0) {
+                    *descriptor = attached;
+                } else {
+                    ::close(attached);
+                }
+            }
+        }
+        received += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+void WorldClient::close_descriptor(int& descriptor) {
+    if (descriptor >= 0) {
+        ::close(descriptor);
+        descriptor = -1;
+    }
+}
+
+bool WorldClient::share(const std::vector<DataType>& data_types, size_t count, bool grid, std::vector<char>& payload,
+                        int memfd, SharedResult& result, std::string* error) {
+    result.reset();
+    size_t expected = detail::protocol_column_offsets(count, data_types, grid, result.offsets_, result.byte_);
+    size_t size = memfd >= 0 ? expected : payload.size();
+    if (memfd >= 0 && expected > 0) {
+        // A short file would fault on access instead of failing here
+        struct stat status;
+        if (::fstat(memfd, &status) != 0 || static_cast<uint64_t>(status.st_size) < expected) {
+            ::close(memfd);
+            if (error) {
+                *error = "shared result is smaller than expected";
+            }
+            return false;
+        }
+        void* mapping = ::mmap(nullptr, expected, PROT_READ, MAP_SHARED, memfd, 0);
+        ::close(memfd);
+        if (mapping == MAP_FAILED) {
+            if (error) {
+                *error = std::string("mmap failed: ") + std::strerror(errno);
+            }
+            return false;
+        }
+        result.data_ = static_cast<const char*>(mapping);
+        result.mapped_ = true;
+    } else {
+        if (memfd >= 0) {
+            ::close(memfd);
+        }
+        result.copy_ = std::move(payload);
+        result.data_ = result.copy_.data();
+    }
+    result.size_ = size;
+    result.count_ = count;
+    result.types_ = data_types;
+    if (size != expected) {
+        if (error) {
+            *error = "response payload is " + std::to_string(size) + " bytes, expected " + std::to_string(expected);
+        }
+        result.reset();
+        return false;
+    }
+    return true;
+}
+
+#else
+
+bool WorldClient::connect(const std::string&, std::string* error) {
+    if (error) {
+        *error = "Unix domain sockets are not available on this platform";
+    }
+    return false;
+}
+
+void WorldClient::close() {}
+
+bool WorldClient::send_all(const std::vector<char>&, std::string*) {
+    return false;
+}
+
+bool WorldClient::receive_all(char*, size_t, std::string*, int*) {
+    return false;
+}
+
+void WorldClient::close_descriptor(int&) {}
+
+bool WorldClient::share(const std::vector<DataType>&, size_t, bool, std::vector<char>&, int, SharedResult&,
+                        std::string*) {
+    return false;
+}
+
+#endif // RWORLD_HAS_UNIX_SOCKETS
+
+uint64_t WorldClient::send_batch(const std::vector<Location>& locations, const std::vector<DataType>& data_types,
+                                 std::string* error) {
+    if (!connected()) {
+        if (error) {
+            *error = "not connected";
+        }
+        return 0;
+    }
+    uint64_t id = next_id_++;
+    std::vector<char> message;
+    protocol::encode_batch_request(id, locations, data_types, message);
+    if (!send_all(message, error)) {
+        return 0;
+    }
+    in_flight_[id] = {locations.size(), data_types};
+    return id;
+}
+
+bool WorldClient::receive(uint64_t& id, BatchResult& result, std::string* error) {
+    protocol::ResponseHeader header;
+    if (!connected() || !receive_all(reinterpret_cast<char*>(&header), sizeof(header), error)) {
+        return false;
+    }
+    // A response that cannot be trusted is not read, so the stream is out
+    // of step and the connection is dropped
+    auto request = in_flight_.find(header.id);
+    const char* problem = nullptr;
+    if (header.magic != protocol::RESPONSE_MAGIC) {
+        problem = "bad response magic";
+    } else if (request == in_flight_.end()) {
+        problem = "response to unknown request";
+    } else if (!detail::protocol_payload_allowed(
+                   header, protocol::result_payload_bytes(request->second.first, request->second.second, false))) {
+        problem = "response has the wrong size";
+    }
+    if (problem) {
+        if (error) {
+            *error = problem;
+        }
+        close();
+        return false;
+    }
+    id = header.id;
+    std::pair<size_t, std::vector<DataType>> sent = std::move(request->second);
+    in_flight_.erase(request);
+    std::vector<char> payload(header.payload_bytes);
+    if (!receive_all(payload.data(), payload.size(), error)) {
+        close();
+        return false;
+    }
+    if (header.status != static_cast<uint32_t>(protocol::Status::OK)) {
+        if (error) {
+            *error = std::string(payload.begin(), payload.end());
+        }
+        return false;
+    }
+    return protocol::decode_batch_result(payload.data(), payload.size(), sent.first, sent.second, result, error);
+}
+
+bool WorldClient::batch_query(const std::vector<Location>& locations, const std::vector<DataType>& data_types,
+                              BatchResult& result, std::string* error) {
+    uint64_t id = send_batch(locations, data_types, error);
+    uint64_t received = 0;
+    return id != 0 && receive(received, result, error) && received == id;
+}
+
+bool WorldClient::exchange(const std::vector<char>& message, uint64_t id, uint64_t expected,
+                           std::vector<char>& payload, int& memfd, std::string* error) {
+    memfd = -1;
+    protocol::ResponseHeader header;
+    if (!connected()) {
+        if (error) {
+            *error = "not connected";
+        }
+        return false;
+    }
+    if (!send_all(message, error) || !receive_all(reinterpret_cast<char*>(&header), sizeof(header), error, &memfd)) {
+        close_descriptor(memfd);
+        return false;
+    }
+    if (header.id != id || !detail::protocol_payload_allowed(header, expected)) {
+        if (error) {
+            *error = "unexpected response";
+        }
+        close_descriptor(memfd);
+        close();
+        return false;
+    }
+    // With a descriptor attached, payload_bytes describes the shared memory
+    payload.resize(memfd >= 0 ? 0 : header.payload_bytes);
+    if (!receive_all(payload.data(), payload.size(), error)) {
+        close_descriptor(memfd);
+        return false;
+    }
+    if (header.status != static_cast<uint32_t>(protocol::Status::OK)) {
+        if (error) {
+            *error = std::string(payload.begin(), payload.end());
+        }
+        close_descriptor(memfd);
+        return false;
+    }
+    return true;
+}
+
+bool WorldClient::batch_query_shared(const std::vector<Location>& locations, const std::vector<DataType>& data_types,
+                                     SharedResult& result, std::string* error) {
+    uint64_t id = next_id_++;
+    std::vector<char> message;
+    protocol::encode_batch_request(id, locations, data_types, message, protocol::SHARED_MEMORY);
+    std::vector<char> payload;
+    int memfd = -1;
+    return exchange(message, id, protocol::result_payload_bytes(locations.size(), data_types, false), payload, memfd,
+                    error) &&
+           share(data_types, locations.size(), false, payload, memfd, result, error);
+}
+
+bool WorldClient::grid_query(const GridRegion& region, const std::vector<DataType>& data_types, GridResult& result,
+                             std::string* error) {
+    uint64_t id = next_id_++;
+    std::vector<char> message;
+    protocol::encode_grid_request(id, region, data_types, message);
+    result.width = std::max(region.width, 0);
+    result.row_begin = 0;
+    result.rows = std::max(region.height, 0);
+    size_t cells = static_cast<size_t>(result.width) * static_cast<size_t>(result.rows);
+    std::vector<char> payload;
+    int memfd = -1;
+    if (!exchange(message, id, protocol::result_payload_bytes(cells, data_types, true), payload, memfd, error)) {
+        return false;
+    }
+    close_descriptor(memfd);  // Not requested; the size check below fails
+    if (payload.size() != cells * data_types.size() * sizeof(float)) {
+        if (error) {
+            *error = "grid response has the wrong size";
+        }
+        return false;
+    }
+    result.layers.assign(data_types.size(), std::vector<float>(cells));
+    for (size_t i = 0; i < data_types.size(); ++i) {
+        std::memcpy(result.layers[i].data(), payload.data() + i * cells * sizeof(float), cells * sizeof(float));
+    }
+    return true;
+}
+
+bool WorldClient::grid_query_shared(const GridRegion& region, const std::vector<DataType>& data_types,
+                                    SharedResult& result, std::string* error) {
+    uint64_t id = next_id_++;
+    std::vector<char> message;
+    protocol::encode_grid_request(id, region, data_types, message, protocol::SHARED_MEMORY);
+    std::vector<char> payload;
+    int memfd = -1;
+    size_t cells = static_cast<size_t>(std::max(region.width, 0)) * static_cast<size_t>(std::max(region.height, 0));
+    return exchange(message, id, protocol::result_payload_bytes(cells, data_types, true), payload, memfd, error) &&
+           share(data_types, cells, true, payload, memfd, result, error);
+}
+
+bool WorldClient::info(protocol::InfoPayload& info, std::string* error) {
+    protocol::RequestHeader request;
+    request.type = static_cast<uint32_t>(protocol::MessageType::INFO);
+    request.id = next_id_++;
+    std::vector<char> message(sizeof(request));
+    std::memcpy(message.data(), &request, sizeof(request));
+    std::vector<char> payload;
+    int memfd = -1;
+    if (!exchange(message, request.id, sizeof(info), payload, memfd, error)) {
+        return false;
+    }
+    if (memfd >= 0 || payload.size() != sizeof(info)) {
+        close_descriptor(memfd);
+        if (error) {
+            *error = "unexpected response to INFO";
+        }
+        return false;
+    }
+    std::memcpy(&info, payload.data(), sizeof(info));
+    return true;
+}
+
+} // namespace rworld
+
+#endif // _RWORLD_IMPLEMENTATION
+#endif // RWORLD_PROTOCOL_H
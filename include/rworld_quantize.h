@@ -0,0 +1,565 @@
+#ifndef RWORLD_QUANTIZE_H
+#define RWORLD_QUANTIZE_H
+
+#include "rworld.h"
+
+#include <vector>
+
+namespace rworld {
+
+/**
+ * Storage encodings for a quantized layer
+ *
+ * Fixed-point schemes store an unsigned code per cell and decode it as
+ * value = offset + code * step; values outside the representable range are
+ * clamped and NaN is stored as code 0. FIXED4 packs two cells per byte (low
+ * nibble first) and suits enums and booleans with at most 16 values.
+ */
+enum class QuantizationScheme {
+    FLOAT32,  // Unchanged, 4 bytes per cell
+    FLOAT16,  // IEEE half precision (11 significant bits, |value| < 65520), 2 bytes per cell
+    FIXED16,  // 16-bit code, 2 bytes per cell
+    FIXED8,   // 8-bit code, 1 byte per cell
+    FIXED4    // 4-bit code, half a byte per cell
+};
+
+/**
+ * Encoding of one layer
+ *
+ * offset and step only apply to the fixed-point schemes. Decoded values are
+ * within step / 2 of the original inside [offset, offset + max_code * step];
+ * FLOAT16 keeps a relative error below 2^-11.
+ */
+struct LayerQuantization {
+    QuantizationScheme scheme = QuantizationScheme::FLOAT32;
+    float offset = 0.0f;
+    float step = 1.0f;
+};
+
+/**
+ * Bits stored per cell by a scheme
+ */
+int quantization_bits(QuantizationScheme scheme);
+
+/**
+ * Recommended encoding for a data type
+ *
+ * Chosen from the ranges the generator produces, e.g.:
+ * - TERRAIN_HEIGHT: FIXED16 from -4000 m in 0.25 m steps (widened when
+ *   max_terrain_height does not fit)
+ * - TEMPERATURE, TEMPERATURE_AT_TIME: FIXED16 from -100 C in 0.01 C steps
+ * - Deposits, SOIL_FERTILITY, ORGANIC_MATTER, HUMIDITY, VEGETATION_DENSITY:
+ *   FIXED8 over [0, 1] in 1/255 steps
+ * - SOIL_PH: FIXED8 from 2 in 0.05 steps
+ * - BIOME: FIXED8 (18 values); SOIL_TYPE, PRECIPITATION_TYPE and the
+ *   boolean types: FIXED4
+ * - Small or heavy-tailed fields (CURRENT_PRECIPITATION, RIVER_WIDTH,
+ *   FLOW_ACCUMULATION, PRESSURE_GRADIENT): FLOAT16
+ */
+LayerQuantization default_quantization(DataType type, const WorldConfig& config);
+
+/**
+ * default_quantization for each of several data types
+ */
+std::vector<LayerQuantization> default_quantization(const std::vector<DataType>& types, const WorldConfig& config);
+
+/**
+ * One layer of cells held in a quantized encoding
+ *
+ * Decoding runs through F16C/AVX2 kernels when the CPU has them (selected
+ * at first use; RWORLD_ISA=scalar forces the portable loops).
+ */
+class QuantizedLayer {
+public:
+    QuantizedLayer() = default;
+
+    /**
+     * Encode count values
+     */
+    QuantizedLayer(const LayerQuantization& quantization, const float* values, size_t count);
+
+    /**
+     * Decode cells [begin, begin + count) into out
+     */
+    void decode(float* out, size_t begin, size_t count) const;
+
+    /**
+     * Decode every cell
+     */
+    std::vector<float> decode() const;
+
+    /**
+     * Decoded value of one cell
+     */
+    float value(size_t index) const;
+
+    /**
+     * Cell values without decoding when the scheme is FLOAT32, else null
+     */
+    const float* floats() const;
+
+    const LayerQuantization& quantization() const { return quantization_; }
+    size_t size() const { return count_; }
+
+    /**
+     * Encoded bytes (fixed-point codes and half floats are little-endian)
+     */
+    const std::vector<unsigned char>& data() const { return data_; }
+    size_t bytes() const { return data_.size(); }
+
+private:
+    LayerQuantization quantization_;
+    size_t count_ = 0;
+    std::vector<unsigned char> data_;
+};
+
+/**
+ * Quantized counterpart of GridResult
+ */
+struct QuantizedGrid {
+    int width = 0;
+    int row_begin = 0;
+    int rows = 0;
+    std::vector<QuantizedLayer> layers;
+
+    /**
+     * Decode every layer into out (storage is reused across calls)
+     */
+    void decode(GridResult& out) const;
+
+    size_t bytes() const;
+};
+
+/**
+ * Quantize a grid, one encoding per layer (missing entries stay FLOAT32)
+ */
+QuantizedGrid quantize_grid(const GridResult& grid, const std::vector<LayerQuantization>& quantization);
+
+/**
+ * Quantize the columns of a batch result, one layer per requested type
+ *
+ * @param batch Result of World::batch_query
+ * @param types Data types in the order they were requested
+ * @param quantization One encoding per type (missing entries stay FLOAT32)
+ */
+std::vector<QuantizedLayer> quantize_batch(const BatchResult& batch, const std::vector<DataType>& types,
+                                           const std::vector<LayerQuantization>& quantization);
+
+} // namespace rworld
+
+#ifdef _RWORLD_IMPLEMENTATION
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+#if RWORLD_KERNEL_MULTIVERSION
+#include <immintrin.h>
+#endif
+
+namespace rworld {
+
+namespace detail {
+
+inline uint16_t load_code16(const unsigned char* bytes) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    return static_cast<uint16_t>(bytes[0] | (bytes[1] << 8));
+#else
+    uint16_t code; // A plain load, which the decode loops vectorize
+    std::memcpy(&code, bytes, sizeof(code));
+    return code;
+#endif
+}
+
+// Round to nearest even; overflow becomes infinity, NaN stays NaN
+inline uint16_t float_to_half(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    uint32_t sign = (bits >> 16) & 0x8000u;
+    uint32_t magnitude = bits & 0x7fffffffu;
+    if (magnitude >= 0x7f800000u) {
+        return static_cast<uint16_t>(sign | 0x7c00u | (magnitude > 0x7f800000u ? 0x200u : 0u));
+    }
+    if (magnitude >= 0x477ff000u) {
+        return static_cast<uint16_t>(sign | 0x7c00u);
+    }
+    if (magnitude < 0x38800000u) {
+        // Half subnormal: a multiple of 2^-24
+        float scaled;
+        std::memcpy(&scaled, &magnitude, sizeof(scaled));
+        return static_cast<uint16_t>(sign | static_cast<uint32_t>(std::nearbyint(scaled * 16777216.0f)));
+    }
+    uint32_t rounded = magnitude + 0xfffu + ((magnitude >> 13) & 1u);
+    return static_cast<uint16_t>(sign | ((rounded - 0x38000000u) >> 13));
+}
+
+// Branch free so the portable decode loop vectorizes
+inline float half_to_float(uint16_t half) {
+    uint32_t shifted = (static_cast<uint32_t>(half) & 0x7fffu) << 13;
+    float value;
+    std::memcpy(&value, &shifted, sizeof(value));
+    value *= 5.192296858534828e33f; // 2^112 rebiases the exponent (and normalizes subnormals)
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    bits = shifted >= 0x0f800000u ? (shifted | 0x7f800000u) : bits;
+    bits |= (static_cast<uint32_t>(half) & 0x8000u) << 16;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+/**
+ * Code of a value under a fixed-point scheme, clamped to the representable
+ * range with NaN mapped to 0
+ */
+struct FixedEncoder {
+    float offset;
+    float inverse;
+    float max_code;
+
+    explicit FixedEncoder(const LayerQuantization& quantization)
+        : offset(quantization.offset), inverse(quantization.step != 0.0f ? 1.0f / quantization.step : 0.0f),
+          max_code(static_cast<float>((1u << quantization_bits(quantization.scheme)) - 1u)) {}
+
+    uint32_t operator()(float value) const {
+        float t = (value - offset) * inverse;
+        t = t >= 0.0f ? t : 0.0f;
+        return static_cast<uint32_t>(std::min(t, max_code) + 0.5f);
+    }
+};
+
+template <typename Load>
+inline void decode_fixed(const unsigned char* codes, size_t count, float offset, float step, float* out, Load load) {
+    for (size_t i = 0; i < count; ++i) {
+        out[i] = offset + step * static_cast<float>(load(codes, i));
+    }
+}
+
+inline void decode_half_loop(const unsigned char* codes, size_t count, float* out) {
+    for (size_t i = 0; i < count; ++i) {
+        out[i] = half_to_float(load_code16(codes + i * 2));
+    }
+}
+
+// codes points at the byte holding cell 0 of the run, which starts on a
+// low nibble
+inline void decode_nibbles(const unsigned char* codes, size_t count, float offset, float step, float* out) {
+    for (size_t i = 0; i < count / 2; ++i) {
+        out[2 * i] = offset + step * static_cast<float>(codes[i] & 0x0f);
+        out[2 * i + 1] = offset + step * static_cast<float>(codes[i] >> 4);
+    }
+    if (count & 1) {
+        out[count - 1] = offset + step * static_cast<float>(codes[count / 2] & 0x0f);
+    }
+}
+
+/**
+ * Bulk decoders, one set per instruction set
+ */
+struct QuantizeKernels {
+    const char* name;
+    void (*decode_half)(const unsigned char* codes, size_t count, float* out);
+    void (*decode_fixed16)(const unsigned char* codes, size_t count, float offset, float step, float* out);
+    void (*decode_fixed8)(const unsigned char* codes, size_t count, float offset, float step, float* out);
+    void (*decode_fixed4)(const unsigned char* codes, size_t count, float offset, float step, float* out);
+};
+
+inline void decode_half_scalar(const unsigned char* codes, size_t count, float* out) {
+    decode_half_loop(codes, count, out);
+}
+
+inline void decode_fixed16_scalar(const unsigned char* codes, size_t count, float offset, float step, float* out) {
+    decode_fixed(codes, count, offset, step, out,
+                 [](const unsigned char* bytes, size_t i) { return load_code16(bytes + i * 2); });
+}
+
+inline void decode_fixed8_scalar(const unsigned char* codes, size_t count, float offset, float step, float* out) {
+    decode_fixed(codes, count, offset, step, out, [](const unsigned char* bytes, size_t i) { return bytes[i]; });
+}
+
+inline void decode_fixed4_scalar(const unsigned char* codes, size_t count, float offset, float step, float* out) {
+    decode_nibbles(codes, count, offset, step, out);
+}
+
+#if RWORLD_KERNEL_MULTIVERSION
+RWORLD_KERNEL_TARGET("avx2,f16c") inline void decode_half_avx2(const unsigned char* codes, size_t count, float* out) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i half = _mm_loadu_si128(reinterpret_cast<const __m128i*>(codes + i * 2));
+        _mm256_storeu_ps(out + i, _mm256_cvtph_ps(half));
+    }
+    decode_half_loop(codes + i * 2, count - i, out + i);
+}
+
+RWORLD_KERNEL_TARGET("avx2")
+inline void decode_fixed16_avx2(const unsigned char* codes, size_t count, float offset, float step, float* out) {
+    decode_fixed16_scalar(codes, count, offset, step, out);
+}
+
+RWORLD_KERNEL_TARGET("avx2")
+inline void decode_fixed8_avx2(const unsigned char* codes, size_t count, float offset, float step, float* out) {
+    decode_fixed8_scalar(codes, count, offset, step, out);
+}
+
+RWORLD_KERNEL_TARGET("avx2")
+inline void decode_fixed4_avx2(const unsigned char* codes, size_t count, float offset, float step, float* out) {
+    decode_nibbles(codes, count, offset, step, out);
+}
+#endif
+
+inline const QuantizeKernels& select_quantize_kernels() {
+    static const QuantizeKernels scalar = {"scalar", decode_half_scalar, decode_fixed16_scalar,
+                                           decode_fixed8_scalar, decode_fixed4_scalar};
+#if RWORLD_KERNEL_MULTIVERSION
+    static const QuantizeKernels avx2 = {"avx2", decode_half_avx2, decode_fixed16_avx2,
+                                         decode_fixed8_avx2, decode_fixed4_avx2};
+    static const QuantizeKernels& selected = []() -> const QuantizeKernels& {
+        __builtin_cpu_init();
+        const char* forced = std::getenv("RWORLD_ISA");
+        bool allowed = !forced || (std::strcmp(forced, "scalar") != 0 && std::strcmp(forced, "sse4.1") != 0);
+        if (allowed && __builtin_cpu_supports("avx2") && __builtin_cpu_supports("f16c")) {
+            return avx2;
+        }
+        return scalar;
+    }();
+    return selected;
+#else
+    return scalar;
+#endif
+}
+
+} // namespace detail
+
+int quantization_bits(QuantizationScheme scheme) {
+    switch (scheme) {
+        case QuantizationScheme::FLOAT32: return 32;
+        case QuantizationScheme::FLOAT16:
+        case QuantizationScheme::FIXED16: return 16;
+        case QuantizationScheme::FIXED8: return 8;
+        case QuantizationScheme::FIXED4: return 4;
+    }
+    return 32;
+}
+
+LayerQuantization default_quantization(DataType type, const WorldConfig& config) {
+    auto fixed = [](QuantizationScheme scheme, float offset, float step) {
+        LayerQuantization quantization;
+        quantization.scheme = scheme;
+        quantization.offset = offset;
+        quantization.step = step;
+        return quantization;
+    };
+    switch (type) {
+        case DataType::TERRAIN_HEIGHT: {
+            // Ocean floor to the tallest volcano cone, as in default_export_range
+            float span = config.max_terrain_height + 3000.0f + 4000.0f;
+            return fixed(QuantizationScheme::FIXED16, -4000.0f, std::max(0.25f, span / 65535.0f));
+        }
+        case DataType::TEMPERATURE:
+        case DataType::TEMPERATURE_AT_TIME:
+            return fixed(QuantizationScheme::FIXED16, -100.0f, 0.01f);
+        case DataType::PRECIPITATION:
+            return fixed(QuantizationScheme::FIXED16, 0.0f, 0.1f);
+        case DataType::AIR_PRESSURE:
+        case DataType::PRESSURE_AT_LOCATION:
+            return fixed(QuantizationScheme::FIXED16, 0.0f, 0.02f);
+        case DataType::WIND_SPEED:
+        case DataType::CURRENT_WIND_SPEED:
+        case DataType::WIND_DIRECTION:
+        case DataType::CURRENT_WIND_DIRECTION:
+            return fixed(QuantizationScheme::FIXED16, 0.0f, 0.01f);
+        case DataType::INSOLATION:
+            return fixed(QuantizationScheme::FIXED16, 0.0f, 0.05f);
+        case DataType::SOLAR_ANGLE:
+            return fixed(QuantizationScheme::FIXED16, -90.0f, 0.01f);
+        case DataType::HUMIDITY:
+        case DataType::VEGETATION_DENSITY:
+        case DataType::COAL_DEPOSIT:
+        case DataType::IRON_DEPOSIT:
+        case DataType::OIL_DEPOSIT:
+        case DataType::SOIL_FERTILITY:
+        case DataType::ORGANIC_MATTER:
+            return fixed(QuantizationScheme::FIXED8, 0.0f, 1.0f / 255.0f);
+        case DataType::SOIL_PH:
+            return fixed(QuantizationScheme::FIXED8, 2.0f, 0.05f);
+        case DataType::BIOME:
+            return fixed(QuantizationScheme::FIXED8, 0.0f, 1.0f);
+        case DataType::PRECIPITATION_TYPE:
+        case DataType::SOIL_TYPE:
+        case DataType::IS_RIVER:
+        case DataType::IS_VOLCANO:
+        case DataType::IS_DAYLIGHT:
+        case DataType::IS_STORM_FRONT:
+            return fixed(QuantizationScheme::FIXED4, 0.0f, 1.0f);
+        case DataType::CURRENT_PRECIPITATION:
+        case DataType::RIVER_WIDTH:
+        case DataType::FLOW_ACCUMULATION:
+        case DataType::PRESSURE_GRADIENT:
+            break;
+    }
+    LayerQuantization quantization;
+    quantization.scheme = QuantizationScheme::FLOAT16;
+    return quantization;
+}
+
+std::vector<LayerQuantization> default_quantization(const std::vector<DataType>& types, const WorldConfig& config) {
+    std::vector<LayerQuantization> quantization;
+    quantization.reserve(types.size());
+    for (DataType type : types) {
+        quantization.push_back(default_quantization(type, config));
+    }
+    return quantization;
+}
+
+QuantizedLayer::QuantizedLayer(const LayerQuantization& quantization, const float* values, size_t count)
+    : quantization_(quantization), count_(count) {
+    switch (quantization_.scheme) {
+        case QuantizationScheme::FLOAT32:
+            data_.resize(count * sizeof(float));
+            std::memcpy(data_.data(), values, data_.size());
+            return;
+        case QuantizationScheme::FLOAT16:
+            data_.resize(count * 2);
+            for (size_t i = 0; i < count; ++i) {
+                uint16_t half = detail::float_to_half(values[i]);
+                data_[i * 2] = static_cast<unsigned char>(half & 0xff);
+                data_[i * 2 + 1] = static_cast<unsigned char>(half >> 8);
+            }
+            return;
+        default:
+            break;
+    }
+
+    int bits = quantization_bits(quantization_.scheme);
+    detail::FixedEncoder code(quantization_);
+    data_.assign((count * bits + 7) / 8, 0);
+    for (size_t i = 0; i < count; ++i) {
+        uint32_t c = code(values[i]);
+        if (bits == 16) {
+            data_[i * 2] = static_cast<unsigned char>(c & 0xff);
+            data_[i * 2 + 1] = static_cast<unsigned char>(c >> 8);
+        } else if (bits == 8) {
+            data_[i] = static_cast<unsigned char>(c);
+        } else {
+            data_[i / 2] |= static_cast<unsigned char>(c << ((i & 1) * 4));
+        }
+    }
+}
+
+void QuantizedLayer::decode(float* out, size_t begin, size_t count) const {
+    count = begin < count_ ? std::min(count, count_ - begin) : 0;
+    if (count == 0) {
+        return;
+    }
+    const detail::QuantizeKernels& kernels = detail::select_quantize_kernels();
+    const unsigned char* bytes = data_.data();
+    float offset = quantization_.offset;
+    float step = quantization_.step;
+    switch (quantization_.scheme) {
+        case QuantizationScheme::FLOAT32:
+            std::memcpy(out, bytes + begin * sizeof(float), count * sizeof(float));
+            break;
+        case QuantizationScheme::FLOAT16:
+            kernels.decode_half(bytes + begin * 2, count, out);
+            break;
+        case QuantizationScheme::FIXED16:
+            kernels.decode_fixed16(bytes + begin * 2, count, offset, step, out);
+            break;
+        case QuantizationScheme::FIXED8:
+            kernels.decode_fixed8(bytes + begin, count, offset, step, out);
+            break;
+        case QuantizationScheme::FIXED4:
+            // Runs starting on a high nibble peel that cell first
+            if (begin & 1) {
+                *out++ = value(begin++);
+                --count;
+            }
+            kernels.decode_fixed4(bytes + begin / 2, count, offset, step, out);
+            break;
+    }
+}
+
+std::vector<float> QuantizedLayer::decode() const {
+    std::vector<float> values(count_);
+    decode(values.data(), 0, count_);
+    return values;
+}
+
+float QuantizedLayer::value(size_t index) const {
+    const unsigned char* bytes = data_.data();
+    float offset = quantization_.offset;
+    float step = quantization_.step;
+    switch (quantization_.scheme) {
+        case QuantizationScheme::FLOAT32: {
+            float value;
+            std::memcpy(&value, bytes + index * sizeof(float), sizeof(value));
+            return value;
+        }
+        case QuantizationScheme::FLOAT16:
+            return detail::half_to_float(detail::load_code16(bytes + index * 2));
+        case QuantizationScheme::FIXED16:
+            return offset + step * static_cast<float>(detail::load_code16(bytes + index * 2));
+        case QuantizationScheme::FIXED8:
+            return offset + step * static_cast<float>(bytes[index]);
+        case QuantizationScheme::FIXED4:
+            return offset + step * static_cast<float>((bytes[index / 2] >> ((index & 1) * 4)) & 0x0f);
+    }
+    return 0.0f;
+}
+
+const float* QuantizedLayer::floats() const {
+    if (quantization_.scheme != QuantizationScheme::FLOAT32) {
+        return nullptr;
+    }
+    return reinterpret_cast<const float*>(data_.data());
+}
+
+void QuantizedGrid::decode(GridResult& out) const {
+    out.width = width;
+    out.row_begin = row_begin;
+    out.rows = rows;
+    out.layers.resize(layers.size());
+    for (size_t i = 0; i < layers.size(); ++i) {
+        out.layers[i].resize(layers[i].size());
+        layers[i].decode(out.layers[i].data(), 0, layers[i].size());
+    }
+}
+
+size_t QuantizedGrid::bytes() const {
+    size_t total = 0;
+    for (const QuantizedLayer& layer : layers) {
+        total += layer.bytes();
+    }
+    return total;
+}
+
+QuantizedGrid quantize_grid(const GridResult& grid, const std::vector<LayerQuantization>& quantization) {
+    QuantizedGrid result;
+    result.width = grid.width;
+    result.row_begin = grid.row_begin;
+    result.rows = grid.rows;
+    result.layers.reserve(grid.layers.size());
+    for (size_t i = 0; i < grid.layers.size(); ++i) {
+        LayerQuantization scheme = i < quantization.size() ? quantization[i] : LayerQuantization();
+        result.layers.emplace_back(scheme, grid.layers[i].data(), grid.layers[i].size());
+    }
+    return result;
+}
+
+std::vector<QuantizedLayer> quantize_batch(const BatchResult& batch, const std::vector<DataType>& types,
+                                           const std::vector<LayerQuantization>& quantization) {
+    detail::BatchLayout layout(types);
+    std::vector<float> values(batch.count);
+    std::vector<QuantizedLayer> layers;
+    layers.reserve(types.size());
+    for (size_t i = 0; i < types.size(); ++i) {
+        layout.extract(batch, i, values.data());
+        LayerQuantization scheme = i < quantization.size() ? quantization[i] : LayerQuantization();
+        layers.emplace_back(scheme, values.data(), values.size());
+    }
+    return layers;
+}
+
+} // namespace rworld
+
+#endif // _RWORLD_IMPLEMENTATION
+#endif // RWORLD_QUANTIZE_H
@@ -0,0 +1,603 @@
+#ifndef RWORLD_SCHEDULER_H
+#define RWORLD_SCHEDULER_H
+
+#include "rworld_async.h"
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace rworld {
+
+/**
+ * Scheduling class of a query
+ */
+enum class QueryLane {
+    INTERACTIVE,  // Latency sensitive (player-facing point queries); always served first
+    BULK          // Throughput work (exports); split into chunks that interactive work overtakes
+};
+
+/**
+ * Settings for a QueryScheduler
+ */
+struct SchedulerOptions {
+    int threads = 0;                     // Worker threads (0 = hardware threads or RWORLD_THREADS)
+    int interactive_threads = 0;         // Workers reserved for the interactive lane (< threads)
+    size_t interactive_capacity = 4096;  // Queued interactive queries before submissions are rejected
+    size_t bulk_capacity = 64;           // Queued bulk batches before submissions are rejected
+    size_t bulk_chunk = 2048;            // Locations per bulk chunk
+};
+
+/**
+ * Thrown by QueryFuture::get() for a query submitted to a full lane
+ */
+class QueryRejected : public std::runtime_error {
+public:
+    QueryRejected() : std::runtime_error("rworld query rejected: lane queue is full") {}
+};
+
+/**
+ * Thrown by QueryFuture::get() for a query whose deadline passed before it
+ * (or, for a batch, its next chunk) started
+ */
+class QueryDeadlineExceeded : public std::runtime_error {
+public:
+    QueryDeadlineExceeded() : std::runtime_error("rworld query deadline exceeded") {}
+};
+
+/**
+ * Log2 histogram of latencies from submission to completion
+ *
+ * Bucket b counts latencies in [2^b, 2^(b+1)) microseconds; bucket 0 also
+ * holds everything under a microsecond.
+ */
+struct LatencyHistogram {
+    static constexpr int BUCKETS = 32;
+    std::array<uint64_t, BUCKETS> counts{};
+    uint64_t total = 0;
+    double sum = 0.0;  // Seconds
+    double max = 0.0;  // Seconds
+
+    void record(double seconds);
+
+    /**
+     * Upper bound in seconds of the bucket holding the p-th percentile
+     * (p in [0, 100])
+     */
+    double percentile(double p) const;
+
+    double mean() const { return total > 0 ? sum / static_cast<double>(total) : 0.0; }
+};
+
+/**
+ * Counters of one lane
+ */
+struct LaneStats {
+    size_t depth = 0;         // Queued now (a bulk batch until its last chunk starts)
+    size_t capacity = 0;
+    uint64_t submitted = 0;
+    uint64_t completed = 0;   // Finished, successfully or with an exception
+    uint64_t rejected = 0;    // Lane was full
+    uint64_t expired = 0;     // Deadline passed while queued
+    uint64_t cancelled = 0;   // Cancelled by the caller (or a batch failed) while queued
+    LatencyHistogram latency; // Of completed queries
+};
+
+namespace detail {
+
+/**
+ * A queued query as the scheduler sees it: one or more steps run by any
+ * worker. Implementations are thread safe.
+ */
+class ScheduledQuery {
+public:
+    virtual ~ScheduledQuery() = default;
+
+    // Cancelled by the caller or already failed; dropped from the queue
+    virtual bool finished() const = 0;
+
+    // Claim the next step; returns true when it was the last one
+    virtual bool claim(size_t& step) = 0;
+
+    // Run a claimed step; returns true when the query is now done
+    virtual bool run(size_t step) = 0;
+
+    // Fail the query (rejection, expiry or shutdown)
+    virtual void fail(std::exception_ptr failure) = 0;
+};
+
+// A single-step query
+template <typename T>
+class ScheduledCall : public ScheduledQuery {
+public:
+    explicit ScheduledCall(std::shared_ptr<QueryState<T>> state) : state_(std::move(state)) {}
+
+    bool finished() const override { return state_->done(); }
+
+    bool claim(size_t& step) override {
+        step = 0;
+        return true;
+    }
+
+    bool run(size_t) override {
+        state_->run();
+        return true;
+    }
+
+    void fail(std::exception_ptr failure) override { state_->fail(failure); }
+
+private:
+    std::shared_ptr<QueryState<T>> state_;
+};
+
+} // namespace detail
+
+/**
+ * Runs queries from latency-sensitive and bulk callers on shared workers
+ *
+ * Interactive queries are served before bulk work, earliest deadline first.
+ * Bulk batch queries are split into chunks of SchedulerOptions::bulk_chunk
+ * locations, and a worker picks its next job after every chunk, so an
+ * interactive query waits for at most one chunk instead of a whole export.
+ * Reserving interactive_threads removes even that wait. Each lane has a
+ * bounded queue: submitting to a full lane fails the future with
+ * QueryRejected instead of growing without limit, and a query whose
+ * deadline passes while queued fails with QueryDeadlineExceeded without
+ * running. Queries on a worker run single-threaded; the pool is the
+ * parallelism.
+ *
+ * ```cpp
+ * QueryScheduler scheduler(world);
+ * auto biome = scheduler.submit(QueryLane::INTERACTIVE, [=](const World& w) {
+ *     return w.get_biome(lon, lat, w.get_terrain_height(lon, lat));
+ * }, std::chrono::steady_clock::now() + std::chrono::milliseconds(5));
+ * BatchFuture export_job = scheduler.batch_query(locations, types);  // BULK lane
+ * BiomeType b = biome.get();
+ * ```
+ *
+ * The World must outlive the scheduler. The destructor cancels queued
+ * queries and waits for running steps.
+ */
+class QueryScheduler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit QueryScheduler(const World& world, const SchedulerOptions& options = SchedulerOptions());
+    ~QueryScheduler();
+
+    QueryScheduler(const QueryScheduler&) = delete;
+    QueryScheduler& operator=(const QueryScheduler&) = delete;
+
+    /**
+     * Queue query(world) as one step
+     *
+     * @param lane Scheduling class
+     * @param query Callable taking const World& (any getter or combination)
+     * @param deadline Latest start time; the query fails unrun after it
+     */
+    template <typename F>
+    auto submit(QueryLane lane, F query, Clock::time_point deadline = Clock::time_point::max())
+        -> QueryFuture<std::decay_t<decltype(query(std::declval<const World&>()))>> {
+        using T = std::decay_t<decltype(query(std::declval<const World&>()))>;
+        const World& world = world_;
+        auto state = std::make_shared<detail::QueryState<T>>(
+            [query = std::move(query), &world]() { return query(world); }, 0.0f);
+        enqueue(lane, deadline, std::make_shared<detail::ScheduledCall<T>>(state));
+        return QueryFuture<T>(state);
+    }
+
+    /**
+     * Queue a batch query, split into chunks of bulk_chunk locations
+     *
+     * The deadline applies to every chunk: a batch still queued past it
+     * fails and its remaining chunks are dropped.
+     */
+    BatchFuture batch_query(const std::vector<Location>& locations, const std::vector<DataType>& data_types,
+                            QueryLane lane = QueryLane::BULK, Clock::time_point deadline = Clock::time_point::max());
+
+    /**
+     * Queue query(world, step) for every step in [0, steps) as one query
+     *
+     * The steps share one queue slot and are run like the chunks of
+     * batch_query, so interactive work can overtake between them. The
+     * future is true once every step has run, or fails with the first
+     * exception a step throws. The deadline applies as for batch_query.
+     */
+    QueryFuture<bool> submit_steps(QueryLane lane, size_t steps, std::function<void(const World&, size_t)> query,
+                                   Clock::time_point deadline = Clock::time_point::max());
+
+    /**
+     * Counters and latency histogram of a lane
+     */
+    LaneStats stats(QueryLane lane) const;
+
+    /**
+     * Zero the counters and histograms (depth and capacity are kept)
+     */
+    void reset_stats();
+
+    int thread_count() const;
+
+private:
+    void enqueue(QueryLane lane, Clock::time_point deadline, std::shared_ptr<detail::ScheduledQuery> query);
+
+    class Impl;
+    const World& world_;
+    std::unique_ptr<Impl> pimpl_;
+};
+
+} // namespace rworld
+
+#ifdef _RWORLD_IMPLEMENTATION
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace rworld {
+
+void LatencyHistogram::record(double seconds) {
+    double microseconds = seconds * 1e6;
+    int bucket = microseconds < 1.0 ? 0 : std::min(BUCKETS - 1, std::ilogb(microseconds));
+    counts[bucket]++;
+    total++;
+    sum += seconds;
+    max = std::max(max, seconds);
+}
+
+double LatencyHistogram::percentile(double p) const {
+    if (total == 0) {
+        return 0.0;
+    }
+    uint64_t rank = static_cast<uint64_t>(std::ceil(std::clamp(p, 0.0, 100.0) / 100.0 * static_cast<double>(total)));
+    uint64_t seen = 0;
+    for (int b = 0; b < BUCKETS; ++b) {
+        seen += counts[b];
+        if (seen >= std::max<uint64_t>(rank, 1)) {
+            return std::min(std::ldexp(1.0, b + 1) * 1e-6, max);
+        }
+    }
+    return max;
+}
+
+namespace detail {
+
+// A batch query run as chunks; the chunk that finishes last merges them
+class ScheduledBatch : public ScheduledQuery {
+public:
+    ScheduledBatch(const World& world, std::shared_ptr<QueryState<BatchResult>> state,
+                   const std::vector<Location>& locations, const std::vector<DataType>& data_types, size_t chunk)
+        : world_(world), state_(std::move(state)), locations_(locations), types_(data_types),
+          chunk_(std::max<size_t>(chunk, 1)) {
+        steps_ = std::max<size_t>(1, (locations_.size() + chunk_ - 1) / chunk_);
+        results_.resize(steps_);
+        remaining_ = steps_;
+    }
+
+    bool finished() const override { return state_->done(); }
+
+    bool claim(size_t& step) override {
+        step = next_++;
+        return step + 1 >= steps_;
+    }
+
+    bool run(size_t step) override {
+        // The first chunk to run moves the future to RUNNING, after which it
+        // can no longer be cancelled
+        state_->start();
+        if (!state_->done()) {
+            try {
+                size_t begin = step * chunk_;
+                size_t end = std::min(begin + chunk_, locations_.size());
+                std::vector<Location> chunk(locations_.begin() + begin, locations_.begin() + end);
+                results_[step] = world_.batch_query(chunk, types_);
+            } catch (...) {
+                state_->fail(std::current_exception());
+            }
+        }
+        if (--remaining_ > 0) {
+            return false;
+        }
+        if (!state_->done()) {
+            state_->fulfill(merge());
+        }
+        return true;
+    }
+
+    void fail(std::exception_ptr failure) override { state_->fail(failure); }
+
+private:
+    // Concatenate the chunks column by column; vector<bool> columns rule out
+    // chunks writing into one shared result
+    BatchResult merge() {
+        BatchResult merged;
+        merged.count = locations_.size();
+        std::vector<const void*> done;
+        for (DataType type : types_) {
+            visit_batch_column(merged, type, [&](auto& column) {
+                if (std::find(done.begin(), done.end(), &column) != done.end()) {
+                    return;  // Shared with an earlier type
+                }
+                done.push_back(&column);
+                using Column = std::decay_t<decltype(column)>;
+                for (BatchResult& part : results_) {
+                    visit_batch_column(part, type, [&](auto& source) {
+                        if constexpr (std::is_same<std::decay_t<decltype(source)>, Column>::value) {
+                            column.insert(column.end(), source.begin(), source.end());
+                        }
+                    });
+                }
+            });
+        }
+        return merged;
+    }
+
+    const World& world_;
+    std::shared_ptr<QueryState<BatchResult>> state_;
+    std::vector<Location> locations_;
+    std::vector<DataType> types_;
+    size_t chunk_;
+    size_t steps_;
+    std::atomic<size_t> next_{0};
+    std::atomic<size_t> remaining_{0};
+    std::vector<BatchResult> results_;
+};
+
+// Caller-defined steps sharing one queue slot
+class ScheduledSteps : public ScheduledQuery {
+public:
+    ScheduledSteps(const World& world, std::shared_ptr<QueryState<bool>> state, size_t steps,
+                   std::function<void(const World&, size_t)> query)
+        : world_(world), state_(std::move(state)), query_(std::move(query)), steps_(steps),
+          claims_(std::max<size_t>(steps, 1)), remaining_(claims_) {}
+
+    bool finished() const override { return state_->done(); }
+
+    bool claim(size_t& step) override {
+        step = next_++;
+        return step + 1 >= claims_;
+    }
+
+    bool run(size_t step) override {
+        state_->start();
+        if (!state_->done() && step < steps_) {
+            try {
+                query_(world_, step);
+            } catch (...) {
+                state_->fail(std::current_exception());
+            }
+        }
+        if (--remaining_ > 0) {
+            return false;
+        }
+        if (!state_->done()) {
+            state_->fulfill(true);
+        }
+        return true;
+    }
+
+    void fail(std::exception_ptr failure) override { state_->fail(failure); }
+
+private:
+    const World& world_;
+    std::shared_ptr<QueryState<bool>> state_;
+    std::function<void(const World&, size_t)> query_;
+    size_t steps_;
+    size_t claims_;  // At least one, so a query of no steps still completes
+    std::atomic<size_t> next_{0};
+    std::atomic<size_t> remaining_;
+};
+
+} // namespace detail
+
+class QueryScheduler::Impl {
+public:
+    struct Job {
+        std::shared_ptr<detail::ScheduledQuery> query;
+        Clock::time_point submitted;
+        Clock::time_point deadline;
+        uint64_t sequence = 0;
+    };
+
+    // Earliest deadline first, then submission order
+    static bool later(const Job& a, const Job& b) {
+        return a.deadline != b.deadline ? a.deadline > b.deadline : a.sequence > b.sequence;
+    }
+
+    SchedulerOptions options;
+    mutable std::mutex mutex;      // Guards everything below
+    std::condition_variable wake;  // Signals new work or shutdown
+    std::vector<Job> interactive;  // Heap ordered by later()
+    std::deque<Job> bulk;          // FIFO; the front batch stays queued until its last chunk is claimed
+    std::array<LaneStats, 2> stats;
+    uint64_t sequence = 0;
+    bool stopping = false;
+    std::vector<std::thread> threads;
+
+    explicit Impl(const SchedulerOptions& settings) : options(settings) {
+        int count = options.threads > 0 ? options.threads : detail::worker_count();
+        int reserved = std::clamp(options.interactive_threads, 0, count - 1);
+        stats[0].capacity = options.interactive_capacity;
+        stats[1].capacity = options.bulk_capacity;
+        for (int i = 0; i < count; ++i) {
+            bool interactive_only = i < reserved;
+            threads.emplace_back([this, interactive_only]() { loop(interactive_only); });
+        }
+    }
+
+    ~Impl() {
+        std::vector<Job> abandoned;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+            abandoned.swap(interactive);
+            abandoned.insert(abandoned.end(), bulk.begin(), bulk.end());
+            bulk.clear();
+        }
+        wake.notify_all();
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+        for (Job& job : abandoned) {
+            job.query->fail(std::make_exception_ptr(QueryCancelled()));
+        }
+    }
+
+    static size_t lane_index(QueryLane lane) { return lane == QueryLane::INTERACTIVE ? 0 : 1; }
+
+    void loop(bool interactive_only) {
+        detail::ParallelWorkerScope scope;
+        for (;;) {
+            Job job;
+            size_t lane = 0;
+            size_t step = 0;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [&]() {
+                    return stopping || !interactive.empty() || (!interactive_only && !bulk.empty());
+                });
+                if (stopping) {
+                    return;
+                }
+
+                lane = interactive.empty() ? 1 : 0;
+                if (lane == 0) {
+                    std::pop_heap(interactive.begin(), interactive.end(), later);
+                    job = std::move(interactive.back());
+                    interactive.pop_back();
+                } else {
+                    job = bulk.front();
+                }
+
+                if (job.query->finished()) {
+                    stats[lane].cancelled++;
+                    drop(lane);
+                    continue;
+                }
+                if (Clock::now() > job.deadline) {
+                    stats[lane].expired++;
+                    drop(lane);
+                    lock.unlock();
+                    job.query->fail(std::make_exception_ptr(QueryDeadlineExceeded()));
+                    continue;
+                }
+                if (job.query->claim(step)) {
+                    drop(lane);
+                } else {
+                    if (lane == 0) {
+                        // Requeue the batch so another worker can claim its next chunk
+                        interactive.push_back(job);
+                        std::push_heap(interactive.begin(), interactive.end(), later);
+                    }
+                    wake.notify_one();  // More chunks for another idle worker
+                }
+            }
+
+            if (job.query->run(step)) {
+                double latency = std::chrono::duration<double>(Clock::now() - job.submitted).count();
+                std::lock_guard<std::mutex> lock(mutex);
+                stats[lane].completed++;
+                stats[lane].latency.record(latency);
+            }
+        }
+    }
+
+    // Remove the job just taken from a lane (the heap pop already removed interactive ones)
+    void drop(size_t lane) {
+        if (lane == 1) {
+            bulk.pop_front();
+        }
+        stats[lane].depth--;
+    }
+};
+
+QueryScheduler::QueryScheduler(const World& world, const SchedulerOptions& options)
+    : world_(world), pimpl_(std::make_unique<Impl>(options)) {}
+
+QueryScheduler::~QueryScheduler() = default;
+
+void QueryScheduler::enqueue(QueryLane lane, Clock::time_point deadline,
+                             std::shared_ptr<detail::ScheduledQuery> query) {
+    size_t index = Impl::lane_index(lane);
+    {
+        std::lock_guard<std::mutex> lock(pimpl_->mutex);
+        LaneStats& stats = pimpl_->stats[index];
+        stats.submitted++;
+        if (!pimpl_->stopping && stats.depth < stats.capacity) {
+            Impl::Job job;
+            job.query = std::move(query);
+            job.submitted = Clock::now();
+            job.deadline = deadline;
+            job.sequence = pimpl_->sequence++;
+            if (index == 0) {
+                pimpl_->interactive.push_back(std::move(job));
+                std::push_heap(pimpl_->interactive.begin(), pimpl_->interactive.end(), Impl::later);
+            } else {
+                pimpl_->bulk.push_back(std::move(job));
+            }
+            stats.depth++;
+        } else {
+            stats.rejected++;
+        }
+    }
+    if (query) {
+        query->fail(std::make_exception_ptr(QueryRejected()));
+        return;
+    }
+    // Interactive work may only be runnable by a reserved worker, so wake them all
+    if (index == 0) {
+        pimpl_->wake.notify_all();
+    } else {
+        pimpl_->wake.notify_one();
+    }
+}
+
+BatchFuture QueryScheduler::batch_query(const std::vector<Location>& locations,
+                                        const std::vector<DataType>& data_types, QueryLane lane,
+                                        Clock::time_point deadline) {
+    auto state = std::make_shared<detail::QueryState<BatchResult>>(std::function<BatchResult()>(), 0.0f);
+    enqueue(lane, deadline,
+            std::make_shared<detail::ScheduledBatch>(world_, state, locations, data_types, pimpl_->options.bulk_chunk));
+    return BatchFuture(state);
+}
+
+QueryFuture<bool> QueryScheduler::submit_steps(QueryLane lane, size_t steps,
+                                               std::function<void(const World&, size_t)> query,
+                                               Clock::time_point deadline) {
+    auto state = std::make_shared<detail::QueryState<bool>>(std::function<bool()>(), 0.0f);
+    enqueue(lane, deadline, std::make_shared<detail::ScheduledSteps>(world_, state, steps, std::move(query)));
+    return QueryFuture<bool>(state);
+}
+
+LaneStats QueryScheduler::stats(QueryLane lane) const {
+    std::lock_guard<std::mutex> lock(pimpl_->mutex);
+    return pimpl_->stats[Impl::lane_index(lane)];
+}
+
+void QueryScheduler::reset_stats() {
+    std::lock_guard<std::mutex> lock(pimpl_->mutex);
+    for (LaneStats& stats : pimpl_->stats) {
+        LaneStats reset;
+        reset.depth = stats.depth;
+        reset.capacity = stats.capacity;
+        stats = reset;
+    }
+}
+
+int QueryScheduler::thread_count() const {
+    return static_cast<int>(pimpl_->threads.size());
+}
+
+} // namespace rworld
+
+#endif // _RWORLD_IMPLEMENTATION
+#endif // RWORLD_SCHEDULER_H
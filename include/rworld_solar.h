@@ -0,0 +1,267 @@
+#ifndef RWORLD_SOLAR_H
+#define RWORLD_SOLAR_H
+
+#include "rworld.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace rworld {
+
+/**
+ * Insolation at one site over a run of days
+ *
+ * Values are stored day-major: step s of day d is at index(d, s), at
+ * s * 24 / steps_per_day hours UTC (the time convention of get_insolation).
+ */
+struct SolarSeries {
+    float longitude = 0.0f;
+    float latitude = 0.0f;
+    int first_day = 0;                // Day of year of day 0
+    int days = 0;
+    int steps_per_day = 0;
+    float cloud_cover = 0.0f;         // get_cloud_cover() at the site
+    std::vector<float> insolation;    // W/m²
+    std::vector<float> solar_angle;   // Degrees above the horizon
+    std::vector<uint8_t> daylight;    // 1 while the sun is above the horizon
+
+    size_t index(int day, int step) const {
+        return static_cast<size_t>(day) * static_cast<size_t>(steps_per_day) + static_cast<size_t>(step);
+    }
+
+    /**
+     * Energy received over one day in Wh/m² (rectangle rule over the steps)
+     */
+    double daily_energy(int day) const;
+
+    /**
+     * Hours of daylight in one day, to the step resolution
+     */
+    double daylight_hours(int day) const;
+};
+
+/**
+ * Insolation, solar angle and daylight at one site for many days and times
+ *
+ * Cloud cover does not change with time, so the site is sampled once; each
+ * day contributes its declination terms and each step one hour-angle
+ * cosine shared by every day. The inner loop is plain arithmetic over the
+ * steps of a day. A year at hourly steps costs one noise evaluation instead
+ * of 8760 calls to get_insolation.
+ *
+ * Days wrap at 365. WorldConfig::day_of_year is ignored. Results match
+ * get_insolation and get_solar_angle to float rounding.
+ *
+ * @param world World to sample
+ * @param longitude Longitude in degrees
+ * @param latitude Latitude in degrees
+ * @param first_day Day of year of the first day (0-364)
+ * @param days Number of days
+ * @param steps_per_day Samples per day (24 = hourly)
+ */
+SolarSeries solar_time_series(const World& world, float longitude, float latitude,
+                              int first_day = 0, int days = 365, int steps_per_day = 24);
+
+/**
+ * Solar fields over a grid for any day and time
+ *
+ * The constructor samples cloud cover for every cell, which is the only part
+ * of insolation that needs noise. evaluate() then costs one cosine per
+ * column, one sine and cosine per row and a few multiplies per cell, so an
+ * animated day/night view or a sweep over the year reuses the same grid.
+ *
+ * Only INSOLATION, SOLAR_ANGLE and IS_DAYLIGHT are supported; other data
+ * types produce a layer of zeros. The World is not used after construction.
+ *
+ * ```cpp
+ * SolarGrid solar(world, region);
+ * GridResult frame;
+ * for (float t = 0.0f; t < 24.0f; t += 0.25f) {
+ *     solar.evaluate(172, t, {DataType::INSOLATION}, frame);
+ * }
+ * ```
+ */
+class SolarGrid {
+public:
+    SolarGrid(const World& world, const GridRegion& region);
+
+    /**
+     * Compute layers for a day of year and time
+     *
+     * @param day_of_year Day of year (0-364)
+     * @param current_time Time in hours (region.current_time is ignored)
+     * @param data_types Solar data types, one output layer each
+     * @param out Receives the grid; storage is reused across calls
+     */
+    void evaluate(int day_of_year, float current_time, const std::vector<DataType>& data_types,
+                  GridResult& out) const;
+
+    const GridRegion& region() const { return region_; }
+
+private:
+    GridRegion region_;
+    std::vector<float> longitudes_;    // Per column
+    std::vector<float> latitudes_;     // Per row
+    std::vector<float> transmission_;  // Per cell, fraction let through by clouds
+};
+
+} // namespace rworld
+
+#ifdef _RWORLD_IMPLEMENTATION
+#include <algorithm>
+#include <cmath>
+
+namespace rworld {
+
+namespace detail {
+
+// Insolation from sin(elevation), without the asin/sin round trip of
+// clear_sky_insolation; pow(0.7, m) is exp(m * ln 0.7)
+inline float solar_kernel_insolation(float sin_elevation, float transmission) {
+    if (sin_elevation <= 0.0f) {
+        return 0.0f;
+    }
+    float air_mass = std::clamp(1.0f / sin_elevation, 1.0f, 10.0f);
+    float insolation = 1361.0f * sin_elevation * std::exp(air_mass * -0.35667494f) * transmission;
+    return std::min(insolation, 1400.0f);
+}
+
+inline float solar_kernel_angle(float sin_elevation) {
+    return std::asin(std::clamp(sin_elevation, -1.0f, 1.0f)) * 57.29577951f;
+}
+
+} // namespace detail
+
+double SolarSeries::daily_energy(int day) const {
+    double sum = 0.0;
+    for (int step = 0; step < steps_per_day; ++step) {
+        sum += insolation[index(day, step)];
+    }
+    return steps_per_day > 0 ? sum * 24.0 / steps_per_day : 0.0;
+}
+
+double SolarSeries::daylight_hours(int day) const {
+    int count = 0;
+    for (int step = 0; step < steps_per_day; ++step) {
+        count += daylight[index(day, step)];
+    }
+    return steps_per_day > 0 ? count * 24.0 / steps_per_day : 0.0;
+}
+
+SolarSeries solar_time_series(const World& world, float longitude, float latitude,
+                              int first_day, int days, int steps_per_day) {
+    SolarSeries series;
+    series.longitude = longitude;
+    series.latitude = latitude;
+    series.first_day = first_day;
+    series.days = std::max(days, 0);
+    series.steps_per_day = std::max(steps_per_day, 0);
+    series.cloud_cover = world.get_cloud_cover(longitude, latitude);
+    size_t count = static_cast<size_t>(series.days) * static_cast<size_t>(series.steps_per_day);
+    series.insolation.resize(count);
+    series.solar_angle.resize(count);
+    series.daylight.resize(count);
+
+    float transmission = detail::cloud_transmission(series.cloud_cover);
+    std::vector<float> hour_cosine(series.steps_per_day);
+    for (int step = 0; step < series.steps_per_day; ++step) {
+        hour_cosine[step] = detail::solar_hour_cosine(longitude, step * 24.0f / series.steps_per_day);
+    }
+
+    std::vector<float> sin_elevation(series.steps_per_day);
+    for (int day = 0; day < series.days; ++day) {
+        int day_of_year = ((first_day + day) % 365 + 365) % 365;
+        detail::SolarLatitude terms = detail::solar_latitude(detail::solar_day(day_of_year), latitude);
+        for (int step = 0; step < series.steps_per_day; ++step) {
+            sin_elevation[step] = terms.a + terms.b * hour_cosine[step];
+        }
+
+        size_t offset = series.index(day, 0);
+        for (int step = 0; step < series.steps_per_day; ++step) {
+            float value = sin_elevation[step];
+            series.insolation[offset + step] = detail::solar_kernel_insolation(value, transmission);
+            series.solar_angle[offset + step] = detail::solar_kernel_angle(value);
+            series.daylight[offset + step] = value > 0.0f;
+        }
+    }
+    return series;
+}
+
+SolarGrid::SolarGrid(const World& world, const GridRegion& region) : region_(region) {
+    int width = std::max(region.width, 0);
+    int height = std::max(region.height, 0);
+    longitudes_.resize(width);
+    latitudes_.resize(height);
+    for (int column = 0; column < width; ++column) {
+        longitudes_[column] = detail::grid_longitude(region, column);
+    }
+    for (int row = 0; row < height; ++row) {
+        latitudes_[row] = detail::grid_latitude(region, row);
+    }
+
+    transmission_.resize(static_cast<size_t>(width) * static_cast<size_t>(height));
+    detail::parallel_for(height, [&](int row) {
+        float* out = transmission_.data() + static_cast<size_t>(row) * static_cast<size_t>(width);
+        for (int column = 0; column < width; ++column) {
+            out[column] = detail::cloud_transmission(world.get_cloud_cover(longitudes_[column], latitudes_[row]));
+        }
+    });
+}
+
+void SolarGrid::evaluate(int day_of_year, float current_time, const std::vector<DataType>& data_types,
+                         GridResult& out) const {
+    int width = static_cast<int>(longitudes_.size());
+    int height = static_cast<int>(latitudes_.size());
+    size_t cells = transmission_.size();
+    out.width = width;
+    out.row_begin = 0;
+    out.rows = height;
+    out.layers.resize(data_types.size());
+    for (std::vector<float>& layer : out.layers) {
+        layer.assign(cells, 0.0f);
+    }
+
+    detail::SolarDay day = detail::solar_day(((day_of_year % 365) + 365) % 365);
+    std::vector<float> hour_cosine(width);
+    for (int column = 0; column < width; ++column) {
+        hour_cosine[column] = detail::solar_hour_cosine(longitudes_[column], current_time);
+    }
+
+    detail::parallel_for(height, [&](int row) {
+        detail::SolarLatitude terms = detail::solar_latitude(day, latitudes_[row]);
+        size_t offset = static_cast<size_t>(row) * static_cast<size_t>(width);
+        std::vector<float> sin_elevation(width);
+        for (int column = 0; column < width; ++column) {
+            sin_elevation[column] = terms.a + terms.b * hour_cosine[column];
+        }
+
+        for (size_t i = 0; i < data_types.size(); ++i) {
+            float* layer = out.layers[i].data() + offset;
+            switch (data_types[i]) {
+                case DataType::INSOLATION:
+                    for (int column = 0; column < width; ++column) {
+                        layer[column] = detail::solar_kernel_insolation(sin_elevation[column],
+                                                                        transmission_[offset + column]);
+                    }
+                    break;
+                case DataType::SOLAR_ANGLE:
+                    for (int column = 0; column < width; ++column) {
+                        layer[column] = detail::solar_kernel_angle(sin_elevation[column]);
+                    }
+                    break;
+                case DataType::IS_DAYLIGHT:
+                    for (int column = 0; column < width; ++column) {
+                        layer[column] = sin_elevation[column] > 0.0f ? 1.0f : 0.0f;
+                    }
+                    break;
+                default:
+                    break;
+            }
+        }
+    });
+}
+
+} // namespace rworld
+
+#endif // _RWORLD_IMPLEMENTATION
+#endif // RWORLD_SOLAR_H
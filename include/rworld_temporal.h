@@ -0,0 +1,367 @@
+#ifndef RWORLD_TEMPORAL_H
+#define RWORLD_TEMPORAL_H
+
+#include "rworld.h"
+#include "rworld_quantize.h"
+
+#include <vector>
+
+namespace rworld {
+
+/**
+ * How values between keyframes are reconstructed
+ */
+enum class TemporalInterpolation {
+    LINEAR,  // Straight line between the two surrounding keyframes
+    CUBIC    // Catmull-Rom through the four surrounding keyframes
+};
+
+/**
+ * Settings for a temporal grid cache
+ */
+struct TemporalCacheOptions {
+    float keyframe_interval = 1.0f;  // Hours between keyframes (shortened to divide the range evenly)
+    TemporalInterpolation interpolation = TemporalInterpolation::LINEAR;
+
+    // Error budget, one entry per data type in the layer's units (empty or 0 =
+    // unchecked). Interval midpoints are compared against the world on every
+    // validation_stride-th cell, and the interval is halved (up to
+    // max_refinements times) until every checked layer is within budget.
+    std::vector<float> max_error;
+    int validation_stride = 8;
+    int max_refinements = 4;
+
+    // Keyframe encoding per data type (empty or missing = FLOAT32), e.g.
+    // default_quantization(types, config). Quantization error counts against
+    // max_error.
+    std::vector<LayerQuantization> storage;
+};
+
+/**
+ * Keyframed cache of time-varying fields over a grid
+ *
+ * Time-lapse playback asks for the same region at many times. The cache
+ * evaluates the grid at keyframes spread over [start_time, end_time] once;
+ * any time in between is then a memory lookup and an interpolation instead
+ * of noise evaluation. Intended for smoothly varying fields such as
+ * CURRENT_PRECIPITATION, CURRENT_WIND_SPEED, PRESSURE_AT_LOCATION or
+ * TEMPERATURE_AT_TIME. Enum and boolean types (e.g. IS_STORM_FRONT) take
+ * the nearest keyframe instead of being interpolated, and wind directions
+ * are interpolated along the shorter arc.
+ *
+ * Memory is one float per cell, layer and keyframe, or 0.5 to 2 bytes with
+ * quantized storage. The World must outlive the constructor only; sampling
+ * never touches it.
+ *
+ * ```cpp
+ * TemporalCacheOptions options;
+ * options.max_error = {0.5f};  // mm/h
+ * TemporalGridCache cache(world, region, {DataType::CURRENT_PRECIPITATION}, 0.0f, 48.0f, options);
+ * GridResult frame;
+ * for (float t = 0.0f; t <= 48.0f; t += 0.05f) {
+ *     cache.sample(t, frame);
+ * }
+ * ```
+ */
+class TemporalGridCache {
+public:
+    /**
+     * Evaluate keyframes for region over a time range
+     *
+     * region.current_time is ignored; every other region setting applies to
+     * all keyframes.
+     */
+    TemporalGridCache(const World& world, const GridRegion& region, const std::vector<DataType>& data_types,
+                      float start_time, float end_time, const TemporalCacheOptions& options = TemporalCacheOptions());
+
+    /**
+     * Interpolated grid at a time (clamped to the cached range)
+     *
+     * @param time Time in hours
+     * @param out Receives one layer per data type; storage is reused across calls
+     */
+    void sample(float time, GridResult& out) const;
+
+    /**
+     * Interpolated value of one cell (layer in data type order)
+     */
+    float value(size_t layer, int column, int row, float time) const;
+
+    float start_time() const { return start_time_; }
+    float end_time() const { return end_time_; }
+
+    /**
+     * Hours between keyframes after any refinement
+     */
+    float keyframe_interval() const { return interval_; }
+
+    size_t keyframe_count() const { return keyframes_.size(); }
+
+    /**
+     * Bytes held by the keyframes
+     */
+    size_t memory_bytes() const;
+
+    /**
+     * Largest interpolation error seen at the validation points, per data
+     * type (0 for unchecked layers)
+     */
+    const std::vector<float>& measured_error() const { return measured_error_; }
+
+private:
+    // Keyframe index and weights for a time
+    void locate(float time, int (&index)[4], float (&weight)[4], int& nearest) const;
+
+    GridRegion region_;
+    std::vector<DataType> types_;
+    std::vector<bool> categorical_;
+    std::vector<bool> angular_;  // Degrees that wrap at 360
+    TemporalInterpolation interpolation_;
+    float start_time_;
+    float end_time_;
+    float interval_ = 0.0f;
+    std::vector<QuantizedGrid> keyframes_;
+    std::vector<float> measured_error_;
+};
+
+} // namespace rworld
+
+#ifdef _RWORLD_IMPLEMENTATION
+#include <algorithm>
+#include <cmath>
+#include <type_traits>
+
+namespace rworld {
+
+namespace detail {
+
+inline bool is_direction(DataType type) {
+    return type == DataType::WIND_DIRECTION || type == DataType::CURRENT_WIND_DIRECTION;
+}
+
+// Keyframe directions a, b, c, d moved by whole turns so that each is
+// within 180 degrees of the one before, then weighted. The sum wraps back
+// into [0, 360).
+inline float interpolate_direction(const float (&weight)[4], float a, float b, float c, float d) {
+    a = b + std::remainder(a - b, 360.0f);
+    c = b + std::remainder(c - b, 360.0f);
+    d = c + std::remainder(d - c, 360.0f);
+    float result = std::fmod(weight[0] * a + weight[1] * b + weight[2] * c + weight[3] * d, 360.0f);
+    return result < 0.0f ? result + 360.0f : result;
+}
+
+} // namespace detail
+
+TemporalGridCache::TemporalGridCache(const World& world, const GridRegion& region,
+                                     const std::vector<DataType>& data_types, float start_time, float end_time,
+                                     const TemporalCacheOptions& options)
+    : region_(region), types_(data_types), categorical_(data_types.size(), false),
+      angular_(data_types.size(), false), interpolation_(options.interpolation), start_time_(std::min(start_time, end_time)),
+      end_time_(std::max(start_time, end_time)), measured_error_(data_types.size(), 0.0f) {
+    BatchResult probe;
+    for (size_t i = 0; i < types_.size(); ++i) {
+        detail::visit_batch_column(probe, types_[i], [&](const auto& column) {
+            using Value = typename std::decay_t<decltype(column)>::value_type;
+            categorical_[i] = std::is_enum<Value>::value || std::is_same<Value, bool>::value;
+        });
+        angular_[i] = detail::is_direction(types_[i]);
+    }
+
+    auto keyframe_at = [&](float time) {
+        GridRegion keyframe = region_;
+        keyframe.current_time = time;
+        return quantize_grid(world.grid_query(keyframe, types_), options.storage);
+    };
+
+    float span = end_time_ - start_time_;
+    int intervals = span > 0.0f ? std::max(1, static_cast<int>(std::ceil(span / std::max(options.keyframe_interval, 1e-3f)))) : 0;
+    for (int k = 0; k <= intervals; ++k) {
+        keyframes_.push_back(keyframe_at(intervals > 0 ? start_time_ + span * k / intervals : start_time_));
+    }
+    interval_ = intervals > 0 ? span / intervals : 0.0f;
+
+    bool checked = false;
+    for (size_t i = 0; i < types_.size() && i < options.max_error.size(); ++i) {
+        checked = checked || (options.max_error[i] > 0.0f && !categorical_[i]);
+    }
+    if (!checked || intervals == 0) {
+        return;
+    }
+
+    // Validation cells, shared by every check
+    int stride = std::max(1, options.validation_stride);
+    std::vector<int> cells;
+    std::vector<Location> locations;
+    for (int row = 0; row < region_.height; row += stride) {
+        float latitude = detail::grid_latitude(region_, row);
+        for (int column = 0; column < region_.width; column += stride) {
+            cells.push_back(column);
+            cells.push_back(row);
+            locations.emplace_back(detail::grid_longitude(region_, column), latitude, region_.altitude,
+                                   0.0f, region_.detail_level);
+        }
+    }
+    detail::BatchLayout layout(types_);
+    std::vector<float> truth(locations.size());
+
+    for (int refinement = 0;; ++refinement) {
+        // Compare every interval midpoint against the world
+        std::fill(measured_error_.begin(), measured_error_.end(), 0.0f);
+        bool within_budget = true;
+        for (int k = 0; k < intervals; ++k) {
+            float time = start_time_ + interval_ * (k + 0.5f);
+            for (Location& location : locations) {
+                location.current_time = time;
+            }
+            BatchResult batch = world.batch_query(locations, types_);
+            for (size_t i = 0; i < types_.size(); ++i) {
+                if (i >= options.max_error.size() || options.max_error[i] <= 0.0f || categorical_[i]) {
+                    continue;
+                }
+                layout.extract(batch, i, truth.data());
+                for (size_t n = 0; n < locations.size(); ++n) {
+                    float error = value(i, cells[n * 2], cells[n * 2 + 1], time) - truth[n];
+                    error = std::abs(angular_[i] ? std::remainder(error, 360.0f) : error);
+                    measured_error_[i] = std::max(measured_error_[i], error);
+                }
+                within_budget = within_budget && measured_error_[i] <= options.max_error[i];
+            }
+        }
+        if (within_budget || refinement >= options.max_refinements) {
+            return;
+        }
+
+        // Halve the interval, keeping the existing keyframes at even indices
+        std::vector<QuantizedGrid> refined;
+        refined.reserve(intervals * 2 + 1);
+        for (int k = 0; k <= intervals; ++k) {
+            refined.push_back(std::move(keyframes_[k]));
+            if (k < intervals) {
+                refined.push_back(keyframe_at(start_time_ + span * (2 * k + 1) / (2 * intervals)));
+            }
+        }
+        keyframes_ = std::move(refined);
+        intervals *= 2;
+        interval_ = span / intervals;
+    }
+}
+
+void TemporalGridCache::locate(float time, int (&index)[4], float (&weight)[4], int& nearest) const {
+    int last = static_cast<int>(keyframes_.size()) - 1;
+    float position = interval_ > 0.0f ? (std::clamp(time, start_time_, end_time_) - start_time_) / interval_ : 0.0f;
+    int k = std::clamp(static_cast<int>(position), 0, std::max(last - 1, 0));
+    float t = std::clamp(position - k, 0.0f, 1.0f);
+    nearest = std::min(t < 0.5f ? k : k + 1, last);
+
+    for (int n = 0; n < 4; ++n) {
+        index[n] = std::clamp(k - 1 + n, 0, last);
+    }
+    if (interpolation_ == TemporalInterpolation::CUBIC) {
+        // Catmull-Rom basis
+        float t2 = t * t;
+        float t3 = t2 * t;
+        weight[0] = 0.5f * (-t3 + 2.0f * t2 - t);
+        weight[1] = 0.5f * (3.0f * t3 - 5.0f * t2 + 2.0f);
+        weight[2] = 0.5f * (-3.0f * t3 + 4.0f * t2 + t);
+        weight[3] = 0.5f * (t3 - t2);
+    } else {
+        weight[0] = 0.0f;
+        weight[1] = 1.0f - t;
+        weight[2] = t;
+        weight[3] = 0.0f;
+    }
+}
+
+void TemporalGridCache::sample(float time, GridResult& out) const {
+    out.width = region_.width;
+    out.row_begin = 0;
+    out.rows = region_.height;
+    out.layers.resize(types_.size());
+    if (keyframes_.empty()) {
+        return;
+    }
+
+    int index[4];
+    float weight[4];
+    int nearest;
+    locate(time, index, weight, nearest);
+    // Quantized keyframes are decoded a chunk at a time into these
+    constexpr size_t chunk = 2048;
+    float scratch[4][chunk];
+    for (size_t i = 0; i < types_.size(); ++i) {
+        const QuantizedLayer& nearest_layer = keyframes_[nearest].layers[i];
+        std::vector<float>& layer = out.layers[i];
+        layer.resize(nearest_layer.size());
+        if (categorical_[i]) {
+            nearest_layer.decode(layer.data(), 0, layer.size());
+            continue;
+        }
+        for (size_t begin = 0; begin < layer.size(); begin += chunk) {
+            size_t count = std::min(chunk, layer.size() - begin);
+            const float* source[4];
+            for (int k = 0; k < 4; ++k) {
+                const QuantizedLayer& keyframe = keyframes_[index[k]].layers[i];
+                source[k] = keyframe.floats();
+                if (source[k]) {
+                    source[k] += begin;
+                } else {
+                    keyframe.decode(scratch[k], begin, count);
+                    source[k] = scratch[k];
+                }
+            }
+            const float* a = source[0];
+            const float* b = source[1];
+            const float* c = source[2];
+            const float* d = source[3];
+            float* result = layer.data() + begin;
+            if (angular_[i]) {
+                for (size_t n = 0; n < count; ++n) {
+                    result[n] = detail::interpolate_direction(weight, a[n], b[n], c[n], d[n]);
+                }
+                continue;
+            }
+            for (size_t n = 0; n < count; ++n) {
+                result[n] = weight[0] * a[n] + weight[1] * b[n] + weight[2] * c[n] + weight[3] * d[n];
+            }
+        }
+    }
+}
+
+float TemporalGridCache::value(size_t layer, int column, int row, float time) const {
+    if (keyframes_.empty()) {
+        return 0.0f;
+    }
+    int index[4];
+    float weight[4];
+    int nearest;
+    locate(time, index, weight, nearest);
+    size_t cell = static_cast<size_t>(row) * static_cast<size_t>(region_.width) + static_cast<size_t>(column);
+    if (categorical_[layer]) {
+        return keyframes_[nearest].layers[layer].value(cell);
+    }
+    if (angular_[layer]) {
+        float direction[4];
+        for (int n = 0; n < 4; ++n) {
+            direction[n] = keyframes_[index[n]].layers[layer].value(cell);
+        }
+        return detail::interpolate_direction(weight, direction[0], direction[1], direction[2], direction[3]);
+    }
+    float result = 0.0f;
+    for (int n = 0; n < 4; ++n) {
+        result += weight[n] * keyframes_[index[n]].layers[layer].value(cell);
+    }
+    return result;
+}
+
+size_t TemporalGridCache::memory_bytes() const {
+    size_t total = 0;
+    for (const QuantizedGrid& keyframe : keyframes_) {
+        total += keyframe.bytes();
+    }
+    return total;
+}
+
+} // namespace rworld
+
+#endif // _RWORLD_IMPLEMENTATION
+#endif // RWORLD_TEMPORAL_H
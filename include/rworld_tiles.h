@@ -0,0 +1,711 @@
+#ifndef RWORLD_TILES_H
+#define RWORLD_TILES_H
+
+#include "rworld.h"
+
+#include <functional>
+#include <string>
+
+namespace rworld {
+
+/**
+ * What each map tile shows
+ */
+enum class TileStyle {
+    BIOME,      // Biome colors
+    ELEVATION   // Hypsometric terrain colors
+};
+
+/**
+ * Settings for an XYZ (slippy map) tile pyramid
+ *
+ * Tiles use the Web Mercator scheme (z/x/y.png, y = 0 at the north edge).
+ */
+struct TilePyramidOptions {
+    std::string output_dir = "tiles";
+    int min_zoom = 0;
+    int max_zoom = 6;
+    int tile_size = 256;
+
+    // Only tiles touching this window are built
+    float west = -180.0f;
+    float south = -85.05112878f;
+    float east = 180.0f;
+    float north = 85.05112878f;
+
+    TileStyle style = TileStyle::BIOME;
+    bool resume = true;  // Keep tiles already on disk instead of rebuilding them
+    int threads = 0;     // Worker threads (0 = hardware threads or RWORLD_THREADS)
+    std::function<void(size_t tiles_done, size_t tiles_total)> progress; // Optional, called from workers
+};
+
+/**
+ * Counts reported by build_tile_pyramid
+ */
+struct TilePyramidStats {
+    size_t rendered = 0;     // Deepest-level tiles sampled from the world
+    size_t downsampled = 0;  // Coarser tiles built from their children
+    size_t reused = 0;       // Tiles kept from an earlier run
+};
+
+/**
+ * Build an XYZ tile pyramid for a world
+ *
+ * Only max_zoom tiles are sampled (via grid queries); every coarser tile is
+ * a 2x2 box filter of its four children, so the pyramid costs about a third
+ * more than its deepest level. Subtrees are scheduled on a work-stealing
+ * pool. Each tile is written to a temporary file and renamed into place,
+ * and parents are only written after their children, so an interrupted
+ * build resumes where it stopped: existing tiles (and whole subtrees under
+ * an existing parent) are reused.
+ *
+ * Tiles are RGBA PNGs with stored (uncompressed) deflate blocks to keep the
+ * library free of zlib; recompress them for serving if size matters.
+ *
+ * @param world World to sample
+ * @param options Zoom range, window, style and output settings
+ * @param stats Receives tile counts (may be null)
+ * @param error Receives a description when the build fails (may be null)
+ * @return true when every tile was written
+ */
+bool build_tile_pyramid(const World& world, const TilePyramidOptions& options,
+                        TilePyramidStats* stats = nullptr, std::string* error = nullptr);
+
+} // namespace rworld
+
+#ifdef _RWORLD_IMPLEMENTATION
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <exception>
+#include <filesystem>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace rworld {
+
+namespace detail {
+
+/**
+ * Work-stealing task pool
+ *
+ * Every worker owns a deque: it pushes and pops its own tasks at the back
+ * (depth first, cache friendly) while idle workers steal from the front of
+ * others (oldest, usually largest subtrees). run() returns once every task,
+ * including tasks pushed by tasks, has finished.
+ */
+class WorkStealingPool {
+public:
+    using Task = std::function<void()>;
+
+    explicit WorkStealingPool(int threads) : queues_(std::max(1, threads)) {}
+
+    void push(Task task) {
+        pending_++;
+        int self = current_worker();
+        Queue& queue = queues_[self >= 0 ? self : next_queue_++ % queues_.size()];
+        {
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            queue.tasks.push_back(std::move(task));
+        }
+        signal(false);
+    }
+
+    // Run all queued tasks on the calling thread plus threads - 1 helpers
+    void run() {
+        std::vector<std::thread> helpers;
+        for (size_t i = 1; i < queues_.size(); ++i) {
+            helpers.emplace_back([this, i]() { work(static_cast<int>(i)); });
+        }
+        work(0);
+        for (std::thread& helper : helpers) {
+            helper.join();
+        }
+        if (failure_) {
+            std::rethrow_exception(failure_);
+        }
+    }
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    static int& current_worker() {
+        thread_local int index = -1;
+        return index;
+    }
+
+    // Wakes idle workers after new work is queued or the last task finished
+    void signal(bool all) {
+        {
+            std::lock_guard<std::mutex> lock(idle_mutex_);
+            version_++;
+        }
+        if (all) {
+            idle_.notify_all();
+        } else {
+            idle_.notify_one();
+        }
+    }
+
+    bool take(int self, Task& task) {
+        {
+            Queue& own = queues_[self];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            if (!own.tasks.empty()) {
+                task = std::move(own.tasks.back());
+                own.tasks.pop_back();
+                return true;
+            }
+        }
+        for (size_t n = 1; n < queues_.size(); ++n) {
+            Queue& victim = queues_[(self + n) % queues_.size()];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.tasks.empty()) {
+                task = std::move(victim.tasks.front());
+                victim.tasks.pop_front();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void work(int self) {
+        current_worker() = self;
+        ParallelWorkerScope scope;
+        Task task;
+        while (pending_ > 0) {
+            size_t seen;
+            {
+                std::lock_guard<std::mutex> lock(idle_mutex_);
+                seen = version_;
+            }
+            if (!take(self, task)) {
+                // Sleep until a push or the end of the run changes the version
+                std::unique_lock<std::mutex> lock(idle_mutex_);
+                idle_.wait(lock, [&]() { return version_ != seen || pending_ == 0; });
+                continue;
+            }
+            if (!failed_) {
+                try {
+                    task();
+                } catch (...) {
+                    std::lock_guard<std::mutex> lock(failure_mutex_);
+                    if (!failure_) {
+                        failure_ = std::current_exception();
+                    }
+                    failed_ = true;
+                }
+            }
+            task = nullptr;
+            if (--pending_ == 0) {
+                signal(true);
+            }
+        }
+        current_worker() = -1;
+    }
+
+    std::vector<Queue> queues_;
+    std::atomic<size_t> pending_{0};
+    std::atomic<size_t> next_queue_{0};
+    std::atomic<bool> failed_{false};
+    std::exception_ptr failure_;
+    std::mutex failure_mutex_;
+    std::mutex idle_mutex_;
+    std::condition_variable idle_;
+    size_t version_ = 0;
+};
+
+inline uint32_t png_crc(const unsigned char* data, size_t length, uint32_t crc = 0) {
+    static const auto table = []() {
+        std::vector<uint32_t> t(256);
+        for (uint32_t n = 0; n < 256; ++n) {
+            uint32_t c = n;
+            for (int k = 0; k < 8; ++k) {
+                c = c & 1 ? 0xedb88320u ^ (c >> 1) : c >> 1;
+            }
+            t[n] = c;
+        }
+        return t;
+    }();
+    crc = ~crc;
+    for (size_t i = 0; i < length; ++i) {
+        crc = table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+inline void put_u32_be(std::vector<unsigned char>& out, uint32_t value) {
+    out.push_back(static_cast<unsigned char>(value >> 24));
+    out.push_back(static_cast<unsigned char>(value >> 16));
+    out.push_back(static_cast<unsigned char>(value >> 8));
+    out.push_back(static_cast<unsigned char>(value));
+}
+
+inline uint32_t get_u32_be(const unsigned char* in) {
+    return (static_cast<uint32_t>(in[0]) << 24) | (static_cast<uint32_t>(in[1]) << 16) |
+           (static_cast<uint32_t>(in[2]) << 8) | static_cast<uint32_t>(in[3]);
+}
+
+inline void png_chunk(std::vector<unsigned char>& out, const char* type, const std::vector<unsigned char>& data) {
+    put_u32_be(out, static_cast<uint32_t>(data.size()));
+    size_t start = out.size();
+    out.insert(out.end(), type, type + 4);
+    out.insert(out.end(), data.begin(), data.end());
+    put_u32_be(out, png_crc(out.data() + start, out.size() - start));
+}
+
+/**
+ * Encode 8-bit RGBA pixels as a PNG with stored deflate blocks
+ */
+inline std::vector<unsigned char> encode_png_rgba(const std::vector<unsigned char>& pixels, int width, int height) {
+    // Raw scanlines, each prefixed with filter type 0
+    size_t stride = static_cast<size_t>(width) * 4;
+    std::vector<unsigned char> raw;
+    raw.reserve((stride + 1) * height);
+    for (int y = 0; y < height; ++y) {
+        raw.push_back(0);
+        raw.insert(raw.end(), pixels.begin() + y * stride, pixels.begin() + (y + 1) * stride);
+    }
+
+    std::vector<unsigned char> zlib = {0x78, 0x01};
+    uint32_t a = 1, b = 0;
+    for (size_t pos = 0; pos < raw.size();) {
+        size_t length = std::min<size_t>(raw.size() - pos, 65535);
+        bool last = pos + length == raw.size();
+        zlib.push_back(last ? 1 : 0);
+        zlib.push_back(static_cast<unsigned char>(length & 0xff));
+        zlib.push_back(static_cast<unsigned char>(length >> 8));
+        zlib.push_back(static_cast<unsigned char>(~length & 0xff));
+        zlib.push_back(static_cast<unsigned char>((~length >> 8) & 0xff));
+        for (size_t i = pos; i < pos + length; ++i) {
+            a = (a + raw[i]) % 65521;
+            b = (b + a) % 65521;
+        }
+        zlib.insert(zlib.end(), raw.begin() + pos, raw.begin() + pos + length);
+        pos += length;
+    }
+    put_u32_be(zlib, (b << 16) | a);
+
+    std::vector<unsigned char> png = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+    std::vector<unsigned char> header;
+    put_u32_be(header, static_cast<uint32_t>(width));
+    put_u32_be(header, static_cast<uint32_t>(height));
+    header.insert(header.end(), {8, 6, 0, 0, 0}); // 8-bit RGBA, no interlace
+    png_chunk(png, "IHDR", header);
+    png_chunk(png, "IDAT", zlib);
+    png_chunk(png, "IEND", {});
+    return png;
+}
+
+/**
+ * Decode a PNG written by encode_png_rgba
+ *
+ * Anything else (compressed, filtered, other layouts) is rejected, which
+ * makes a resumed build re-render the tile.
+ */
+inline bool decode_png_rgba(const std::vector<unsigned char>& png, int width, int height,
+                            std::vector<unsigned char>& pixels) {
+    static const unsigned char signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+    if (png.size() < 8 || !std::equal(signature, signature + 8, png.begin())) {
+        return false;
+    }
+
+    std::vector<unsigned char> zlib;
+    bool header_ok = false;
+    for (size_t pos = 8; pos + 12 <= png.size();) {
+        uint32_t length = get_u32_be(&png[pos]);
+        if (pos + 12 + length > png.size()) {
+            return false;
+        }
+        const unsigned char* type = &png[pos + 4];
+        const unsigned char* data = &png[pos + 8];
+        if (std::equal(type, type + 4, "IHDR")) {
+            header_ok = length == 13 && get_u32_be(data) == static_cast<uint32_t>(width) &&
+                        get_u32_be(data + 4) == static_cast<uint32_t>(height) &&
+                        data[8] == 8 && data[9] == 6 && data[12] == 0;
+        } else if (std::equal(type, type + 4, "IDAT")) {
+            zlib.insert(zlib.end(), data, data + length);
+        }
+        pos += 12 + length;
+    }
+    if (!header_ok || zlib.size() < 6) {
+        return false;
+    }
+
+    size_t stride = static_cast<size_t>(width) * 4;
+    std::vector<unsigned char> raw;
+    raw.reserve((stride + 1) * height);
+    size_t pos = 2;
+    for (bool last = false; !last;) {
+        if (pos + 5 > zlib.size() || (zlib[pos] & 0x06) != 0) {
+            return false; // Only stored blocks
+        }
+        last = zlib[pos] & 1;
+        size_t length = zlib[pos + 1] | (zlib[pos + 2] << 8);
+        pos += 5;
+        if (pos + length > zlib.size()) {
+            return false;
+        }
+        raw.insert(raw.end(), zlib.begin() + pos, zlib.begin() + pos + length);
+        pos += length;
+    }
+    if (raw.size() != (stride + 1) * height) {
+        return false;
+    }
+
+    pixels.resize(stride * height);
+    for (int y = 0; y < height; ++y) {
+        const unsigned char* line = &raw[y * (stride + 1)];
+        if (line[0] != 0) {
+            return false;
+        }
+        std::copy(line + 1, line + 1 + stride, pixels.begin() + y * stride);
+    }
+    return true;
+}
+
+inline void tile_biome_color(BiomeType biome, unsigned char* rgba) {
+    unsigned char r = 128, g = 128, b = 128;
+    switch (biome) {
+        case BiomeType::DEEP_OCEAN: r = 0; g = 0; b = 139; break;
+        case BiomeType::OCEAN: r = 0; g = 105; b = 148; break;
+        case BiomeType::BEACH: r = 238; g = 214; b = 175; break;
+        case BiomeType::ICE: r = 240; g = 248; b = 255; break;
+        case BiomeType::SNOW: r = 255; g = 250; b = 250; break;
+        case BiomeType::TUNDRA: r = 150; g = 180; b = 150; break;
+        case BiomeType::TAIGA: r = 89; g = 115; b = 90; break;
+        case BiomeType::MOUNTAIN_PEAK: r = 200; g = 200; b = 210; break;
+        case BiomeType::MOUNTAIN_TUNDRA: r = 170; g = 180; b = 170; break;
+        case BiomeType::MOUNTAIN_FOREST: r = 100; g = 130; b = 100; break;
+        case BiomeType::COLD_DESERT: r = 200; g = 180; b = 160; break;
+        case BiomeType::GRASSLAND: r = 144; g = 188; b = 70; break;
+        case BiomeType::TEMPERATE_DECIDUOUS_FOREST: r = 80; g = 150; b = 80; break;
+        case BiomeType::TEMPERATE_RAINFOREST: r = 50; g = 130; b = 80; break;
+        case BiomeType::DESERT: r = 230; g = 200; b = 120; break;
+        case BiomeType::SAVANNA: r = 200; g = 180; b = 100; break;
+        case BiomeType::TROPICAL_SEASONAL_FOREST: r = 100; g = 160; b = 80; break;
+        case BiomeType::TROPICAL_RAINFOREST: r = 40; g = 120; b = 60; break;
+    }
+    rgba[0] = r; rgba[1] = g; rgba[2] = b; rgba[3] = 255;
+}
+
+inline void tile_height_color(float height, unsigned char* rgba) {
+    unsigned char r, g, b;
+    if (height < -2000) { r = 0; g = 0; b = 80; }         // Deep ocean
+    else if (height < -500) { r = 0; g = 50; b = 120; }   // Ocean
+    else if (height < 0) { r = 0; g = 100; b = 160; }     // Shallow water
+    else if (height < 100) { r = 100; g = 180; b = 100; } // Low plains
+    else if (height < 500) { r = 130; g = 190; b = 80; }  // Plains
+    else if (height < 1000) { r = 160; g = 160; b = 100; } // Hills
+    else if (height < 2000) { r = 140; g = 130; b = 100; } // Low mountains
+    else if (height < 4000) { r = 180; g = 170; b = 150; } // Mountains
+    else { r = 240; g = 240; b = 240; }                    // High peaks
+    rgba[0] = r; rgba[1] = g; rgba[2] = b; rgba[3] = 255;
+}
+
+inline double tile_mercator_y(float latitude) {
+    const double deg = 3.14159265358979323846 / 180.0;
+    double clamped = std::clamp(static_cast<double>(latitude), -85.05112878, 85.05112878);
+    return std::log(std::tan(45.0 * deg + clamped * deg * 0.5));
+}
+
+inline float tile_latitude(int y, int z) {
+    const double pi = 3.14159265358979323846;
+    double n = pi * (1.0 - 2.0 * y / static_cast<double>(1 << z));
+    return static_cast<float>(std::atan(std::sinh(n)) * 180.0 / pi);
+}
+
+/**
+ * Inclusive tile index ranges at zoom z touching the options window
+ */
+struct TileRange {
+    int x0, x1, y0, y1;
+
+    TileRange(const TilePyramidOptions& options, int z) {
+        const double pi = 3.14159265358979323846;
+        int n = 1 << z;
+        double left = (options.west + 180.0) / 360.0 * n;
+        double right = (options.east + 180.0) / 360.0 * n;
+        double top = (1.0 - tile_mercator_y(options.north) / pi) * 0.5 * n;
+        double bottom = (1.0 - tile_mercator_y(options.south) / pi) * 0.5 * n;
+        
+        // A window edge lying exactly on a tile boundary does not pull in the next tile
+        x0 = std::clamp(static_cast<int>(std::floor(left)), 0, n - 1);
+        x1 = std::clamp(static_cast<int>(std::ceil(right)) - 1, x0, n - 1);
+        y0 = std::clamp(static_cast<int>(std::floor(top)), 0, n - 1);
+        y1 = std::clamp(static_cast<int>(std::ceil(bottom)) - 1, y0, n - 1);
+    }
+
+    bool contains(int x, int y) const { return x >= x0 && x <= x1 && y >= y0 && y <= y1; }
+    size_t count() const { return static_cast<size_t>(x1 - x0 + 1) * static_cast<size_t>(y1 - y0 + 1); }
+};
+
+/**
+ * Builds one pyramid; every tile in flight is a Node
+ *
+ * A node either renders (max zoom), is reused from disk, or waits for its
+ * children: the last child to finish schedules the parent's downsample, so
+ * no worker ever blocks on another.
+ */
+class TilePyramidBuilder {
+public:
+    TilePyramidBuilder(const World& world, const TilePyramidOptions& options)
+        : world_(world), options_(options), pool_(options.threads > 0 ? options.threads : worker_count()) {
+        for (int z = 0; z <= options.max_zoom; ++z) {
+            ranges_.emplace_back(options, z);
+        }
+        for (int z = options.min_zoom; z <= options.max_zoom; ++z) {
+            total_ += ranges_[z].count();
+        }
+    }
+
+    void build(TilePyramidStats& stats) {
+        const TileRange& roots = ranges_[options_.min_zoom];
+        for (int y = roots.y0; y <= roots.y1; ++y) {
+            for (int x = roots.x0; x <= roots.x1; ++x) {
+                roots_.emplace_back(new Node(options_.min_zoom, x, y, nullptr));
+                Node* node = roots_.back().get();
+                pool_.push([this, node]() { visit(node); });
+            }
+        }
+        pool_.run();
+        stats.rendered = rendered_;
+        stats.downsampled = downsampled_;
+        stats.reused = reused_;
+    }
+
+private:
+    struct Node {
+        int z, x, y;
+        Node* parent;
+        std::atomic<int> pending{0};
+        std::vector<unsigned char> pixels;
+        std::unique_ptr<Node> children[4]; // Freed by the parent's downsample
+
+        Node(int z_, int x_, int y_, Node* parent_) : z(z_), x(x_), y(y_), parent(parent_) {}
+    };
+
+    std::string path(const Node& node) const {
+        return options_.output_dir + "/" + std::to_string(node.z) + "/" + std::to_string(node.x) + "/" +
+               std::to_string(node.y) + ".png";
+    }
+
+    // Tiles under (z, x, y) inside the window, itself included
+    size_t subtree_count(int z, int x, int y) const {
+        size_t count = 0;
+        for (int level = z; level <= options_.max_zoom; ++level) {
+            int shift = level - z;
+            const TileRange& r = ranges_[level];
+            int x0 = std::max(r.x0, x << shift), x1 = std::min(r.x1, ((x + 1) << shift) - 1);
+            int y0 = std::max(r.y0, y << shift), y1 = std::min(r.y1, ((y + 1) << shift) - 1);
+            if (x0 <= x1 && y0 <= y1) {
+                count += static_cast<size_t>(x1 - x0 + 1) * static_cast<size_t>(y1 - y0 + 1);
+            }
+        }
+        return count;
+    }
+
+    void advance(size_t tiles) {
+        size_t done = done_ += tiles;
+        if (options_.progress) {
+            std::lock_guard<std::mutex> lock(progress_mutex_);
+            options_.progress(done, total_);
+        }
+    }
+
+    bool load(Node* node) {
+        std::FILE* file = std::fopen(path(*node).c_str(), "rb");
+        if (!file) {
+            return false;
+        }
+        std::vector<unsigned char> png;
+        unsigned char chunk[65536];
+        for (size_t n; (n = std::fread(chunk, 1, sizeof(chunk), file)) > 0;) {
+            png.insert(png.end(), chunk, chunk + n);
+        }
+        std::fclose(file);
+        return decode_png_rgba(png, options_.tile_size, options_.tile_size, node->pixels);
+    }
+
+    void save(const Node& node) {
+        std::string target = path(node);
+        std::filesystem::create_directories(std::filesystem::path(target).parent_path());
+        std::vector<unsigned char> png = encode_png_rgba(node.pixels, options_.tile_size, options_.tile_size);
+
+        // Write then rename so an interrupted build never leaves a partial tile
+        std::string temporary = target + ".tmp";
+        std::FILE* file = std::fopen(temporary.c_str(), "wb");
+        bool ok = file && std::fwrite(png.data(), 1, png.size(), file) == png.size();
+        ok = file && std::fclose(file) == 0 && ok;
+        std::error_code ec;
+        if (ok) {
+            std::filesystem::rename(temporary, target, ec);
+        }
+        if (!ok || ec) {
+            throw std::runtime_error("cannot write " + target);
+        }
+    }
+
+    void visit(Node* node) {
+        // An existing tile is only ever written after its whole subtree
+        if (options_.resume && std::filesystem::exists(path(*node))) {
+            if (!node->parent || load(node)) {
+                reused_++;
+                advance(subtree_count(node->z, node->x, node->y));
+                finish(node);
+                return;
+            }
+        }
+
+        if (node->z == options_.max_zoom) {
+            render(node);
+            save(*node);
+            rendered_++;
+            advance(1);
+            finish(node);
+            return;
+        }
+
+        const TileRange& below = ranges_[node->z + 1];
+        int spawned = 0;
+        for (int i = 0; i < 4; ++i) {
+            int cx = node->x * 2 + (i & 1);
+            int cy = node->y * 2 + (i >> 1);
+            if (below.contains(cx, cy)) {
+                node->children[i].reset(new Node(node->z + 1, cx, cy, node));
+                spawned++;
+            }
+        }
+        node->pending = spawned;
+        for (auto& child : node->children) {
+            if (child) {
+                Node* pointer = child.get();
+                pool_.push([this, pointer]() { visit(pointer); });
+            }
+        }
+    }
+
+    // Called once a node's pixels are final; wakes the parent after its last child
+    void finish(Node* node) {
+        Node* parent = node->parent;
+        if (!parent) {
+            node->pixels = std::vector<unsigned char>();
+            return;
+        }
+        if (--parent->pending == 0) {
+            pool_.push([this, parent]() { downsample(parent); });
+        }
+    }
+
+    void render(Node* node) {
+        int size = options_.tile_size;
+        int n = 1 << node->z;
+        GridRegion region;
+        region.west = node->x * 360.0f / n - 180.0f;
+        region.east = (node->x + 1) * 360.0f / n - 180.0f;
+        region.north = tile_latitude(node->y, node->z);
+        region.south = tile_latitude(node->y + 1, node->z);
+        region.width = size;
+        region.height = size;
+        region.projection = GridProjection::WEB_MERCATOR;
+
+        DataType type = options_.style == TileStyle::BIOME ? DataType::BIOME : DataType::TERRAIN_HEIGHT;
+        GridResult grid = world_.grid_query(region, {type});
+        const std::vector<float>& values = grid.layers[0];
+
+        node->pixels.resize(static_cast<size_t>(size) * size * 4);
+        for (size_t i = 0; i < values.size(); ++i) {
+            if (options_.style == TileStyle::BIOME) {
+                tile_biome_color(static_cast<BiomeType>(static_cast<int>(values[i])), &node->pixels[i * 4]);
+            } else {
+                tile_height_color(values[i], &node->pixels[i * 4]);
+            }
+        }
+    }
+
+    // 2x2 box filter of the four children; missing children are transparent
+    void downsample(Node* node) {
+        int size = options_.tile_size;
+        int half = size / 2;
+        node->pixels.assign(static_cast<size_t>(size) * size * 4, 0);
+        for (int i = 0; i < 4; ++i) {
+            Node* child = node->children[i].get();
+            if (!child) {
+                continue;
+            }
+            int ox = (i & 1) * half;
+            int oy = (i >> 1) * half;
+            const unsigned char* src = child->pixels.data();
+            for (int y = 0; y < half; ++y) {
+                for (int x = 0; x < half; ++x) {
+                    unsigned char* dst = &node->pixels[(static_cast<size_t>(oy + y) * size + ox + x) * 4];
+                    const unsigned char* p00 = src + (static_cast<size_t>(2 * y) * size + 2 * x) * 4;
+                    const unsigned char* p10 = p00 + 4;
+                    const unsigned char* p01 = p00 + static_cast<size_t>(size) * 4;
+                    const unsigned char* p11 = p01 + 4;
+                    for (int c = 0; c < 4; ++c) {
+                        dst[c] = static_cast<unsigned char>((p00[c] + p10[c] + p01[c] + p11[c] + 2) / 4);
+                    }
+                }
+            }
+            node->children[i].reset();
+        }
+
+        save(*node);
+        downsampled_++;
+        advance(1);
+        finish(node);
+    }
+
+    const World& world_;
+    const TilePyramidOptions& options_;
+    WorkStealingPool pool_;
+    std::vector<TileRange> ranges_;
+    std::vector<std::unique_ptr<Node>> roots_;
+    size_t total_ = 0;
+    std::atomic<size_t> done_{0};
+    std::atomic<size_t> rendered_{0};
+    std::atomic<size_t> downsampled_{0};
+    std::atomic<size_t> reused_{0};
+    std::mutex progress_mutex_;
+};
+
+} // namespace detail
+
+bool build_tile_pyramid(const World& world, const TilePyramidOptions& options,
+                        TilePyramidStats* stats, std::string* error) {
+    if (options.min_zoom < 0 || options.max_zoom < options.min_zoom || options.max_zoom > 24 ||
+        options.tile_size < 2 || options.tile_size % 2 != 0) {
+        if (error) {
+            *error = "invalid zoom range or tile size";
+        }
+        return false;
+    }
+
+    TilePyramidStats local;
+    try {
+        detail::TilePyramidBuilder builder(world, options);
+        builder.build(local);
+    } catch (const std::exception& e) {
+        if (error) {
+            *error = e.what();
+        }
+        return false;
+    }
+    if (stats) {
+        *stats = local;
+    }
+    return true;
+}
+
+} // namespace rworld
+
+#endif // _RWORLD_IMPLEMENTATION
+#endif // RWORLD_TILES_H
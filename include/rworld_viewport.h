@@ -0,0 +1,234 @@
+#ifndef RWORLD_VIEWPORT_H
+#define RWORLD_VIEWPORT_H
+
+#include "rworld.h"
+
+#include <vector>
+
+namespace rworld {
+
+/**
+ * Keeps the last grid of a scrolling viewport and reuses it on pan
+ *
+ * When a view pans by whole cells, almost every sample of the new grid was
+ * already computed for the previous one. update() shifts the cached layers
+ * and samples only the newly exposed rows and columns, so scrolling costs
+ * O(width + height) samples per frame instead of O(width * height). Any
+ * other change (zoom, resolution, data types, altitude, time, detail level
+ * or projection) recomputes the whole grid.
+ *
+ * Pans are recognised when the new bounds sit a whole number of cells from
+ * the cached ones (within 1% of a cell; longitude offsets wrap at 360
+ * degrees), so callers should move their view in whole cells. Reused cells
+ * carry the previous grid's coordinates, which differ from a fresh query
+ * only by float rounding.
+ *
+ * Not thread safe; the World must outlive the cache.
+ *
+ * ```cpp
+ * ViewportSampleCache cache(world);
+ * const GridResult& grid = cache.update(region, {DataType::TERRAIN_HEIGHT});
+ * // Pan one cell east and update again: only the new column is sampled
+ * ```
+ */
+class ViewportSampleCache {
+public:
+    explicit ViewportSampleCache(const World& world) : world_(world) {}
+
+    /**
+     * Return the grid for region, reusing cached cells when it is a pan
+     *
+     * @param region Viewport grid
+     * @param data_types Data types to retrieve, one output layer each
+     * @return Grid for the whole region, valid until the next call
+     */
+    const GridResult& update(const GridRegion& region, const std::vector<DataType>& data_types);
+
+    /**
+     * True when update() would only sample exposed strips for this region
+     */
+    bool can_reuse(const GridRegion& region, const std::vector<DataType>& data_types) const;
+
+    /**
+     * Adopt a grid computed elsewhere (e.g. the final pass of a progressive
+     * render) as the cached state
+     */
+    void assign(const GridRegion& region, const std::vector<DataType>& data_types, GridResult grid);
+
+    /**
+     * Drop the cached grid; the next update() recomputes everything
+     */
+    void clear();
+
+    /**
+     * Cached grid from the last update() or assign()
+     */
+    const GridResult& grid() const { return grid_; }
+
+    /**
+     * Number of cells sampled by the last update()
+     */
+    size_t last_sampled() const { return last_sampled_; }
+
+private:
+    bool pan_offset(const GridRegion& region, const std::vector<DataType>& data_types, int& dx, int& dy) const;
+
+    const World& world_;
+    GridRegion region_;
+    std::vector<DataType> types_;
+    GridResult grid_;
+    GridResult scratch_;
+    bool valid_ = false;
+    size_t last_sampled_ = 0;
+};
+
+} // namespace rworld
+
+#ifdef _RWORLD_IMPLEMENTATION
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+namespace rworld {
+
+namespace detail {
+
+// Row coordinate in which a region's rows are evenly spaced
+inline double grid_row_coordinate(GridProjection projection, float latitude) {
+    if (projection == GridProjection::WEB_MERCATOR) {
+        const double deg = 3.14159265358979323846 / 180.0;
+        return std::log(std::tan(45.0 * deg + latitude * deg * 0.5));
+    }
+    return latitude;
+}
+
+} // namespace detail
+
+bool ViewportSampleCache::pan_offset(const GridRegion& region, const std::vector<DataType>& data_types,
+                                     int& dx, int& dy) const {
+    const double tolerance = 0.01; // Of a cell
+    if (!valid_ || data_types != types_ || region.width != region_.width || region.height != region_.height ||
+        region.width <= 0 || region.height <= 0 || region.altitude != region_.altitude ||
+        region.current_time != region_.current_time || region.detail_level != region_.detail_level ||
+        region.projection != region_.projection) {
+        return false;
+    }
+
+    // Same cell size, to within the drift tolerated across the whole grid
+    double cell_width = (static_cast<double>(region_.east) - region_.west) / region_.width;
+    double span_change = (static_cast<double>(region.east) - region.west) - (static_cast<double>(region_.east) - region_.west);
+    double top = detail::grid_row_coordinate(region_.projection, region_.north);
+    double cell_height = (top - detail::grid_row_coordinate(region_.projection, region_.south)) / region_.height;
+    double new_top = detail::grid_row_coordinate(region.projection, region.north);
+    double height_change = (new_top - detail::grid_row_coordinate(region.projection, region.south)) -
+                           (top - detail::grid_row_coordinate(region_.projection, region_.south));
+    if (cell_width == 0.0 || cell_height == 0.0 ||
+        std::abs(span_change) > tolerance * std::abs(cell_width) ||
+        std::abs(height_change) > tolerance * std::abs(cell_height)) {
+        return false;
+    }
+
+    // Whole-cell offsets; new cell (c, r) was old cell (c + dx, r + dy)
+    double columns = std::remainder(static_cast<double>(region.west) - region_.west, 360.0) / cell_width;
+    double rows = (top - new_top) / cell_height;
+    if (std::abs(columns - std::round(columns)) > tolerance || std::abs(rows - std::round(rows)) > tolerance) {
+        return false;
+    }
+    dx = static_cast<int>(std::round(columns));
+    dy = static_cast<int>(std::round(rows));
+    return true;
+}
+
+bool ViewportSampleCache::can_reuse(const GridRegion& region, const std::vector<DataType>& data_types) const {
+    int dx = 0, dy = 0;
+    return pan_offset(region, data_types, dx, dy) && std::abs(dx) < region.width && std::abs(dy) < region.height;
+}
+
+const GridResult& ViewportSampleCache::update(const GridRegion& region, const std::vector<DataType>& data_types) {
+    int dx = 0, dy = 0;
+    if (!pan_offset(region, data_types, dx, dy) || std::abs(dx) >= region.width || std::abs(dy) >= region.height) {
+        assign(region, data_types, world_.grid_query(region, data_types));
+        last_sampled_ = static_cast<size_t>(grid_.width) * static_cast<size_t>(grid_.rows);
+        return grid_;
+    }
+    if (dx == 0 && dy == 0) {
+        region_ = region;
+        last_sampled_ = 0;
+        return grid_;
+    }
+
+    int width = region.width;
+    int height = region.height;
+    size_t cells = static_cast<size_t>(width) * static_cast<size_t>(height);
+    scratch_.width = width;
+    scratch_.row_begin = 0;
+    scratch_.rows = height;
+    scratch_.layers.resize(data_types.size());
+    for (std::vector<float>& layer : scratch_.layers) {
+        layer.resize(cells);
+    }
+
+    // Columns [keep_begin, keep_end) of rows that stay in view are cached
+    int keep_begin = std::max(0, -dx);
+    int keep_end = std::min(width, width - dx);
+    detail::BatchLayout layout(data_types);
+    std::atomic<size_t> sampled(0);
+
+    detail::parallel_for(height, [&](int row) {
+        size_t offset = static_cast<size_t>(row) * static_cast<size_t>(width);
+        int old_row = row + dy;
+        bool cached_row = old_row >= 0 && old_row < height;
+        if (cached_row) {
+            size_t old_offset = static_cast<size_t>(old_row) * static_cast<size_t>(width);
+            for (size_t i = 0; i < data_types.size(); ++i) {
+                const float* source = grid_.layers[i].data() + old_offset + keep_begin + dx;
+                std::copy(source, source + (keep_end - keep_begin), scratch_.layers[i].data() + offset + keep_begin);
+            }
+        }
+
+        // Exposed cells: the whole row, or the strip left or right of the kept columns
+        int begin = cached_row ? (dx < 0 ? 0 : keep_end) : 0;
+        int end = cached_row ? (dx < 0 ? keep_begin : width) : width;
+        if (begin >= end) {
+            return;
+        }
+        float latitude = detail::grid_latitude(region, row);
+        std::vector<Location> locations;
+        locations.reserve(end - begin);
+        for (int column = begin; column < end; ++column) {
+            locations.emplace_back(detail::grid_longitude(region, column), latitude, region.altitude,
+                                   region.current_time, region.detail_level);
+        }
+        BatchResult batch = world_.batch_query(locations, data_types);
+        for (size_t i = 0; i < data_types.size(); ++i) {
+            layout.extract(batch, i, scratch_.layers[i].data() + offset + begin);
+        }
+        sampled += locations.size();
+    });
+
+    std::swap(grid_, scratch_);
+    region_ = region;
+    last_sampled_ = sampled;
+    return grid_;
+}
+
+void ViewportSampleCache::assign(const GridRegion& region, const std::vector<DataType>& data_types, GridResult grid) {
+    region_ = region;
+    types_ = data_types;
+    grid_ = std::move(grid);
+    valid_ = grid_.row_begin == 0 && grid_.rows == region.height && grid_.width == region.width &&
+             grid_.layers.size() == data_types.size();
+    last_sampled_ = 0;
+}
+
+void ViewportSampleCache::clear() {
+    valid_ = false;
+    grid_ = GridResult();
+    scratch_ = GridResult();
+    last_sampled_ = 0;
+}
+
+} // namespace rworld
+
+#endif // _RWORLD_IMPLEMENTATION
+#endif // RWORLD_VIEWPORT_H
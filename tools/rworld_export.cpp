@@ -0,0 +1,140 @@
+#define _RWORLD_IMPLEMENTATION
+#include "rworld.h"
+#include "rworld_export.h"
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+using namespace rworld;
+
+void print_usage() {
+    std::cout << "Usage: rworld_export [options] LAYER [LAYER...]\n"
+              << "\n"
+              << "Writes one raster per LAYER (a data type name such as terrain_height,\n"
+              << "temperature or biome) for a longitude/latitude window.\n"
+              << "\n"
+              << "Options:\n"
+              << "  --seed N            World seed (default 42)\n"
+              << "  --bounds W,S,E,N    Window in degrees (default -180,-90,180,90)\n"
+              << "  --size WxH          Raster size in samples (default 3600x1800)\n"
+              << "  --format F          f32, f16, u16, u8, pgm or pfm (default f32)\n"
+              << "  --tile N            Split into NxN tiles named <name>_<col>_<row>\n"
+              << "  --band-rows N       Rows computed per pass when not tiling (default 256)\n"
+              << "  --altitude M        Query altitude in meters (default 0 = terrain surface)\n"
+              << "  --time H            Time of day in hours (default 12)\n"
+              << "  --detail D          Terrain detail level (default 1)\n"
+              << "  --out PREFIX        Output prefix (default world); files are PREFIX_LAYER.ext\n"
+              << "\n"
+              << "Set RWORLD_THREADS to limit worker threads.\n";
+}
+
+bool parse_format(const char* name, RasterFormat& format) {
+    if (std::strcmp(name, "f32") == 0) {
+        format = RasterFormat::RAW_F32;
+    } else if (std::strcmp(name, "f16") == 0) {
+        format = RasterFormat::RAW_F16;
+    } else if (std::strcmp(name, "u16") == 0) {
+        format = RasterFormat::RAW_U16;
+    } else if (std::strcmp(name, "u8") == 0) {
+        format = RasterFormat::RAW_U8;
+    } else if (std::strcmp(name, "pgm") == 0) {
+        format = RasterFormat::PGM16;
+    } else if (std::strcmp(name, "pfm") == 0) {
+        format = RasterFormat::PFM;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    WorldConfig config;
+    config.seed = 42;
+
+    ExportOptions options;
+    options.region.width = 3600;
+    options.region.height = 1800;
+    std::string prefix = "world";
+    std::vector<DataType> types;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--help" || arg == "-h") {
+            print_usage();
+            return 0;
+        } else if (arg == "--seed" && has_value) {
+            config.seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--bounds" && has_value) {
+            GridRegion& r = options.region;
+            if (std::sscanf(argv[++i], "%f,%f,%f,%f", &r.west, &r.south, &r.east, &r.north) != 4) {
+                std::cerr << "Invalid --bounds, expected W,S,E,N\n";
+                return 1;
+            }
+        } else if (arg == "--size" && has_value) {
+            if (std::sscanf(argv[++i], "%dx%d", &options.region.width, &options.region.height) != 2) {
+                std::cerr << "Invalid --size, expected WxH\n";
+                return 1;
+            }
+        } else if (arg == "--format" && has_value) {
+            if (!parse_format(argv[++i], options.format)) {
+                std::cerr << "Unknown format: " << argv[i] << "\n";
+                return 1;
+            }
+        } else if (arg == "--tile" && has_value) {
+            options.tile_size = std::atoi(argv[++i]);
+        } else if (arg == "--band-rows" && has_value) {
+            options.band_rows = std::atoi(argv[++i]);
+        } else if (arg == "--altitude" && has_value) {
+            options.region.altitude = static_cast<float>(std::atof(argv[++i]));
+        } else if (arg == "--time" && has_value) {
+            options.region.current_time = static_cast<float>(std::atof(argv[++i]));
+        } else if (arg == "--detail" && has_value) {
+            options.region.detail_level = static_cast<float>(std::atof(argv[++i]));
+        } else if (arg == "--out" && has_value) {
+            prefix = argv[++i];
+        } else {
+            DataType type;
+            if (!data_type_from_string(arg.c_str(), type)) {
+                std::cerr << "Unknown layer or option: " << arg << "\n";
+                print_usage();
+                return 1;
+            }
+            types.push_back(type);
+        }
+    }
+
+    if (types.empty()) {
+        print_usage();
+        return 1;
+    }
+
+    std::vector<ExportLayer> layers;
+    for (DataType type : types) {
+        ExportLayer layer;
+        layer.type = type;
+        layer.path = prefix + "_" + data_type_to_string(type) + raster_format_extension(options.format);
+        layers.push_back(layer);
+    }
+
+    options.progress = [](int rows_done, int rows_total) {
+        std::cerr << "\rRows " << rows_done << "/" << rows_total << std::flush;
+    };
+
+    World world(config);
+    std::string error;
+    bool ok = export_rasters(world, options, layers, &error);
+    std::cerr << "\n";
+    if (!ok) {
+        std::cerr << "Export failed: " << error << "\n";
+        return 1;
+    }
+
+    for (const ExportLayer& layer : layers) {
+        std::cout << (options.tile_size > 0 ? "Tiles for " : "Wrote ") << layer.path << "\n";
+    }
+    return 0;
+}
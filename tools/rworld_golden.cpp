@@ -0,0 +1,397 @@
+#define _RWORLD_IMPLEMENTATION
+#include "rworld.h"
+#include "rworld_scheduler.h"
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace rworld;
+
+#ifndef RWORLD_GOLDEN_FILE
+#define RWORLD_GOLDEN_FILE "tools/golden/rworld_golden.txt"
+#endif
+
+// Sampling used to produce the golden file; recorded in its first line so a
+// check always repeats the run the file was written from
+struct GoldenSettings {
+    std::vector<uint64_t> seeds = {42, 12345, 3141592653};
+    int width = 160;
+    int height = 80;
+    float current_time = 15.5f;
+    int day_of_year = 80;
+};
+
+// Tolerance of the quantized hash: values are rounded to a multiple of this
+// before hashing, so the quantized hash survives drift below the step (but
+// not a value that happens to cross a rounding boundary)
+float quantum(DataType type) {
+    switch (type) {
+        case DataType::TERRAIN_HEIGHT: return 1.0f;
+        case DataType::TEMPERATURE:
+        case DataType::TEMPERATURE_AT_TIME: return 0.01f;
+        case DataType::PRECIPITATION:
+        case DataType::CURRENT_PRECIPITATION: return 1.0f;
+        case DataType::AIR_PRESSURE:
+        case DataType::PRESSURE_AT_LOCATION:
+        case DataType::PRESSURE_GRADIENT: return 0.05f;
+        case DataType::WIND_DIRECTION:
+        case DataType::CURRENT_WIND_DIRECTION:
+        case DataType::RIVER_WIDTH:
+        case DataType::INSOLATION: return 0.5f;
+        case DataType::WIND_SPEED:
+        case DataType::CURRENT_WIND_SPEED:
+        case DataType::SOLAR_ANGLE:
+        case DataType::SOIL_PH: return 0.01f;
+        case DataType::BIOME:
+        case DataType::PRECIPITATION_TYPE:
+        case DataType::IS_RIVER:
+        case DataType::IS_VOLCANO:
+        case DataType::IS_DAYLIGHT:
+        case DataType::SOIL_TYPE:
+        case DataType::IS_STORM_FRONT: return 1.0f;
+        default: return 0.001f;
+    }
+}
+
+struct TypeHash {
+    uint64_t exact = 0;
+    uint64_t quantized = 0;
+};
+
+// FNV-1a over the bit patterns (exact) and over the rounded values
+TypeHash hash_values(DataType type, const float* values, size_t count) {
+    TypeHash hash;
+    hash.exact = 0xcbf29ce484222325ull;
+    hash.quantized = 0xcbf29ce484222325ull;
+    float step = quantum(type);
+    for (size_t i = 0; i < count; ++i) {
+        uint32_t bits;
+        std::memcpy(&bits, &values[i], sizeof(bits));
+        int64_t rounded = std::isfinite(values[i]) ? std::llround(values[i] / step) : INT64_MIN;
+        for (int b = 0; b < 4; ++b) {
+            hash.exact = (hash.exact ^ ((bits >> (8 * b)) & 0xff)) * 0x100000001b3ull;
+        }
+        for (int b = 0; b < 8; ++b) {
+            hash.quantized = (hash.quantized ^ ((static_cast<uint64_t>(rounded) >> (8 * b)) & 0xff)) * 0x100000001b3ull;
+        }
+    }
+    return hash;
+}
+
+std::vector<DataType> all_data_types() {
+    std::vector<DataType> types;
+    for (int i = 0; i <= static_cast<int>(DataType::IS_STORM_FRONT); ++i) {
+        types.push_back(static_cast<DataType>(i));
+    }
+    return types;
+}
+
+// One value through the public getter, at the altitude batch_query resolves
+// for altitude 0 (TERRAIN_HEIGHT comes first, so every type sees it)
+float scalar_value(const World& world, DataType type, const Location& at, float altitude) {
+    float lon = at.longitude, lat = at.latitude, time = at.current_time;
+    switch (type) {
+        case DataType::TERRAIN_HEIGHT: return world.get_terrain_height(lon, lat, at.detail_level);
+        case DataType::TEMPERATURE: return world.get_temperature(lon, lat, altitude);
+        case DataType::TEMPERATURE_AT_TIME: return world.get_temperature_at_time(lon, lat, altitude, time);
+        case DataType::BIOME: return static_cast<float>(world.get_biome(lon, lat, altitude));
+        case DataType::PRECIPITATION: return world.get_precipitation(lon, lat, altitude);
+        case DataType::CURRENT_PRECIPITATION: return world.get_current_precipitation(lon, lat, altitude, time);
+        case DataType::PRECIPITATION_TYPE: return static_cast<float>(world.get_precipitation_type(lon, lat, altitude));
+        case DataType::AIR_PRESSURE: return world.get_air_pressure(lon, lat, altitude);
+        case DataType::HUMIDITY: return world.get_humidity(lon, lat, altitude);
+        case DataType::WIND_SPEED: return world.get_wind_speed(lon, lat, altitude);
+        case DataType::CURRENT_WIND_SPEED: return world.get_current_wind_speed(lon, lat, altitude, time);
+        case DataType::WIND_DIRECTION: return world.get_wind_direction(lon, lat, altitude);
+        case DataType::CURRENT_WIND_DIRECTION: return world.get_current_wind_direction(lon, lat, altitude, time);
+        case DataType::IS_RIVER: return world.is_river(lon, lat) ? 1.0f : 0.0f;
+        case DataType::RIVER_WIDTH: return world.get_river_width(lon, lat);
+        case DataType::FLOW_ACCUMULATION: return world.get_flow_accumulation(lon, lat);
+        case DataType::IS_VOLCANO: return world.is_volcano(lon, lat) ? 1.0f : 0.0f;
+        case DataType::COAL_DEPOSIT: return world.get_coal_deposit(lon, lat);
+        case DataType::IRON_DEPOSIT: return world.get_iron_deposit(lon, lat);
+        case DataType::OIL_DEPOSIT: return world.get_oil_deposit(lon, lat);
+        case DataType::INSOLATION: return world.get_insolation(lon, lat, time);
+        case DataType::IS_DAYLIGHT: return world.is_daylight(lon, lat, time) ? 1.0f : 0.0f;
+        case DataType::SOLAR_ANGLE: return world.get_solar_angle(lon, lat, time);
+        case DataType::VEGETATION_DENSITY: return world.get_vegetation_density(lon, lat, altitude);
+        case DataType::SOIL_TYPE: return static_cast<float>(world.get_soil_type(lon, lat, altitude));
+        case DataType::SOIL_FERTILITY: return world.get_soil_fertility(lon, lat, altitude);
+        case DataType::SOIL_PH: return world.get_soil_ph(lon, lat, altitude);
+        case DataType::ORGANIC_MATTER: return world.get_organic_matter(lon, lat, altitude);
+        case DataType::PRESSURE_AT_LOCATION: return world.get_pressure_at_location(lon, lat, altitude, time);
+        case DataType::PRESSURE_GRADIENT: return world.get_pressure_gradient(lon, lat, time);
+        case DataType::IS_STORM_FRONT: return world.is_storm_front(lon, lat, time) ? 1.0f : 0.0f;
+    }
+    return 0.0f;
+}
+
+// Layers (one per type, one value per location) through the public getters,
+// with the locations dealt round-robin to threads worker threads
+std::vector<std::vector<float>> scalar_layers(const World& world, const std::vector<Location>& locations,
+                                              const std::vector<DataType>& types, int threads) {
+    std::vector<std::vector<float>> layers(types.size(), std::vector<float>(locations.size()));
+    auto work = [&](int first) {
+        for (size_t k = static_cast<size_t>(first); k < locations.size(); k += static_cast<size_t>(threads)) {
+            const Location& at = locations[k];
+            float altitude = std::max(world.get_terrain_height(at.longitude, at.latitude, at.detail_level), 0.0f);
+            for (size_t i = 0; i < types.size(); ++i) {
+                layers[i][k] = scalar_value(world, types[i], at, altitude);
+            }
+        }
+    };
+    std::vector<std::thread> workers;
+    for (int t = 1; t < threads; ++t) {
+        workers.emplace_back(work, t);
+    }
+    work(0);
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    return layers;
+}
+
+std::vector<std::vector<float>> batch_layers(const BatchResult& result, const std::vector<DataType>& types) {
+    detail::BatchLayout layout(types);
+    std::vector<std::vector<float>> layers(types.size(), std::vector<float>(result.count));
+    for (size_t i = 0; i < types.size(); ++i) {
+        layout.extract(result, i, layers[i].data());
+    }
+    return layers;
+}
+
+const char* PATHS[] = {"batch", "scalar", "grid", "series", "threaded",
+                       "interactive", "cached", "morton", "hilbert"};
+const size_t PATH_COUNT = sizeof(PATHS) / sizeof(PATHS[0]);
+
+// Hashes of every type through every query path, for one seed
+std::vector<std::vector<TypeHash>> hash_paths(const GoldenSettings& settings, uint64_t seed) {
+    WorldConfig config;
+    config.seed = seed;
+    config.day_of_year = settings.day_of_year;
+    World world(config);
+    std::vector<DataType> types = all_data_types();
+
+    GridRegion region;
+    region.width = settings.width;
+    region.height = settings.height;
+    region.current_time = settings.current_time;
+    std::vector<Location> locations;
+    for (int r = 0; r < region.height; ++r) {
+        for (int c = 0; c < region.width; ++c) {
+            locations.emplace_back(detail::grid_longitude(region, c), detail::grid_latitude(region, r),
+                                   region.altitude, region.current_time, region.detail_level);
+        }
+    }
+
+    std::vector<std::vector<std::vector<float>>> paths;
+    paths.push_back(batch_layers(world.batch_query(locations, types), types));
+    paths.push_back(scalar_layers(world, locations, types, 1));
+    paths.push_back(world.grid_query(region, types).layers);
+
+    TimeSeriesRange range;
+    range.first_day = settings.day_of_year;
+    range.first_time = settings.current_time;
+    range.time_count = 1;
+    paths.push_back(world.time_series_query(locations, types, range).layers);
+
+    // Scheduler chunks of an odd size, merged back in order, on four workers
+    SchedulerOptions options;
+    options.threads = 4;
+    options.bulk_chunk = 997;
+    QueryScheduler scheduler(world, options);
+    paths.push_back(batch_layers(scheduler.batch_query(locations, types).get(), types));
+    
+    // The same chunks on the interactive lane, which must requeue a batch
+    // between chunks and leave the lane empty afterwards
+    BatchResult interactive = scheduler.batch_query(locations, types, QueryLane::INTERACTIVE).get();
+    paths.push_back(scheduler.stats(QueryLane::INTERACTIVE).depth == 0 ? batch_layers(interactive, types)
+                                                                        : std::vector<std::vector<float>>());
+
+    // Coalescing front end; the second pass is answered from recent results
+    WorldConfig cached_config = config;
+    cached_config.coalescing.enabled = true;
+    cached_config.coalescing.recent_results = 1 << 20;
+    World cached(cached_config);
+    std::vector<std::vector<float>> first = scalar_layers(cached, locations, types, 4);
+    std::vector<std::vector<float>> second = scalar_layers(cached, locations, types, 4);
+    paths.push_back(first == second ? second : std::vector<std::vector<float>>());
+
+    // Batches evaluated along space-filling curves and scattered back
+    for (BatchOrder order : {BatchOrder::MORTON, BatchOrder::HILBERT}) {
+        WorldConfig ordered_config = config;
+        ordered_config.batch_order = order;
+        World ordered(ordered_config);
+        paths.push_back(batch_layers(ordered.batch_query(locations, types), types));
+    }
+
+    std::vector<std::vector<TypeHash>> hashes(PATH_COUNT, std::vector<TypeHash>(types.size()));
+    for (size_t p = 0; p < PATH_COUNT; ++p) {
+        for (size_t i = 0; i < types.size() && i < paths[p].size(); ++i) {
+            hashes[p][i] = hash_values(types[i], paths[p][i].data(), paths[p][i].size());
+        }
+    }
+    return hashes;
+}
+
+std::string hex(uint64_t value) {
+    std::ostringstream out;
+    out << std::hex << std::setw(16) << std::setfill('0') << value;
+    return out.str();
+}
+
+bool read_golden(const std::string& path, GoldenSettings& settings,
+                 std::map<std::pair<uint64_t, std::string>, std::pair<std::string, std::string>>& golden) {
+    std::ifstream in(path);
+    std::string line;
+    if (!in || !std::getline(in, line)) {
+        return false;
+    }
+    std::istringstream header(line);
+    std::string word;
+    settings.seeds.clear();
+    header >> word;  // "#"
+    while (header >> word) {
+        if (word == "grid") {
+            header >> settings.width >> settings.height;
+        } else if (word == "time") {
+            header >> settings.current_time;
+        } else if (word == "day") {
+            header >> settings.day_of_year;
+        } else if (word == "seeds") {
+            uint64_t seed;
+            while (header >> seed) {
+                settings.seeds.push_back(seed);
+            }
+        }
+    }
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        std::istringstream entry(line);
+        uint64_t seed;
+        std::string type, exact, quantized;
+        if (entry >> seed >> type >> exact >> quantized) {
+            golden[{seed, type}] = {exact, quantized};
+        }
+    }
+    return !settings.seeds.empty();
+}
+
+void print_usage() {
+    std::cout << "Usage: rworld_golden [options]\n"
+              << "\n"
+              << "Samples fixed seeds over a global grid for every data type through the\n"
+              << "batch, scalar getter, grid, time series, threaded scheduler (bulk and\n"
+              << "interactive lanes), coalescing cache and spatially ordered batch paths,\n"
+              << "hashes each layer exactly (bit patterns) and quantized (rounded to a\n"
+              << "per-type step), and compares the hashes with\n"
+              << "the checked-in golden file. Exits with status 1 if any path disagrees with\n"
+              << "the golden hashes.\n"
+              << "\n"
+              << "Options:\n"
+              << "  --golden PATH       Golden file (default " << RWORLD_GOLDEN_FILE << ")\n"
+              << "  --write             Regenerate the golden file from the batch path\n"
+              << "  --quantized         Only compare quantized hashes\n";
+}
+
+int main(int argc, char** argv) {
+    std::string golden_path = RWORLD_GOLDEN_FILE;
+    bool write = false;
+    bool quantized_only = false;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--help" || arg == "-h") {
+            print_usage();
+            return 0;
+        } else if (arg == "--golden" && has_value) {
+            golden_path = argv[++i];
+        } else if (arg == "--write") {
+            write = true;
+        } else if (arg == "--quantized") {
+            quantized_only = true;
+        } else {
+            std::cerr << "Unknown option: " << arg << "\n";
+            print_usage();
+            return 1;
+        }
+    }
+
+    GoldenSettings settings;
+    std::map<std::pair<uint64_t, std::string>, std::pair<std::string, std::string>> golden;
+    if (!write && !read_golden(golden_path, settings, golden)) {
+        std::cerr << "Cannot read golden file " << golden_path << " (run with --write to create it)\n";
+        return 1;
+    }
+
+    std::vector<DataType> types = all_data_types();
+    std::ostringstream output;
+    output << "# grid " << settings.width << " " << settings.height << " time " << settings.current_time << " day "
+           << settings.day_of_year << " seeds";
+    for (uint64_t seed : settings.seeds) {
+        output << " " << seed;
+    }
+    output << "\n# seed data_type exact quantized\n";
+
+    size_t failures = 0;
+    for (uint64_t seed : settings.seeds) {
+        std::vector<std::vector<TypeHash>> hashes = hash_paths(settings, seed);
+        for (size_t i = 0; i < types.size(); ++i) {
+            const char* name = data_type_to_string(types[i]);
+            const TypeHash& reference = hashes[0][i];
+            output << seed << " " << name << " " << hex(reference.exact) << " " << hex(reference.quantized) << "\n";
+
+            // When writing, every path must still agree with the batch path
+            std::pair<std::string, std::string> expected = {hex(reference.exact), hex(reference.quantized)};
+            if (!write) {
+                auto entry = golden.find({seed, name});
+                expected = entry != golden.end() ? entry->second : std::make_pair(std::string(), std::string());
+            }
+            std::string failed;
+            for (size_t p = 0; p < PATH_COUNT; ++p) {
+                bool exact_ok = hex(hashes[p][i].exact) == expected.first;
+                bool quantized_ok = hex(hashes[p][i].quantized) == expected.second;
+                if (!quantized_ok || (!quantized_only && !exact_ok)) {
+                    failed += failed.empty() ? "" : ",";
+                    failed += PATHS[p];
+                    failed += quantized_ok ? "(exact)" : "";
+                }
+            }
+            if (!failed.empty()) {
+                failures++;
+                std::cout << "FAIL seed " << seed << " " << name << ": " << failed << "\n";
+            }
+        }
+    }
+
+    if (write && failures > 0) {
+        std::cerr << "Query paths disagree; golden file not written\n";
+        return 1;
+    }
+    if (write) {
+        std::ofstream out(golden_path);
+        out << output.str();
+        if (!out) {
+            std::cerr << "Cannot write " << golden_path << "\n";
+            return 1;
+        }
+        std::cout << "Wrote " << settings.seeds.size() * types.size() << " golden hashes to " << golden_path << "\n";
+        return 0;
+    }
+    std::cout << (failures == 0 ? "PASS" : "FAIL") << ": " << settings.seeds.size() << " seeds x " << types.size()
+              << " data types x " << PATH_COUNT << " paths, " << settings.width << "x" << settings.height
+              << " grid, " << failures << " mismatches\n";
+    return failures == 0 ? 0 : 1;
+}
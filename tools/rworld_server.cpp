@@ -0,0 +1,723 @@
+#define _RWORLD_IMPLEMENTATION
+#include "rworld.h"
+#include "rworld_protocol.h"
+#include "rworld_scheduler.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace rworld;
+
+void print_usage() {
+    std::cout << "Usage: rworld_server [options]\n"
+              << "\n"
+              << "Serves batch and grid queries on one world over a Unix domain socket\n"
+              << "using the binary protocol in rworld_protocol.h (see WorldClient).\n"
+              << "Identical requests in flight from any client are computed once, and\n"
+              << "recent results are kept in an LRU cache. Large results can be handed\n"
+              << "to clients as sealed shared memory instead of being copied.\n"
+              << "\n"
+              << "Options:\n"
+              << "  --socket PATH       Socket path (default /tmp/rworld.sock)\n"
+              << "  --seed N            World seed (default 42)\n"
+              << "  --day N             Day of year (default 80)\n"
+              << "  --threads N         Worker threads (default: all)\n"
+              << "  --cache-mb N        Result cache size (default 256, 0 = off)\n"
+              << "  --max-locations N   Largest batch or grid (in cells) accepted (default 16777216)\n"
+              << "  --max-values N      Largest result (cells times data types) accepted (default 67108864)\n"
+              << "  --interactive N     Batches up to N locations use the interactive lane (default 1024)\n"
+              << "  --verbose           Log connections and a summary on exit\n";
+}
+
+volatile std::sig_atomic_t stop_requested = 0;
+
+void handle_signal(int) {
+    stop_requested = 1;
+}
+
+// Payloads smaller than this are cheaper to copy than to map
+const size_t SHARED_MINIMUM = 64 << 10;
+
+// Encoded response payload, in a sealed memfd when the platform has one
+// and the payload is large enough to be worth mapping
+class ResultBuffer {
+public:
+    explicit ResultBuffer(size_t size) : size_(size) {
+#if defined(__linux__) && defined(MFD_CLOEXEC)
+        if (size >= SHARED_MINIMUM) {
+            fd_ = ::memfd_create("rworld-result", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+            void* mapping = MAP_FAILED;
+            if (fd_ >= 0 && ::ftruncate(fd_, static_cast<off_t>(size)) == 0) {
+                mapping = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+            }
+            if (mapping != MAP_FAILED) {
+                data_ = static_cast<char*>(mapping);
+                return;
+            }
+            if (fd_ >= 0) {
+                ::close(fd_);
+                fd_ = -1;
+            }
+        }
+#endif
+        heap_.resize(size);
+        data_ = heap_.data();
+    }
+
+    ResultBuffer(const char* bytes, size_t size) : ResultBuffer(size) {
+        std::memcpy(data_, bytes, size);
+    }
+
+    ~ResultBuffer() {
+        if (fd_ >= 0) {
+            ::munmap(data_, size_);
+            ::close(fd_);
+        }
+    }
+
+    ResultBuffer(const ResultBuffer&) = delete;
+    ResultBuffer& operator=(const ResultBuffer&) = delete;
+
+    char* data() { return data_; }
+    const char* data() const { return data_; }
+    size_t size() const { return size_; }
+
+    /**
+     * Memfd holding the payload, or -1 for a heap buffer
+     */
+    int memfd() const { return fd_; }
+
+    /**
+     * Make the memfd read-only for good once the payload is written, so
+     * clients (and cache hits) can map it without it ever changing
+     */
+    void seal() {
+#if defined(__linux__) && defined(F_SEAL_WRITE)
+        if (fd_ < 0) {
+            return;
+        }
+        void* view = ::mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd_, 0);
+        if (view == MAP_FAILED) {
+            return;
+        }
+        ::munmap(data_, size_);
+        data_ = static_cast<char*>(view);
+        ::fcntl(fd_, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL);
+#endif
+    }
+
+private:
+    char* data_ = nullptr;
+    size_t size_ = 0;
+    int fd_ = -1;
+    std::vector<char> heap_;
+};
+
+using Payload = std::shared_ptr<const ResultBuffer>;
+
+// One queued response; with attach set, the payload travels as a memfd
+// (SCM_RIGHTS on the first byte) instead of inline
+struct Outgoing {
+    protocol::ResponseHeader header;
+    Payload payload;
+    bool attach = false;
+    size_t sent = 0;
+
+    size_t bytes() const { return sizeof(header) + (attach || !payload ? 0 : payload->size()); }
+};
+
+struct Connection {
+    int fd = -1;
+    std::vector<char> in;
+    std::deque<Outgoing> out;
+};
+
+// Self-pipe that wakes poll() when a worker finishes a request
+struct WakePipe {
+    int fds[2] = {-1, -1};
+
+    ~WakePipe() {
+        for (int fd : fds) {
+            if (fd >= 0) {
+                ::close(fd);
+            }
+        }
+    }
+};
+
+struct Waiter {
+    uint64_t connection = 0;
+    uint64_t request_id = 0;
+    bool shared = false;  // Asked for SHARED_MEMORY
+};
+
+// One distinct request being computed, with everyone waiting for it
+struct InFlight {
+    std::vector<Waiter> waiters;
+};
+
+// Encoded response of a finished request, handed from a worker to the poll thread
+struct Completed {
+    std::string key;
+    protocol::Status status = protocol::Status::OK;
+    Payload payload;
+};
+
+// LRU cache of encoded responses keyed by the request
+class ResultCache {
+public:
+    explicit ResultCache(size_t capacity) : capacity_(capacity) {}
+
+    Payload find(const std::string& key) {
+        auto entry = index_.find(key);
+        if (entry == index_.end()) {
+            return nullptr;
+        }
+        order_.splice(order_.begin(), order_, entry->second);
+        return entry->second->second;
+    }
+
+    void insert(const std::string& key, Payload payload) {
+        size_t bytes = key.size() + payload->size();
+        if (bytes > capacity_ || index_.count(key)) {
+            return;
+        }
+        order_.emplace_front(key, std::move(payload));
+        index_[key] = order_.begin();
+        size_ += bytes;
+        while (size_ > capacity_) {
+            auto& last = order_.back();
+            size_ -= last.first.size() + last.second->size();
+            index_.erase(last.first);
+            order_.pop_back();
+        }
+    }
+
+private:
+    using Entry = std::pair<std::string, Payload>;
+    size_t capacity_;
+    size_t size_ = 0;
+    std::list<Entry> order_;
+    std::unordered_map<std::string, std::list<Entry>::iterator> index_;
+};
+
+class Server {
+public:
+    Server(const World& world, const SchedulerOptions& scheduler_options, size_t cache_bytes,
+           size_t max_locations, size_t max_values, size_t interactive_limit, bool verbose)
+        : world_(world), scheduler_(world, scheduler_options), cache_(cache_bytes),
+          max_locations_(max_locations), max_values_(max_values), interactive_limit_(interactive_limit),
+          verbose_(verbose) {}
+
+    bool listen(const std::string& path) {
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        if (path.size() >= sizeof(address.sun_path)) {
+            std::cerr << "Socket path too long: " << path << "\n";
+            return false;
+        }
+        std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+        ::unlink(path.c_str());
+
+        listen_fd_ = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (listen_fd_ < 0 || ::bind(listen_fd_, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 ||
+            ::listen(listen_fd_, 64) != 0 || ::pipe(wake_.fds) != 0) {
+            std::cerr << "Cannot listen on " << path << ": " << std::strerror(errno) << "\n";
+            return false;
+        }
+        set_nonblocking(listen_fd_);
+        set_nonblocking(wake_.fds[0]);
+        set_nonblocking(wake_.fds[1]);
+        path_ = path;
+        return true;
+    }
+
+    void run() {
+        std::vector<pollfd> fds;
+        std::vector<uint64_t> ids;
+        while (!stop_requested) {
+            fds.clear();
+            ids.clear();
+            fds.push_back({listen_fd_, POLLIN, 0});
+            fds.push_back({wake_.fds[0], POLLIN, 0});
+            for (auto& entry : connections_) {
+                short events = POLLIN;
+                if (!entry.second.out.empty()) {
+                    events |= POLLOUT;
+                }
+                fds.push_back({entry.second.fd, events, 0});
+                ids.push_back(entry.first);
+            }
+            if (::poll(fds.data(), fds.size(), 500) < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                std::cerr << "poll failed: " << std::strerror(errno) << "\n";
+                break;
+            }
+
+            if (fds[0].revents & POLLIN) {
+                accept_clients();
+            }
+            if (fds[1].revents & POLLIN) {
+                char drain[256];
+                while (::read(wake_.fds[0], drain, sizeof(drain)) > 0) {
+                }
+                deliver_completed();
+            }
+            for (size_t i = 0; i < ids.size(); ++i) {
+                short revents = fds[i + 2].revents;
+                if (revents & (POLLIN | POLLHUP | POLLERR)) {
+                    read_client(ids[i]);
+                }
+                if ((revents & POLLOUT) && connections_.count(ids[i])) {
+                    write_client(ids[i]);
+                }
+            }
+        }
+    }
+
+    ~Server() {
+        if (verbose_) {
+            std::cerr << "Requests " << requests_ << ", cache hits " << cache_hits_ << ", coalesced "
+                      << coalesced_ << ", computed " << computed_ << ", shared " << shared_ << "\n";
+        }
+        for (auto& entry : connections_) {
+            ::close(entry.second.fd);
+        }
+        if (listen_fd_ >= 0) {
+            ::close(listen_fd_);
+            ::unlink(path_.c_str());
+        }
+    }
+
+private:
+    static void set_nonblocking(int fd) {
+        ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+    }
+
+    void accept_clients() {
+        for (;;) {
+            int fd = ::accept(listen_fd_, nullptr, nullptr);
+            if (fd < 0) {
+                return;
+            }
+            set_nonblocking(fd);
+            uint64_t id = next_connection_++;
+            connections_[id].fd = fd;
+            if (verbose_) {
+                std::cerr << "Client " << id << " connected\n";
+            }
+        }
+    }
+
+    void disconnect(uint64_t id) {
+        auto connection = connections_.find(id);
+        if (connection == connections_.end()) {
+            return;
+        }
+        ::close(connection->second.fd);
+        connections_.erase(connection);
+        if (verbose_) {
+            std::cerr << "Client " << id << " disconnected\n";
+        }
+    }
+
+    void read_client(uint64_t id) {
+        Connection& connection = connections_[id];
+        char buffer[65536];
+        for (;;) {
+            ssize_t n = ::recv(connection.fd, buffer, sizeof(buffer), 0);
+            if (n > 0) {
+                connection.in.insert(connection.in.end(), buffer, buffer + n);
+                continue;
+            }
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                break;
+            }
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            disconnect(id);
+            return;
+        }
+
+        // Handle every complete message; a partial one stays buffered
+        size_t offset = 0;
+        while (connection.in.size() - offset >= protocol::HEADER_BYTES) {
+            protocol::RequestHeader header;
+            std::memcpy(&header, connection.in.data() + offset, sizeof(header));
+            if (header.magic != protocol::REQUEST_MAGIC || header.location_count > max_locations_ ||
+                header.type_count > 256 ||
+                static_cast<uint64_t>(header.location_count) * header.type_count > max_values_) {
+                respond_error(id, header.id, protocol::Status::BAD_REQUEST, "bad header or batch too large");
+                flush_and_close(id);
+                return;
+            }
+            uint64_t payload_bytes = protocol::request_payload_bytes(header);
+            if (connection.in.size() - offset - protocol::HEADER_BYTES < payload_bytes) {
+                break;
+            }
+            const char* payload = connection.in.data() + offset + protocol::HEADER_BYTES;
+            handle_request(id, header, payload, payload_bytes);
+            offset += protocol::HEADER_BYTES + payload_bytes;
+        }
+        connection.in.erase(connection.in.begin(), connection.in.begin() + offset);
+        write_client(id);
+    }
+
+    void handle_request(uint64_t connection, const protocol::RequestHeader& header, const char* payload,
+                        uint64_t payload_bytes) {
+        requests_++;
+        protocol::MessageType type = protocol::message_type(header);
+        Waiter waiter{connection, header.id, (header.type & protocol::SHARED_MEMORY) != 0};
+        if (type == protocol::MessageType::INFO) {
+            protocol::InfoPayload info;
+            info.seed = world_.get_config().seed;
+            info.day_of_year = world_.get_config().day_of_year;
+            info.max_locations = static_cast<uint32_t>(max_locations_);
+            respond(waiter, protocol::Status::OK,
+                    std::make_shared<ResultBuffer>(reinterpret_cast<const char*>(&info), sizeof(info)));
+            return;
+        }
+        if (type != protocol::MessageType::BATCH_QUERY && type != protocol::MessageType::GRID_QUERY) {
+            respond_error(connection, header.id, protocol::Status::BAD_REQUEST, "unknown message type");
+            return;
+        }
+
+        // The request minus its id and flags is the key for coalescing and
+        // caching. The counts belong in it: type lists are zero-padded and
+        // TERRAIN_HEIGHT is 0, so payloads alone can collide
+        std::string key(1, static_cast<char>(type));
+        key.append(reinterpret_cast<const char*>(&header.location_count), sizeof(header.location_count));
+        key.append(reinterpret_cast<const char*>(&header.type_count), sizeof(header.type_count));
+        key.append(payload, payload_bytes);
+        if (Payload cached = cache_.find(key)) {
+            cache_hits_++;
+            respond(waiter, protocol::Status::OK, cached);
+            return;
+        }
+        auto running = in_flight_.find(key);
+        if (running != in_flight_.end()) {
+            coalesced_++;
+            running->second.waiters.push_back(waiter);
+            return;
+        }
+
+        std::string error;
+        InFlight job;
+        job.waiters.push_back(waiter);
+        bool started = type == protocol::MessageType::BATCH_QUERY
+                           ? start_batch(key, header, payload, job, error)
+                           : start_grid(key, header, payload, job, error);
+        if (!started) {
+            respond_error(connection, header.id, protocol::Status::BAD_REQUEST, error);
+            return;
+        }
+        computed_++;
+        // Bands may all have finished already; deliver_completed() runs on
+        // this thread, so the entry is in place before it looks
+        in_flight_[key] = std::move(job);
+    }
+
+    bool start_batch(const std::string& key, const protocol::RequestHeader& header, const char* payload,
+                     InFlight& job, std::string& error) {
+        std::vector<Location> locations;
+        std::vector<DataType> types;
+        if (!protocol::decode_batch_request(header, payload, locations, types, &error)) {
+            return false;
+        }
+        QueryLane lane = locations.size() <= interactive_limit_ ? QueryLane::INTERACTIVE : QueryLane::BULK;
+        BatchFuture future = scheduler_.batch_query(locations, types, lane);
+        // Encoded on the worker that finished the batch, so a large result
+        // never holds up the poll thread
+        future.on_ready([this, key, future, types]() {
+            complete(key, [&]() {
+                const BatchResult& result = future.get();
+                auto buffer =
+                    std::make_shared<ResultBuffer>(protocol::result_payload_bytes(result.count, types, false));
+                protocol::encode_batch_result(result, types, buffer->data());
+                buffer->seal();
+                return Payload(buffer);
+            });
+        });
+        return true;
+    }
+
+    // Grids are split into row bands, queued as one query on the bulk lane;
+    // each band writes its layers straight into the response buffer, so the
+    // raster is never copied again on its way to a shared-memory client
+    bool start_grid(const std::string& key, const protocol::RequestHeader& header, const char* payload,
+                    InFlight& job, std::string& error) {
+        GridRegion region;
+        std::vector<DataType> types;
+        if (!protocol::decode_grid_request(header, payload, region, types, &error)) {
+            return false;
+        }
+        size_t width = static_cast<size_t>(region.width);
+        size_t cells = width * static_cast<size_t>(region.height);
+        if (region.height > 0 && cells / static_cast<size_t>(region.height) != width) {
+            cells = SIZE_MAX;
+        }
+        if (cells > max_locations_ || cells > max_values_ / std::max<size_t>(types.size(), 1)) {
+            error = "grid too large";
+            return false;
+        }
+
+        auto buffer = std::make_shared<ResultBuffer>(cells * types.size() * sizeof(float));
+        int band_rows = static_cast<int>(std::max<size_t>(1, 65536 / std::max<size_t>(width, 1)));
+        size_t band_count = region.height > 0 ? (static_cast<size_t>(region.height) + band_rows - 1) / band_rows : 0;
+        QueryFuture<bool> bands = scheduler_.submit_steps(
+            QueryLane::BULK, band_count, [=](const World& world, size_t band_index) {
+                int row = static_cast<int>(band_index) * band_rows;
+                int row_end = std::min(region.height, row + band_rows);
+                GridResult band = world.grid_query(region, types, row, row_end);
+                size_t band_cells = band.layers.empty() ? 0 : band.layers[0].size();
+                for (size_t i = 0; i < band.layers.size(); ++i) {
+                    char* target = buffer->data() + (i * cells + static_cast<size_t>(row) * width) * sizeof(float);
+                    std::memcpy(target, band.layers[i].data(), band_cells * sizeof(float));
+                }
+            });
+        bands.on_ready([this, key, bands, buffer]() {
+            complete(key, [&]() {
+                bands.get();
+                buffer->seal();
+                return Payload(buffer);
+            });
+        });
+        return true;
+    }
+
+    // Called by workers when a request finished; encode builds the response
+    // payload and throws if the query failed
+    void complete(const std::string& key, const std::function<Payload()>& encode) {
+        Completed done{key, protocol::Status::OK, nullptr};
+        try {
+            done.payload = encode();
+        } catch (const std::exception& e) {
+            done.status = protocol::Status::SERVER_ERROR;
+            done.payload = std::make_shared<ResultBuffer>(e.what(), std::strlen(e.what()));
+        }
+        {
+            std::lock_guard<std::mutex> lock(completed_mutex_);
+            completed_.push_back(std::move(done));
+        }
+        char signal = 1;
+        ssize_t ignored = ::write(wake_.fds[1], &signal, 1);
+        (void)ignored;
+    }
+
+    // Payloads arrive encoded, so this only queues them for sending
+    void deliver_completed() {
+        std::vector<Completed> finished;
+        {
+            std::lock_guard<std::mutex> lock(completed_mutex_);
+            finished.swap(completed_);
+        }
+        for (Completed& done : finished) {
+            auto entry = in_flight_.find(done.key);
+            if (entry == in_flight_.end()) {
+                continue;
+            }
+            InFlight job = std::move(entry->second);
+            in_flight_.erase(entry);
+
+            if (done.status == protocol::Status::OK) {
+                cache_.insert(done.key, done.payload);
+            }
+            for (const Waiter& waiter : job.waiters) {
+                if (connections_.count(waiter.connection)) {
+                    respond(waiter, done.status, done.payload);
+                    write_client(waiter.connection);
+                }
+            }
+        }
+    }
+
+    void respond(const Waiter& waiter, protocol::Status status, Payload payload) {
+        Outgoing message;
+        message.header.status = static_cast<uint32_t>(status);
+        message.header.id = waiter.request_id;
+        message.header.payload_bytes = payload->size();
+        message.attach = waiter.shared && status == protocol::Status::OK && payload->memfd() >= 0;
+        message.payload = std::move(payload);
+        shared_ += message.attach ? 1 : 0;
+        connections_[waiter.connection].out.push_back(std::move(message));
+    }
+
+    void respond_error(uint64_t connection, uint64_t request_id, protocol::Status status, const std::string& message) {
+        respond(Waiter{connection, request_id, false}, status,
+                std::make_shared<ResultBuffer>(message.data(), message.size()));
+    }
+
+    void write_client(uint64_t id) {
+        Connection& connection = connections_[id];
+        while (!connection.out.empty()) {
+            // Gather queued responses into one sendmsg; a descriptor rides
+            // on the first byte of its response, so stop before the next one
+            iovec io[64];
+            int count = 0;
+            int attach = -1;
+            for (const Outgoing& message : connection.out) {
+                if (count + 2 > 64 || (message.attach && message.sent == 0 && count > 0)) {
+                    break;
+                }
+                if (message.attach && message.sent == 0) {
+                    attach = message.payload->memfd();
+                }
+                size_t offset = message.sent;
+                if (offset < sizeof(message.header)) {
+                    io[count++] = {const_cast<char*>(reinterpret_cast<const char*>(&message.header)) + offset,
+                                   sizeof(message.header) - offset};
+                    offset = sizeof(message.header);
+                }
+                if (offset < message.bytes()) {
+                    size_t start = offset - sizeof(message.header);
+                    io[count++] = {const_cast<char*>(message.payload->data()) + start, message.bytes() - offset};
+                }
+            }
+
+            msghdr header{};
+            header.msg_iov = io;
+            header.msg_iovlen = static_cast<size_t>(count);
+            alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))];
+            if (attach >= 0) {
+                header.msg_control = control;
+                header.msg_controllen = sizeof(control);
+                cmsghdr* rights = CMSG_FIRSTHDR(&header);
+                rights->cmsg_level = SOL_SOCKET;
+                rights->cmsg_type = SCM_RIGHTS;
+                rights->cmsg_len = CMSG_LEN(sizeof(int));
+                std::memcpy(CMSG_DATA(rights), &attach, sizeof(int));
+            }
+            ssize_t n = ::sendmsg(connection.fd, &header, MSG_NOSIGNAL);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                return;
+            }
+            if (n <= 0) {
+                disconnect(id);
+                return;
+            }
+            size_t written = static_cast<size_t>(n);
+            while (written > 0) {
+                Outgoing& front = connection.out.front();
+                size_t step = std::min(written, front.bytes() - front.sent);
+                front.sent += step;
+                written -= step;
+                if (front.sent == front.bytes()) {
+                    connection.out.pop_front();
+                }
+            }
+        }
+    }
+
+    // Best effort: send what fits, then drop the client
+    void flush_and_close(uint64_t id) {
+        write_client(id);
+        disconnect(id);
+    }
+
+    // Declared before the scheduler so that they outlive its workers
+    const World& world_;
+    WakePipe wake_;
+    std::mutex completed_mutex_;
+    std::vector<Completed> completed_;  // Finished requests, filled by workers
+    QueryScheduler scheduler_;
+    ResultCache cache_;
+    size_t max_locations_;
+    size_t max_values_;
+    size_t interactive_limit_;
+    bool verbose_;
+
+    std::string path_;
+    int listen_fd_ = -1;
+    uint64_t next_connection_ = 1;
+    std::unordered_map<uint64_t, Connection> connections_;
+    std::unordered_map<std::string, InFlight> in_flight_;
+
+    uint64_t requests_ = 0;
+    uint64_t cache_hits_ = 0;
+    uint64_t coalesced_ = 0;
+    uint64_t computed_ = 0;
+    uint64_t shared_ = 0;
+};
+
+int main(int argc, char** argv) {
+    WorldConfig config;
+    config.seed = 42;
+    std::string socket_path = "/tmp/rworld.sock";
+    SchedulerOptions scheduler_options;
+    size_t cache_mb = 256;
+    size_t max_locations = size_t(1) << 24;
+    size_t max_values = size_t(1) << 26;
+    size_t interactive_limit = 1024;
+    bool verbose = false;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--help" || arg == "-h") {
+            print_usage();
+            return 0;
+        } else if (arg == "--socket" && has_value) {
+            socket_path = argv[++i];
+        } else if (arg == "--seed" && has_value) {
+            config.seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--day" && has_value) {
+            config.day_of_year = std::atoi(argv[++i]);
+        } else if (arg == "--threads" && has_value) {
+            scheduler_options.threads = std::atoi(argv[++i]);
+        } else if (arg == "--cache-mb" && has_value) {
+            cache_mb = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--max-locations" && has_value) {
+            max_locations = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--max-values" && has_value) {
+            max_values = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--interactive" && has_value) {
+            interactive_limit = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--verbose") {
+            verbose = true;
+        } else {
+            std::cerr << "Unknown option: " << arg << "\n";
+            print_usage();
+            return 1;
+        }
+    }
+
+    std::signal(SIGINT, handle_signal);
+    std::signal(SIGTERM, handle_signal);
+    std::signal(SIGPIPE, SIG_IGN);
+
+    World world(config);
+    Server server(world, scheduler_options, cache_mb << 20, max_locations, max_values, interactive_limit, verbose);
+    if (!server.listen(socket_path)) {
+        return 1;
+    }
+    if (verbose) {
+        std::cerr << "Serving seed " << config.seed << " on " << socket_path << "\n";
+    }
+    server.run();
+    return 0;
+}
@@ -0,0 +1,95 @@
+#define _RWORLD_IMPLEMENTATION
+#include "rworld.h"
+#include "rworld_tiles.h"
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <cstdio>
+#include <cstdlib>
+
+using namespace rworld;
+
+void print_usage() {
+    std::cout << "Usage: rworld_tiles [options]\n"
+              << "\n"
+              << "Builds an XYZ (slippy map) tile pyramid OUT/z/x/y.png. Only the deepest\n"
+              << "zoom is sampled; coarser levels are downsampled from their children.\n"
+              << "Re-running after an interruption reuses the tiles already written.\n"
+              << "\n"
+              << "Options:\n"
+              << "  --seed N            World seed (default 42)\n"
+              << "  --min-zoom Z        Coarsest zoom level (default 0)\n"
+              << "  --max-zoom Z        Deepest zoom level (default 6)\n"
+              << "  --bounds W,S,E,N    Only build tiles touching this window\n"
+              << "  --style S           biome or elevation (default biome)\n"
+              << "  --threads N         Worker threads (default: all)\n"
+              << "  --no-resume         Rebuild tiles that already exist\n"
+              << "  --out DIR           Output directory (default tiles)\n";
+}
+
+int main(int argc, char** argv) {
+    WorldConfig config;
+    config.seed = 42;
+    TilePyramidOptions options;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--help" || arg == "-h") {
+            print_usage();
+            return 0;
+        } else if (arg == "--seed" && has_value) {
+            config.seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--min-zoom" && has_value) {
+            options.min_zoom = std::atoi(argv[++i]);
+        } else if (arg == "--max-zoom" && has_value) {
+            options.max_zoom = std::atoi(argv[++i]);
+        } else if (arg == "--bounds" && has_value) {
+            if (std::sscanf(argv[++i], "%f,%f,%f,%f", &options.west, &options.south,
+                            &options.east, &options.north) != 4) {
+                std::cerr << "Invalid --bounds, expected W,S,E,N\n";
+                return 1;
+            }
+        } else if (arg == "--style" && has_value) {
+            std::string style = argv[++i];
+            if (style == "biome") {
+                options.style = TileStyle::BIOME;
+            } else if (style == "elevation") {
+                options.style = TileStyle::ELEVATION;
+            } else {
+                std::cerr << "Unknown style: " << style << "\n";
+                return 1;
+            }
+        } else if (arg == "--threads" && has_value) {
+            options.threads = std::atoi(argv[++i]);
+        } else if (arg == "--no-resume") {
+            options.resume = false;
+        } else if (arg == "--out" && has_value) {
+            options.output_dir = argv[++i];
+        } else {
+            std::cerr << "Unknown option: " << arg << "\n";
+            print_usage();
+            return 1;
+        }
+    }
+
+    options.progress = [](size_t done, size_t total) {
+        std::cerr << "\rTiles " << done << "/" << total << std::flush;
+    };
+
+    World world(config);
+    TilePyramidStats stats;
+    std::string error;
+    auto start = std::chrono::steady_clock::now();
+    bool ok = build_tile_pyramid(world, options, &stats, &error);
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cerr << "\n";
+    if (!ok) {
+        std::cerr << "Tile build failed: " << error << "\n";
+        return 1;
+    }
+
+    std::cout << "Rendered " << stats.rendered << ", downsampled " << stats.downsampled
+              << ", reused " << stats.reused << " tiles in " << elapsed << " s\n";
+    return 0;
+}